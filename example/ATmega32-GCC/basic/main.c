@@ -38,7 +38,7 @@
 
 int main(void)
 {
-  DS1307_Handler_t Handler;
+  DS1307_Handler_t Handler = {0};
   DS1307_RunHalt_t RunHalt;
   DS1307_DateTime_t DateTime;
 
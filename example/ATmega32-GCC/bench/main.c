@@ -0,0 +1,156 @@
+/**
+ **********************************************************************************
+ * @file   main.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  cycle, stack and footprint benchmark of DS1307 Driver (for ATmega32)
+ *         Runs under simavr with bench/simavr/bench_sim (see makefile)
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+#include <stdio.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <avr/sleep.h>
+#include "Retarget.h"
+#include "DS1307.h"
+#include "DS1307_platform.h"
+
+
+/**
+ * Benchmark protocol (see simavr/bench_sim.c)
+ *  - BENCH_MARK is set to the benchmark number right before the call and to
+ *    0 right after it, the harness counts the cycles and TWI bytes between.
+ *  - The stack below the call is painted with BENCH_PAINT before the call;
+ *    the bytes that changed give its high-water mark.
+ *  - One line "<Number> <Name> <Stack>" is printed on UART after each call.
+ *  - BENCH_END and sleep with interrupts disabled end the run.
+ */
+#define BENCH_MARK      PORTA
+#define BENCH_MARK_DDR  DDRA
+#define BENCH_END       0xFF
+#define BENCH_PAINT     0xC5
+
+/**
+ * Benchmarks: X(Name, Call)
+ * "Empty" is the overhead of the call and the markers, subtract it from the
+ * others. "...Again" calls repeat the previous one to show write elision.
+ */
+#define BENCH_LIST(X) \
+  X(Empty,              (void)0) \
+  X(Init,               DS1307_Init(&Handler)) \
+  X(InitProbe,          DS1307_InitProbe(&Handler, &Probe)) \
+  X(Probe,              DS1307_Probe(&Handler, &Probe)) \
+  X(SetDateTime,        DS1307_SetDateTime(&Handler, &DateTime)) \
+  X(SetDateTimeAgain,   DS1307_SetDateTime(&Handler, &DateTime)) \
+  X(SetDateTimeAligned, DS1307_SetDateTimeAligned(&Handler, &DateTime)) \
+  X(SetRunHalt,         DS1307_SetDateTimeRunHalt(&Handler, NULL, DS1307_RunHalt_Run)) \
+  X(GetDateTime,        DS1307_GetDateTime(&Handler, &DateTime)) \
+  X(GetFieldsSecond,    DS1307_GetFields(&Handler, DS1307_Field_Second, &DateTime)) \
+  X(GetFieldsTime,      DS1307_GetFields(&Handler, DS1307_Field_Time, &DateTime)) \
+  X(GetRunHalt,         DS1307_GetRunHalt(&Handler, &RunHalt)) \
+  X(WaitSecondEdge2,    DS1307_WaitSecondEdge(&Handler, 2)) \
+  X(WriteRAM1,          DS1307_WriteRAM(&Handler, 10, Ram, 1)) \
+  X(WriteRAM56,         DS1307_WriteRAM(&Handler, 0, Ram, 56)) \
+  X(ReadRAM1,           DS1307_ReadRAM(&Handler, 10, Ram, 1)) \
+  X(ReadRAM56,          DS1307_ReadRAM(&Handler, 0, Ram, 56)) \
+  X(SetHotRAM,          DS1307_SetHotRAM(&Handler, 0, 8)) \
+  X(GetDateTimeAndRAM,  DS1307_GetDateTimeAndRAM(&Handler, &DateTime, Ram)) \
+  X(WriteImage,         DS1307_WriteImage(&Handler, &DateTime, DS1307_OutWave_1Hz, Ram)) \
+  X(ReadImage,          DS1307_ReadImage(&Handler, &Probe, Ram)) \
+  X(SetOutWave,         DS1307_SetOutWave(&Handler, DS1307_OutWave_4KHz)) \
+  X(SetOutWaveAgain,    DS1307_SetOutWave(&Handler, DS1307_OutWave_4KHz)) \
+  X(DateTimeToUnix,     DS1307_DateTimeToUnix(&DateTime, &Unix)) \
+  X(UnixToDateTime,     DS1307_UnixToDateTime(Unix, &DateTime)) \
+  X(RecoverBus,         DS1307_RecoverBus(&Handler)) \
+  X(DeInit,             DS1307_DeInit(&Handler))
+
+
+typedef struct Bench_s
+{
+  const char *Name; // in flash
+  void (*Run)(void);
+} Bench_t;
+
+
+extern uint8_t _end; // end of .data and .bss, the stack may grow down to it
+
+static DS1307_Handler_t Handler;
+static DS1307_DateTime_t DateTime = {0, 18, 0, 6, 6, 2, 21};
+static DS1307_Probe_t Probe;
+static DS1307_RunHalt_t RunHalt;
+static uint8_t Ram[56];
+static uint32_t Unix;
+
+
+#define BENCH_FUNCTION(Name, Call) \
+  static void Bench_##Name(void) { Call; } \
+  static const char Bench_Name_##Name[] PROGMEM = #Name;
+BENCH_LIST(BENCH_FUNCTION)
+
+#define BENCH_ENTRY(Name, Call) {Bench_Name_##Name, Bench_##Name},
+static const Bench_t Benches[] PROGMEM = {BENCH_LIST(BENCH_ENTRY)};
+
+
+int main(void)
+{
+  void (*Run)(void);
+  uint8_t *Base;
+  uint8_t *Paint;
+  uint8_t i;
+
+  Retarget_Init(F_CPU, 9600);
+  BENCH_MARK_DDR = 0xFF;
+  BENCH_MARK = 0;
+  DS1307_Platform_Init(&Handler);
+
+  for (i = 0; i < sizeof(Benches) / sizeof(Benches[0]); i++)
+  {
+    Run = (void (*)(void))pgm_read_word(&Benches[i].Run);
+
+    // paint everything below the current stack pointer
+    Base = (uint8_t *)SP;
+    for (Paint = &_end; Paint < Base; Paint++)
+      *Paint = BENCH_PAINT;
+
+    BENCH_MARK = i + 1;
+    Run();
+    BENCH_MARK = 0;
+
+    for (Paint = &_end; Paint < Base && *Paint == BENCH_PAINT; Paint++)
+      continue;
+
+    printf_P(PSTR("%u %S %u\r\n"), i + 1,
+             (const char *)pgm_read_word(&Benches[i].Name),
+             (unsigned)(Base - Paint));
+  }
+
+  BENCH_MARK = BENCH_END;
+  cli();
+  sleep_enable();
+  sleep_cpu();
+
+  return 0;
+}
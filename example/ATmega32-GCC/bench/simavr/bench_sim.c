@@ -0,0 +1,355 @@
+/**
+ **********************************************************************************
+ * @file   bench_sim.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  simavr harness of the ATmega32 DS1307 Driver benchmark
+ *         Functionalities of the this file:
+ *          + Simulate a DS1307 on the TWI bus of an ATmega32
+ *          + Report cycles, stack and TWI bytes of each benchmark call
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <simavr/sim_avr.h>
+#include <simavr/sim_elf.h>
+#include <simavr/sim_irq.h>
+#include <simavr/avr_twi.h>
+#include <simavr/avr_uart.h>
+#include <simavr/avr_ioport.h>
+#include "DS1307.h"
+#include "DS1307_sim.h"
+
+
+/* Private Constants ------------------------------------------------------------*/
+#define BENCH_ADDRESS     0x68
+#define BENCH_END         0xFF
+#define BENCH_MAX         254
+#define BENCH_TIME_LIMIT  60 // simulated seconds before the run is aborted
+
+
+/* Private Typedef --------------------------------------------------------------*/
+typedef struct Bench_Twi_s
+{
+  avr_t *Avr;
+  avr_irq_t *Irq;
+  avr_cycle_count_t Synced;
+  uint8_t Selected;
+  uint8_t First;
+  uint8_t Pointer;
+  uint32_t Bytes;
+} Bench_Twi_t;
+
+typedef struct Bench_Result_s
+{
+  avr_cycle_count_t Start;
+  avr_cycle_count_t Cycles;
+  uint32_t StartBytes;
+  uint32_t Bytes;
+} Bench_Result_t;
+
+
+
+/* Private Variables ------------------------------------------------------------*/
+static const char *TwiIrqNames[2] =
+{
+  [TWI_IRQ_INPUT] = "8>ds1307.out",
+  [TWI_IRQ_OUTPUT] = "32<ds1307.in",
+};
+
+static Bench_Twi_t Twi;
+static Bench_Result_t Results[BENCH_MAX + 1];
+static uint8_t Current = 0;
+static uint8_t Finished = 0;
+static char Line[128];
+static size_t LineLen = 0;
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####                           
+ ==================================================================================
+ */
+
+/**
+ * @brief  Advance the simulated DS1307 to the current AVR cycle
+ */
+static void
+Bench_TwiSync(Bench_Twi_t *Twi)
+{
+  avr_cycle_count_t Us;
+
+  Us = (Twi->Avr->cycle - Twi->Synced) * 1000000 / Twi->Avr->frequency;
+  if (Us)
+  {
+    DS1307_Sim_Advance((uint32_t)Us);
+    Twi->Synced += Us * Twi->Avr->frequency / 1000000;
+  }
+}
+
+
+/**
+ * @brief  TWI slave: register pointer, auto-increment over the 64 registers
+ */
+static void
+Bench_TwiHook(struct avr_irq_t *Irq, uint32_t Value, void *Param)
+{
+  Bench_Twi_t *Twi = (Bench_Twi_t *)Param;
+  uint8_t *Regs = DS1307_Sim_Registers();
+  avr_twi_msg_irq_t Msg;
+
+  (void)Irq;
+  Msg.u.v = Value;
+  Bench_TwiSync(Twi);
+
+  if (Msg.u.twi.msg & TWI_COND_STOP)
+    Twi->Selected = 0;
+
+  if (Msg.u.twi.msg & TWI_COND_START)
+  {
+    Twi->Selected = ((Msg.u.twi.addr >> 1) == BENCH_ADDRESS);
+    Twi->First = 1;
+    if (!Twi->Selected)
+      return;
+    Twi->Bytes++;
+    avr_raise_irq(Twi->Irq + TWI_IRQ_INPUT,
+                  avr_twi_irq_msg(TWI_COND_ACK, Msg.u.twi.addr, 1));
+  }
+
+  if (!Twi->Selected)
+    return;
+
+  if (Msg.u.twi.msg & TWI_COND_WRITE)
+  {
+    Twi->Bytes++;
+    if (Twi->First)
+    {
+      Twi->Pointer = Msg.u.twi.data & 0x3F;
+      Twi->First = 0;
+    }
+    else
+    {
+      // through the simulator, writing SECOND resets its countdown chain
+      DS1307_Sim_WriteRegister(Twi->Pointer, Msg.u.twi.data);
+      Twi->Pointer = (Twi->Pointer + 1) & 0x3F;
+    }
+    avr_raise_irq(Twi->Irq + TWI_IRQ_INPUT,
+                  avr_twi_irq_msg(TWI_COND_ACK, Msg.u.twi.addr, 1));
+  }
+
+  if (Msg.u.twi.msg & TWI_COND_READ)
+  {
+    Twi->Bytes++;
+    avr_raise_irq(Twi->Irq + TWI_IRQ_INPUT,
+                  avr_twi_irq_msg(TWI_COND_READ, Msg.u.twi.addr,
+                                  Regs[Twi->Pointer]));
+    Twi->Pointer = (Twi->Pointer + 1) & 0x3F;
+  }
+}
+
+
+/**
+ * @brief  Benchmark markers written to PORTA by the firmware
+ */
+static void
+Bench_MarkHook(struct avr_irq_t *Irq, uint32_t Value, void *Param)
+{
+  avr_t *Avr = (avr_t *)Param;
+
+  (void)Irq;
+  if (Value == BENCH_END)
+  {
+    Finished = 1;
+  }
+  else if (Value)
+  {
+    Current = (uint8_t)Value;
+    Results[Current].Start = Avr->cycle;
+    Results[Current].StartBytes = Twi.Bytes;
+  }
+  else if (Current)
+  {
+    Results[Current].Cycles = Avr->cycle - Results[Current].Start;
+    Results[Current].Bytes = Twi.Bytes - Results[Current].StartBytes;
+    Current = 0;
+  }
+}
+
+
+/**
+ * @brief  UART lines "<Number> <Name> <Stack>" are printed as table rows
+ */
+static void
+Bench_UartHook(struct avr_irq_t *Irq, uint32_t Value, void *Param)
+{
+  avr_t *Avr = (avr_t *)Param;
+  unsigned Number, Stack;
+  char Name[64];
+
+  (void)Irq;
+  if (Value == '\r')
+    return;
+  if (Value != '\n')
+  {
+    if (LineLen < sizeof(Line) - 1)
+      Line[LineLen++] = (char)Value;
+    return;
+  }
+
+  Line[LineLen] = '\0';
+  LineLen = 0;
+  if (sscanf(Line, "%u %63s %u", &Number, Name, &Stack) != 3 ||
+      Number == 0 || Number > BENCH_MAX)
+  {
+    printf("# %s\n", Line);
+    return;
+  }
+
+  printf("%-20s %10llu %10.1f %6u %6u\n", Name,
+         (unsigned long long)Results[Number].Cycles,
+         Results[Number].Cycles * 1e6 / Avr->frequency,
+         Stack, (unsigned)Results[Number].Bytes);
+}
+
+
+static void
+Usage(const char *Name)
+{
+  fprintf(stderr,
+          "Usage: %s [-f cpu_hz] [-l label] firmware.elf\n"
+          "  -f  CPU frequency when the ELF does not carry it (8000000)\n"
+          "  -l  label printed above the table (build variant)\n",
+          Name);
+}
+
+
+
+/**
+ ==================================================================================
+                                ##### Main #####                                   
+ ==================================================================================
+ */
+
+int
+main(int argc, char **argv)
+{
+  elf_firmware_t Firmware;
+  DS1307_Handler_t SimHandler = {0};
+  uint32_t Frequency = 8000000;
+  const char *Label = NULL;
+  uint32_t Flags = 0;
+  avr_cycle_count_t Limit;
+  avr_t *Avr;
+  int State;
+  int Opt;
+
+  while ((Opt = getopt(argc, argv, "f:l:")) != -1)
+  {
+    switch (Opt)
+    {
+    case 'f':
+      Frequency = (uint32_t)strtoul(optarg, NULL, 0);
+      break;
+    case 'l':
+      Label = optarg;
+      break;
+    default:
+      Usage(argv[0]);
+      return 2;
+    }
+  }
+  if (optind != argc - 1)
+  {
+    Usage(argv[0]);
+    return 2;
+  }
+
+  memset(&Firmware, 0, sizeof(Firmware));
+  if (elf_read_firmware(argv[optind], &Firmware) != 0)
+  {
+    fprintf(stderr, "can not read %s\n", argv[optind]);
+    return 1;
+  }
+
+  Avr = avr_make_mcu_by_name("atmega32");
+  if (!Avr)
+  {
+    fprintf(stderr, "simavr has no atmega32 core\n");
+    return 1;
+  }
+  avr_init(Avr);
+  avr_load_firmware(Avr, &Firmware);
+  if (!Avr->frequency)
+    Avr->frequency = Frequency;
+
+  // simulated DS1307 (oscillator running)
+  DS1307_Sim_Init(&SimHandler);
+  DS1307_Sim_Registers()[0] &= 0x7F;
+  Twi.Avr = Avr;
+  Twi.Irq = avr_alloc_irq(&Avr->irq_pool, 0, 2, TwiIrqNames);
+  avr_irq_register_notify(Twi.Irq + TWI_IRQ_OUTPUT, Bench_TwiHook, &Twi);
+  avr_connect_irq(Twi.Irq + TWI_IRQ_INPUT,
+                  avr_io_getirq(Avr, AVR_IOCTL_TWI_GETIRQ(0), TWI_IRQ_INPUT));
+  avr_connect_irq(avr_io_getirq(Avr, AVR_IOCTL_TWI_GETIRQ(0), TWI_IRQ_OUTPUT),
+                  Twi.Irq + TWI_IRQ_OUTPUT);
+
+  // external pull-ups on SCL (PC0) and SDA (PC1), used by DS1307_RecoverBus
+  avr_raise_irq(avr_io_getirq(Avr, AVR_IOCTL_IOPORT_GETIRQ('C'), 0), 1);
+  avr_raise_irq(avr_io_getirq(Avr, AVR_IOCTL_IOPORT_GETIRQ('C'), 1), 1);
+
+  avr_irq_register_notify(avr_io_getirq(Avr, AVR_IOCTL_IOPORT_GETIRQ('A'),
+                                        IOPORT_IRQ_REG_PORT),
+                          Bench_MarkHook, Avr);
+
+  avr_ioctl(Avr, AVR_IOCTL_UART_GET_FLAGS('0'), &Flags);
+  Flags &= ~AVR_UART_FLAG_STDIO;
+  avr_ioctl(Avr, AVR_IOCTL_UART_SET_FLAGS('0'), &Flags);
+  avr_irq_register_notify(avr_io_getirq(Avr, AVR_IOCTL_UART_GETIRQ('0'),
+                                        UART_IRQ_OUTPUT),
+                          Bench_UartHook, Avr);
+
+  if (Label)
+    printf("== %s (%u Hz)\n", Label, (unsigned)Avr->frequency);
+  printf("%-20s %10s %10s %6s %6s\n", "call", "cycles", "us", "stack", "twi");
+
+  Limit = (avr_cycle_count_t)Avr->frequency * BENCH_TIME_LIMIT;
+  do
+  {
+    State = avr_run(Avr);
+  } while (State != cpu_Done && State != cpu_Crashed && Avr->cycle < Limit);
+
+  if (!Finished)
+  {
+    fprintf(stderr, "firmware did not finish (state %d, cycle %llu)\n",
+            State, (unsigned long long)Avr->cycle);
+    return 1;
+  }
+
+  return 0;
+}
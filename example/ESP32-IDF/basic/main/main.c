@@ -42,7 +42,7 @@ static const char *TAG = "example";
 
 void app_main(void)
 {
-  DS1307_Handler_t Handler;
+  DS1307_Handler_t Handler = {0};
   DS1307_RunHalt_t RunHalt;
   DS1307_DateTime_t DateTime;
 
@@ -34,6 +34,7 @@
 #include "DS1307_platform.h"
 #include <avr/io.h>
 #include <util/delay.h>
+#include <util/twi.h>
 
 
 /* Private Macro ----------------------------------------------------------------*/
@@ -64,7 +65,7 @@
 static int8_t
 Platform_Init(void)
 {
-  TWBR = (uint8_t)(F_CPU - 1600000) / (2 * DS1307_I2C_RATE);
+  TWBR = (uint8_t)((F_CPU / DS1307_I2C_RATE - 16) / 2); // prescaler 1
   return 0;
 }
 
@@ -76,28 +77,93 @@ Platform_DeInit(void)
 }
 
 
+static int8_t
+Platform_Wait(void)
+{
+  uint16_t Timeout = DS1307_TWI_TIMEOUT;
+
+  while (!CHECKBIT(TWCR, TWINT)) // wait until the process ends
+    if (!--Timeout)
+      return -1;
+
+  return 0;
+}
+
+
+static int8_t
+Platform_Stop(int8_t Result)
+{
+  TWCR = _BV(TWEN) | _BV(TWINT) | _BV(TWSTO); // send the STOP mode bit
+  return Result;
+}
+
+
+static int8_t
+Platform_Recover(void)
+{
+  uint8_t i;
+
+  TWCR = 0; // release the pins from TWI
+
+  // SCL and SDA are driven like open drain lines: output low or input high
+  cbi(DS1307_TWI_PORT, DS1307_SCL_BIT);
+  cbi(DS1307_TWI_PORT, DS1307_SDA_BIT);
+  cbi(DS1307_TWI_DDR, DS1307_SDA_BIT);
+
+  // clock out the byte the slave is still sending
+  for (i = 0; i < 9 && !CHECKBIT(DS1307_TWI_PIN, DS1307_SDA_BIT); i++)
+  {
+    sbi(DS1307_TWI_DDR, DS1307_SCL_BIT);
+    _delay_us(5);
+    cbi(DS1307_TWI_DDR, DS1307_SCL_BIT);
+    _delay_us(5);
+  }
+
+  // STOP: SDA rises while SCL is high
+  sbi(DS1307_TWI_DDR, DS1307_SCL_BIT);
+  sbi(DS1307_TWI_DDR, DS1307_SDA_BIT);
+  _delay_us(5);
+  cbi(DS1307_TWI_DDR, DS1307_SCL_BIT);
+  _delay_us(5);
+  cbi(DS1307_TWI_DDR, DS1307_SDA_BIT);
+  _delay_us(5);
+
+  if (!CHECKBIT(DS1307_TWI_PIN, DS1307_SDA_BIT))
+    return -1;
+
+  return Platform_Init();
+}
+
+
 static int8_t
 Platform_WriteData(uint8_t Address, uint8_t *Data, uint8_t DataLen)
 {
   uint8_t DataCounter = 0;
 
   TWCR = _BV(TWEN) | _BV(TWSTA) | _BV(TWEA) | _BV(TWINT); // TWI enable *** acknowledge enable
-  while (!CHECKBIT(TWCR, TWINT)); // wait until the process ends
+  if (Platform_Wait() < 0)
+    return -2; // bus is held low
+  if (TW_STATUS != TW_START)
+    return -2; // arbitration lost or bus is busy
 
   TWDR = Address<<1;                  // set data in data register to sending
   TWCR = _BV(TWEN) | _BV(TWEA) | _BV(TWINT); // TWI enable *** acknowledge enable
-  while (!CHECKBIT(TWCR, TWINT));
+  if (Platform_Wait() < 0)
+    return Platform_Stop(-1);
+  if (TW_STATUS != TW_MT_SLA_ACK)
+    return Platform_Stop(-3);
 
   for (DataCounter = 0; DataCounter < DataLen; DataCounter++)
   {
     TWDR = Data[DataCounter];                  // set data in data register to sending
     TWCR = _BV(TWEN) | _BV(TWEA) | _BV(TWINT); // TWI enable *** acknowledge enable
-    while (!CHECKBIT(TWCR, TWINT));
+    if (Platform_Wait() < 0)
+      return Platform_Stop(-1);
+    if (TW_STATUS != TW_MT_DATA_ACK)
+      return Platform_Stop(-3);
   }
   
-  TWCR = _BV(TWEN) | _BV(TWINT) | _BV(TWSTO); // send the STOP mode bit
-
-  return 0;
+  return Platform_Stop(0);
 }
 
 
@@ -107,25 +173,31 @@ Platform_ReadData(uint8_t Address, uint8_t *Data, uint8_t DataLen)
   uint8_t DataCounter = 0;
 
   TWCR = _BV(TWEN) | _BV(TWSTA) | _BV(TWEA) | _BV(TWINT); // TWI enable *** acknowledge enable
-  while (!CHECKBIT(TWCR, TWINT)); // wait until the process ends
+  if (Platform_Wait() < 0)
+    return -2; // bus is held low
+  if (TW_STATUS != TW_START)
+    return -2; // arbitration lost or bus is busy
 
   TWDR = (Address<<1) | 0x01;                  // set data in data register to sending
   TWCR = _BV(TWEN) | _BV(TWEA) | _BV(TWINT); // TWI enable *** acknowledge enable
-  while (!CHECKBIT(TWCR, TWINT)); // wait until the process ends
+  if (Platform_Wait() < 0)
+    return Platform_Stop(-1);
+  if (TW_STATUS != TW_MR_SLA_ACK)
+    return Platform_Stop(-3);
 
   for (DataCounter = 0; DataCounter < DataLen - 1; DataCounter++)
   {
     TWCR = _BV(TWEN) | _BV(TWEA) | _BV(TWINT); // TWI enable *** acknowledge enable
-    while (!CHECKBIT(TWCR, TWINT)); // wait until the process ends
+    if (Platform_Wait() < 0)
+      return Platform_Stop(-1);
     Data[DataCounter] = TWDR;
   }
   TWCR = _BV(TWEN) | _BV(TWINT); // TWI enable
-  while (!CHECKBIT(TWCR, TWINT)); // wait until the process ends
+  if (Platform_Wait() < 0)
+    return Platform_Stop(-1);
   Data[DataCounter] = TWDR;
 
-  TWCR = _BV(TWEN) | _BV(TWINT) | _BV(TWSTO); // send the STOP mode bit
-
-  return 0;
+  return Platform_Stop(0);
 }
 
 
@@ -138,14 +210,100 @@ Platform_ReadData(uint8_t Address, uint8_t *Data, uint8_t DataLen)
 
 /**
  * @brief  Initialize platform device to communicate DS1307.
+ * @note   The handler is reset with DS1307_Handler_Init first, so it needs
+ *         no zero initialization. Set Address, Retry and the optional fields
+ *         this port does not provide after this call.
  * @param  Handler: Pointer to handler
  * @retval None
  */
 void
 DS1307_Platform_Init(DS1307_Handler_t *Handler)
 {
+  DS1307_Handler_Init(Handler);
   Handler->PlatformInit = Platform_Init;
   Handler->PlatformDeInit = Platform_DeInit;
   Handler->PlatformSend = Platform_WriteData;
   Handler->PlatformReceive = Platform_ReadData;
+  Handler->PlatformRecover = Platform_Recover;
+}
+
+
+/**
+ * @brief  Count SQW/OUT edges on T0 over a gate timed from the CPU clock
+ *         (DS1307_OscCalCount_t, see DS1307_osccal.h).
+ * @note   Timer0 counts the edges and Timer1 times the gate, both are
+ *         stopped on return.
+ * @param  GateUs: Gate time in microseconds of F_CPU
+ * @param  Edges: Pointer to number of edges
+ * @retval 
+ *         -  0: The operation was successful.
+ */
+int8_t
+DS1307_Platform_CountEdges(uint32_t GateUs, uint32_t *Edges)
+{
+  uint32_t Cycles = (GateUs / 1000) * (F_CPU / 1000) +
+                    (GateUs % 1000) * (F_CPU / 1000) / 1000;
+  uint16_t Gate = (uint16_t)(Cycles >> 16);
+  uint16_t Rest = (uint16_t)Cycles;
+  uint16_t Overflow0 = 0;
+  uint16_t Overflow1 = 0;
+
+  cbi(DS1307_SQW_DDR, DS1307_SQW_BIT);
+  TCCR0 = 0;
+  TCCR1A = 0;
+  TCCR1B = 0;
+  TCNT0 = 0;
+  TCNT1 = 0;
+  TIFR = _BV(TOV0) | _BV(TOV1);
+
+  TCCR0 = _BV(CS02) | _BV(CS01) | _BV(CS00); // external clock on T0, rising edge
+  TCCR1B = _BV(CS10);                          // CPU clock
+
+  // overflows are polled, a Timer0 overflow takes 7.8 ms at 32.768 kHz
+  for (;;)
+  {
+    if (CHECKBIT(TIFR, TOV0))
+    {
+      TIFR = _BV(TOV0);
+      Overflow0++;
+    }
+    if (CHECKBIT(TIFR, TOV1))
+    {
+      TIFR = _BV(TOV1);
+      Overflow1++;
+    }
+    if (Overflow1 > Gate || (Overflow1 == Gate && TCNT1 >= Rest))
+      break;
+  }
+
+  TCCR0 = 0;
+  TCCR1B = 0;
+  if (CHECKBIT(TIFR, TOV0))
+  {
+    TIFR = _BV(TOV0);
+    Overflow0++;
+  }
+
+  *Edges = ((uint32_t)Overflow0 << 8) | TCNT0;
+  return 0;
+}
+
+
+/**
+ * @brief  Trim the internal RC oscillator by one OSCCAL step
+ *         (DS1307_OscCalTrim_t, see DS1307_osccal.h).
+ * @param  Step: +1 to speed up, -1 to slow down
+ * @retval 
+ *         -  0: The operation was successful.
+ *         - -1: OSCCAL is at the end of its range.
+ */
+int8_t
+DS1307_Platform_TrimOsc(int8_t Step)
+{
+  if ((Step > 0 && OSCCAL == 0xFF) || (Step < 0 && OSCCAL == 0))
+    return -1;
+
+  OSCCAL += Step;
+  _delay_us(100); // let the oscillator settle
+  return 0;
 }
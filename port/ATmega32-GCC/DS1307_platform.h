@@ -44,7 +44,31 @@ extern "C" {
 
 
 /* Functionality Options --------------------------------------------------------*/
+#ifndef DS1307_I2C_RATE
 #define DS1307_I2C_RATE  100000
+#endif
+
+/**
+ * @brief  TWI pins (used to release a stuck bus)
+ */
+#define DS1307_TWI_DDR   DDRC
+#define DS1307_TWI_PORT  PORTC
+#define DS1307_TWI_PIN   PINC
+#define DS1307_SCL_BIT   0
+#define DS1307_SDA_BIT   1
+
+/**
+ * @brief  Maximum polls of TWINT flag before a transfer is abandoned
+ */
+#ifndef DS1307_TWI_TIMEOUT
+#define DS1307_TWI_TIMEOUT  10000
+#endif
+
+/**
+ * @brief  SQW/OUT input of DS1307_Platform_CountEdges (T0 pin of Timer0)
+ */
+#define DS1307_SQW_DDR   DDRB
+#define DS1307_SQW_BIT   0
 
 
 
@@ -56,6 +80,9 @@ extern "C" {
 
 /**
  * @brief  Initialize platform device to communicate DS1307.
+ * @note   The handler is reset with DS1307_Handler_Init first, so it needs
+ *         no zero initialization. Set Address, Retry and the optional fields
+ *         this port does not provide after this call.
  * @param  Handler: Pointer to handler
  * @retval None
  */
@@ -63,6 +90,32 @@ void
 DS1307_Platform_Init(DS1307_Handler_t *Handler);
 
 
+/**
+ * @brief  Count SQW/OUT edges on T0 over a gate timed from the CPU clock
+ *         (DS1307_OscCalCount_t, see DS1307_osccal.h).
+ * @note   Timer0 counts the edges and Timer1 times the gate, both are
+ *         stopped on return.
+ * @param  GateUs: Gate time in microseconds of F_CPU
+ * @param  Edges: Pointer to number of edges
+ * @retval 
+ *         -  0: The operation was successful.
+ */
+int8_t
+DS1307_Platform_CountEdges(uint32_t GateUs, uint32_t *Edges);
+
+
+/**
+ * @brief  Trim the internal RC oscillator by one OSCCAL step
+ *         (DS1307_OscCalTrim_t, see DS1307_osccal.h).
+ * @param  Step: +1 to speed up, -1 to slow down
+ * @retval 
+ *         -  0: The operation was successful.
+ *         - -1: OSCCAL is at the end of its range.
+ */
+int8_t
+DS1307_Platform_TrimOsc(int8_t Step);
+
+
 #ifdef __cplusplus
 }
 #endif
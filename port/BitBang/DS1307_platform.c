@@ -0,0 +1,359 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_platform.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  DS1307 chip driver platform dependent part (bit-banged I2C)
+ *         Functionalities of the this file:
+ *          + Initialization the platform-dependent part of handler
+ *          + I2C master on two GPIO pins given as callbacks
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include "DS1307_platform.h"
+#include <stddef.h>
+
+
+/* Private Macro ----------------------------------------------------------------*/
+#if DS1307_BB_LOW_US > 0
+#define BB_DELAY_LOW()    do { if (DelayUs) DelayUs(DS1307_BB_LOW_US); } while (0)
+#else
+#define BB_DELAY_LOW()    do {} while (0)
+#endif
+
+#if DS1307_BB_HIGH_US > 0
+#define BB_DELAY_HIGH()   do { if (DelayUs) DelayUs(DS1307_BB_HIGH_US); } while (0)
+#else
+#define BB_DELAY_HIGH()   do {} while (0)
+#endif
+
+/**
+ * @brief  One clock with the data bit set up during the low time
+ * @note   SDA changes right after SCL falls and is stable for tLOW before
+ *         SCL rises (tSU;DAT), the bit is sampled at the end of tHIGH.
+ */
+#define BB_WRITE_BIT(Bit) \
+  do { \
+    SclWrite(0); \
+    SdaWrite(Bit); \
+    BB_DELAY_LOW(); \
+    BB_SclRelease(); \
+    BB_DELAY_HIGH(); \
+  } while (0)
+
+#define BB_READ_BIT(Byte, Mask) \
+  do { \
+    SclWrite(0); \
+    BB_DELAY_LOW(); \
+    BB_SclRelease(); \
+    BB_DELAY_HIGH(); \
+    if (SdaRead()) \
+      Byte |= (Mask); \
+  } while (0)
+
+
+/* Private Variables ------------------------------------------------------------*/
+static const DS1307_PlatformPins_t *Pins = NULL;
+
+// copies of the pin callbacks, one indirection less in the bit loops
+static void     (*SclWrite)(uint8_t Level);
+static void     (*SdaWrite)(uint8_t Level);
+static uint8_t  (*SdaRead)(void);
+static uint8_t  (*SclRead)(void);
+static void     (*DelayUs)(uint32_t Us);
+
+// a stretched clock timed out during the current transfer
+static int8_t StretchError = 0;
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####                           
+ ==================================================================================
+ */
+
+static inline void
+BB_SclRelease(void)
+{
+  uint16_t Polls = DS1307_BB_STRETCH_POLLS;
+
+  SclWrite(1);
+  if (!SclRead)
+    return;
+
+  // a slave may hold SCL low until it is ready
+  while (!SclRead())
+  {
+    if (--Polls == 0)
+    {
+      StretchError = -2;
+      return;
+    }
+  }
+}
+
+
+static int8_t
+BB_Start(void)
+{
+  // the bus must be idle: both lines released
+  if (!SdaRead() || (SclRead && !SclRead()))
+    return -2;
+
+  SdaWrite(0);
+  BB_DELAY_HIGH(); // tHD;STA
+  return 0;
+}
+
+
+static void
+BB_RepeatedStart(void)
+{
+  SclWrite(0);
+  SdaWrite(1);
+  BB_DELAY_LOW();
+  BB_SclRelease();
+  BB_DELAY_LOW(); // tSU;STA
+  SdaWrite(0);
+  BB_DELAY_HIGH(); // tHD;STA
+}
+
+
+static void
+BB_Stop(void)
+{
+  SclWrite(0);
+  SdaWrite(0);
+  BB_DELAY_LOW();
+  BB_SclRelease();
+  BB_DELAY_HIGH(); // tSU;STO
+  SdaWrite(1);
+  BB_DELAY_LOW(); // tBUF
+}
+
+
+static int8_t
+BB_WriteByte(uint8_t Byte)
+{
+  uint8_t Ack;
+
+  BB_WRITE_BIT(Byte & 0x80);
+  BB_WRITE_BIT(Byte & 0x40);
+  BB_WRITE_BIT(Byte & 0x20);
+  BB_WRITE_BIT(Byte & 0x10);
+  BB_WRITE_BIT(Byte & 0x08);
+  BB_WRITE_BIT(Byte & 0x04);
+  BB_WRITE_BIT(Byte & 0x02);
+  BB_WRITE_BIT(Byte & 0x01);
+
+  // ACK clock, the slave drives SDA
+  BB_WRITE_BIT(1);
+  Ack = !SdaRead();
+
+  if (StretchError)
+    return StretchError;
+  return Ack ? 0 : -3;
+}
+
+
+static uint8_t
+BB_ReadByte(uint8_t Ack)
+{
+  uint8_t Byte = 0;
+
+  SclWrite(0);
+  SdaWrite(1); // let the slave drive SDA
+
+  BB_READ_BIT(Byte, 0x80);
+  BB_READ_BIT(Byte, 0x40);
+  BB_READ_BIT(Byte, 0x20);
+  BB_READ_BIT(Byte, 0x10);
+  BB_READ_BIT(Byte, 0x08);
+  BB_READ_BIT(Byte, 0x04);
+  BB_READ_BIT(Byte, 0x02);
+  BB_READ_BIT(Byte, 0x01);
+
+  // ACK all bytes but the last one
+  BB_WRITE_BIT(!Ack);
+
+  return Byte;
+}
+
+
+static int8_t
+BB_Transfer(uint8_t Address, uint8_t *TxData, uint8_t TxLen,
+            uint8_t *RxData, uint8_t RxLen)
+{
+  int8_t Result = 0;
+  uint8_t i;
+
+  StretchError = 0;
+  if ((Result = BB_Start()) < 0)
+    return Result;
+
+  if (TxData)
+  {
+    Result = BB_WriteByte((uint8_t)(Address << 1));
+    for (i = 0; i < TxLen && Result == 0; i++)
+      Result = BB_WriteByte(TxData[i]);
+
+    if (Result == 0 && RxData)
+      BB_RepeatedStart();
+  }
+
+  if (Result == 0 && RxData)
+  {
+    Result = BB_WriteByte((uint8_t)(Address << 1) | 1);
+    for (i = 0; i < RxLen && Result == 0; i++)
+    {
+      RxData[i] = BB_ReadByte(i + 1 < RxLen);
+      Result = StretchError;
+    }
+  }
+
+  BB_Stop();
+  if (Result == 0)
+    Result = StretchError;
+  return Result;
+}
+
+
+static int8_t
+Platform_Init(void)
+{
+  if (!Pins)
+    return -1;
+
+  SclWrite(1);
+  SdaWrite(1);
+  return 0;
+}
+
+
+static int8_t
+Platform_DeInit(void)
+{
+  SclWrite(1);
+  SdaWrite(1);
+  return 0;
+}
+
+
+static int8_t
+Platform_Recover(void)
+{
+  uint8_t i;
+
+  SdaWrite(1);
+
+  // clock out the byte the slave is still sending
+  for (i = 0; i < 9 && !SdaRead(); i++)
+  {
+    SclWrite(0);
+    BB_DELAY_LOW();
+    SclWrite(1);
+    BB_DELAY_HIGH();
+  }
+
+  // STOP: SDA rises while SCL is high
+  StretchError = 0;
+  BB_Stop();
+
+  return SdaRead() ? 0 : -1;
+}
+
+
+static int8_t
+Platform_WriteData(uint8_t Address, uint8_t *Data, uint8_t DataLen)
+{
+  return BB_Transfer(Address, Data, DataLen, NULL, 0);
+}
+
+
+static int8_t
+Platform_ReadData(uint8_t Address, uint8_t *Data, uint8_t DataLen)
+{
+  return BB_Transfer(Address, NULL, 0, Data, DataLen);
+}
+
+
+static int8_t
+Platform_WriteReadData(uint8_t Address, uint8_t *TxData, uint8_t TxLen,
+                       uint8_t *RxData, uint8_t RxLen)
+{
+  return BB_Transfer(Address, TxData, TxLen, RxData, RxLen);
+}
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####                           
+ ==================================================================================
+ */
+
+/**
+ * @brief  Set the pins used by the next DS1307_Platform_Init call.
+ * @param  PinsConfig: Pointer to callbacks, must stay valid while the handler is used
+ * @retval None
+ */
+void
+DS1307_Platform_SetPins(const DS1307_PlatformPins_t *PinsConfig)
+{
+  Pins = PinsConfig;
+  SclWrite = Pins->SclWrite;
+  SdaWrite = Pins->SdaWrite;
+  SdaRead = Pins->SdaRead;
+  SclRead = Pins->SclRead;
+  DelayUs = Pins->DelayUs;
+}
+
+
+/**
+ * @brief  Initialize platform device to communicate DS1307.
+ * @note   DS1307_Platform_SetPins must be called before.
+ * @note   The handler is reset with DS1307_Handler_Init first, so it needs
+ *         no zero initialization. PlatformDelay and PlatformGetTimeUs are
+ *         set only if pins were given. Set Address and Retry after this call.
+ * @param  Handler: Pointer to handler
+ * @retval None
+ */
+void
+DS1307_Platform_Init(DS1307_Handler_t *Handler)
+{
+  DS1307_Handler_Init(Handler);
+  Handler->PlatformInit = Platform_Init;
+  Handler->PlatformDeInit = Platform_DeInit;
+  Handler->PlatformSend = Platform_WriteData;
+  Handler->PlatformReceive = Platform_ReadData;
+  Handler->PlatformWriteRead = Platform_WriteReadData;
+  Handler->PlatformRecover = Platform_Recover;
+  if (Pins)
+  {
+    Handler->PlatformDelay = Pins->DelayUs;
+    Handler->PlatformGetTimeUs = Pins->GetTimeUs;
+  }
+}
@@ -0,0 +1,127 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_platform.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  DS1307 chip driver platform dependent part (bit-banged I2C)
+ *         Functionalities of the this file:
+ *          + Initialization the platform-dependent part of handler
+ *          + I2C master on two GPIO pins given as callbacks
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _DS1307_PLATFORM_H_
+#define _DS1307_PLATFORM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include "DS1307.h"
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+
+/**
+ * @brief  GPIO callbacks of the bit-banged bus
+ * @note   SCL and SDA must be open-drain (or emulated by switching the pin
+ *         between output low and input) with pull-ups.
+ */
+typedef struct DS1307_PlatformPins_s
+{
+  // Drive line low (Level = 0) or release it (Level != 0)
+  void      (*SclWrite)(uint8_t Level);
+  void      (*SdaWrite)(uint8_t Level);
+  // Read line level (0: low)
+  uint8_t   (*SdaRead)(void);
+  // Read SCL level (optional, NULL: no clock stretching)
+  uint8_t   (*SclRead)(void);
+  // Delay in microseconds (optional, NULL: the callbacks set the bus speed)
+  void      (*DelayUs)(uint32_t Us);
+  // Free running time in microseconds (optional)
+  uint32_t  (*GetTimeUs)(void);
+} DS1307_PlatformPins_t;
+
+
+/* Functionality Options --------------------------------------------------------*/
+/**
+ * @brief  SCL low and high time in microseconds
+ * @note   The DS1307 supports standard mode only: fSCL <= 100 kHz,
+ *         tLOW >= 4.7 us and tHIGH >= 4.0 us. The time of the pin callbacks
+ *         adds to these, on slow CPUs they can be reduced or set to 0.
+ */
+#ifndef DS1307_BB_LOW_US
+#define DS1307_BB_LOW_US      5
+#endif
+#ifndef DS1307_BB_HIGH_US
+#define DS1307_BB_HIGH_US     5
+#endif
+
+/**
+ * @brief  SCL reads before a stretched clock fails the transfer (bus busy)
+ */
+#ifndef DS1307_BB_STRETCH_POLLS
+#define DS1307_BB_STRETCH_POLLS  10000
+#endif
+
+
+
+/**
+ ==================================================================================
+                             ##### Functions #####                                 
+ ==================================================================================
+ */
+
+/**
+ * @brief  Set the pins used by the next DS1307_Platform_Init call.
+ * @param  PinsConfig: Pointer to callbacks, must stay valid while the handler is used
+ * @retval None
+ */
+void
+DS1307_Platform_SetPins(const DS1307_PlatformPins_t *PinsConfig);
+
+
+/**
+ * @brief  Initialize platform device to communicate DS1307.
+ * @note   DS1307_Platform_SetPins must be called before.
+ * @note   The handler is reset with DS1307_Handler_Init first, so it needs
+ *         no zero initialization. PlatformDelay and PlatformGetTimeUs are
+ *         set only if pins were given. Set Address and Retry after this call.
+ * @param  Handler: Pointer to handler
+ * @retval None
+ */
+void
+DS1307_Platform_Init(DS1307_Handler_t *Handler);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif //! _DS1307_PLATFORM_H_
@@ -35,7 +35,18 @@
 #include "sdkconfig.h"
 #include "esp_system.h"
 #include "driver/i2c.h"
+#include "driver/gpio.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "esp_attr.h"
+#include "driver/pcnt.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+
+/* Private Variables ------------------------------------------------------------*/
+static volatile uint32_t PcntOverflows = 0;
+static uint8_t PcntReady = 0;
 
 
 
@@ -45,6 +56,27 @@
  ==================================================================================
  */
 
+static int8_t
+Platform_EspToResult(esp_err_t Err)
+{
+  switch (Err)
+  {
+  case ESP_OK:
+    return 0;
+
+  case ESP_ERR_TIMEOUT: // bus is held by another master or the slave
+  case ESP_ERR_INVALID_STATE:
+    return -2;
+
+  case ESP_FAIL: // slave doesn't ACK
+    return -3;
+
+  default:
+    return -1;
+  }
+}
+
+
 static int8_t
 Platform_Init(void)
 {
@@ -78,10 +110,49 @@ Platform_DeInit(void)
 }
 
 
+static int8_t
+Platform_Recover(void)
+{
+  uint8_t i;
+
+  i2c_driver_delete(DS1307_I2C_NUM);
+
+  // drive the lines as open drain GPIOs
+  gpio_set_level(DS1307_SCL_GPIO, 1);
+  gpio_set_level(DS1307_SDA_GPIO, 1);
+  gpio_set_direction(DS1307_SCL_GPIO, GPIO_MODE_INPUT_OUTPUT_OD);
+  gpio_set_direction(DS1307_SDA_GPIO, GPIO_MODE_INPUT_OUTPUT_OD);
+
+  // clock out the byte the slave is still sending
+  for (i = 0; i < 9 && !gpio_get_level(DS1307_SDA_GPIO); i++)
+  {
+    gpio_set_level(DS1307_SCL_GPIO, 0);
+    esp_rom_delay_us(5);
+    gpio_set_level(DS1307_SCL_GPIO, 1);
+    esp_rom_delay_us(5);
+  }
+
+  // STOP: SDA rises while SCL is high
+  gpio_set_level(DS1307_SCL_GPIO, 0);
+  gpio_set_level(DS1307_SDA_GPIO, 0);
+  esp_rom_delay_us(5);
+  gpio_set_level(DS1307_SCL_GPIO, 1);
+  esp_rom_delay_us(5);
+  gpio_set_level(DS1307_SDA_GPIO, 1);
+  esp_rom_delay_us(5);
+
+  if (!gpio_get_level(DS1307_SDA_GPIO))
+    return -1;
+
+  return Platform_Init();
+}
+
+
 static int8_t
 Platform_WriteData(uint8_t Address, uint8_t *Data, uint8_t DataLen)
 {
   i2c_cmd_handle_t DS1307_i2c_cmd_handle = 0;
+  esp_err_t Err = ESP_OK;
 
   Address <<= 1;
   Address &= 0xFE;
@@ -91,14 +162,49 @@ Platform_WriteData(uint8_t Address, uint8_t *Data, uint8_t DataLen)
   i2c_master_write(DS1307_i2c_cmd_handle, &Address, 1, 1);
   i2c_master_write(DS1307_i2c_cmd_handle, Data, DataLen, 1);
   i2c_master_stop(DS1307_i2c_cmd_handle);
-  if (i2c_master_cmd_begin(DS1307_I2C_NUM, DS1307_i2c_cmd_handle,
-                           1000 / portTICK_PERIOD_MS) != ESP_OK)
-  {
-    i2c_cmd_link_delete(DS1307_i2c_cmd_handle);
+  Err = i2c_master_cmd_begin(DS1307_I2C_NUM, DS1307_i2c_cmd_handle,
+                             DS1307_TIMEOUT / portTICK_PERIOD_MS);
+  i2c_cmd_link_delete(DS1307_i2c_cmd_handle);
+
+  return Platform_EspToResult(Err);
+}
+
+
+static void IRAM_ATTR
+Platform_PcntISR(void *Arg)
+{
+  (void)Arg;
+  PcntOverflows++; // the counter restarts from 0 at DS1307_PCNT_LIMIT
+}
+
+
+static int8_t
+Platform_PcntInit(void)
+{
+  pcnt_config_t Config = {0};
+  esp_err_t Err = ESP_OK;
+
+  Config.pulse_gpio_num = DS1307_SQW_GPIO;
+  Config.ctrl_gpio_num = PCNT_PIN_NOT_USED;
+  Config.channel = PCNT_CHANNEL_0;
+  Config.unit = DS1307_PCNT_UNIT;
+  Config.pos_mode = PCNT_COUNT_INC;
+  Config.neg_mode = PCNT_COUNT_DIS;
+  Config.lctrl_mode = PCNT_MODE_KEEP;
+  Config.hctrl_mode = PCNT_MODE_KEEP;
+  Config.counter_h_lim = DS1307_PCNT_LIMIT;
+  Config.counter_l_lim = -1;
+  if (pcnt_unit_config(&Config) != ESP_OK)
     return -1;
-  }
 
-  i2c_cmd_link_delete(DS1307_i2c_cmd_handle);
+  pcnt_event_enable(DS1307_PCNT_UNIT, PCNT_EVT_H_LIM);
+  Err = pcnt_isr_service_install(0);
+  if (Err != ESP_OK && Err != ESP_ERR_INVALID_STATE) // already installed
+    return -1;
+  if (pcnt_isr_handler_add(DS1307_PCNT_UNIT, Platform_PcntISR, NULL) != ESP_OK)
+    return -1;
+
+  PcntReady = 1;
   return 0;
 }
 
@@ -107,6 +213,7 @@ static int8_t
 Platform_ReadData(uint8_t Address, uint8_t *Data, uint8_t DataLen)
 {
   i2c_cmd_handle_t DS1307_i2c_cmd_handle = 0;
+  esp_err_t Err = ESP_OK;
 
   Address <<= 1;
   Address |= 0x01;
@@ -116,15 +223,11 @@ Platform_ReadData(uint8_t Address, uint8_t *Data, uint8_t DataLen)
   i2c_master_write(DS1307_i2c_cmd_handle, &Address, 1, 1);
   i2c_master_read(DS1307_i2c_cmd_handle, Data, DataLen, I2C_MASTER_LAST_NACK);
   i2c_master_stop(DS1307_i2c_cmd_handle);
-  if (i2c_master_cmd_begin(DS1307_I2C_NUM, DS1307_i2c_cmd_handle,
-                           1000 / portTICK_PERIOD_MS) != ESP_OK)
-  {
-    i2c_cmd_link_delete(DS1307_i2c_cmd_handle);
-    return -1;
-  }
-
+  Err = i2c_master_cmd_begin(DS1307_I2C_NUM, DS1307_i2c_cmd_handle,
+                             DS1307_TIMEOUT / portTICK_PERIOD_MS);
   i2c_cmd_link_delete(DS1307_i2c_cmd_handle);
-  return 0;
+
+  return Platform_EspToResult(Err);
 }
 
 
@@ -137,14 +240,63 @@ Platform_ReadData(uint8_t Address, uint8_t *Data, uint8_t DataLen)
 
 /**
  * @brief  Initialize platform device to communicate DS1307.
+ * @note   The handler is reset with DS1307_Handler_Init first, so it needs
+ *         no zero initialization. Set Address, Retry and the optional fields
+ *         this port does not provide after this call.
  * @param  Handler: Pointer to handler
  * @retval None
  */
 void
 DS1307_Platform_Init(DS1307_Handler_t *Handler)
 {
+  DS1307_Handler_Init(Handler);
   Handler->PlatformInit = Platform_Init;
   Handler->PlatformDeInit = Platform_DeInit;
   Handler->PlatformSend = Platform_WriteData;
   Handler->PlatformReceive = Platform_ReadData;
+  Handler->PlatformRecover = Platform_Recover;
+}
+
+
+/**
+ * @brief  Count SQW/OUT edges with the pulse counter over a gate timed by
+ *         esp_timer (DS1307_OscCalCount_t, see DS1307_osccal.h).
+ * @note   The pulse counter is configured on the first call. The gate is
+ *         timed from the APB clock, so the error of the main crystal is
+ *         measured. It cannot be trimmed: use DS1307_OscCal_ActualHz to
+ *         correct baud rate and timer settings.
+ * @param  GateUs: Gate time in microseconds
+ * @param  Edges: Pointer to number of edges
+ * @retval 
+ *         -  0: The operation was successful.
+ *         - -1: Failed to configure the pulse counter.
+ */
+int8_t
+DS1307_Platform_CountEdges(uint32_t GateUs, uint32_t *Edges)
+{
+  uint32_t Ticks = GateUs / 1000 / portTICK_PERIOD_MS;
+  int16_t Count = 0;
+  int64_t Start = 0;
+
+  if (!PcntReady && Platform_PcntInit() < 0)
+    return -1;
+
+  pcnt_counter_pause(DS1307_PCNT_UNIT);
+  pcnt_counter_clear(DS1307_PCNT_UNIT);
+  PcntOverflows = 0;
+
+  Start = esp_timer_get_time();
+  pcnt_counter_resume(DS1307_PCNT_UNIT);
+
+  // sleep through most of the gate, spin to its end
+  if (Ticks > 2)
+    vTaskDelay(Ticks - 2);
+  while (esp_timer_get_time() - Start < (int64_t)GateUs)
+    continue;
+
+  pcnt_counter_pause(DS1307_PCNT_UNIT);
+  pcnt_get_counter_value(DS1307_PCNT_UNIT, &Count);
+
+  *Edges = PcntOverflows * DS1307_PCNT_LIMIT + (uint32_t)Count;
+  return 0;
 }
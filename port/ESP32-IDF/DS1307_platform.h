@@ -49,6 +49,22 @@ extern "C" {
 #define DS1307_SCL_GPIO  GPIO_NUM_27
 #define DS1307_SDA_GPIO  GPIO_NUM_33
 
+/**
+ * @brief  Timeout of each I2C transfer in ms
+ * @note   DS1307_Retry_t.DeadlineUs does not shorten it, a call can overrun
+ *         the deadline by up to this time.
+ */
+#ifndef DS1307_TIMEOUT
+#define DS1307_TIMEOUT   1000
+#endif
+
+/**
+ * @brief  SQW/OUT input and pulse counter of DS1307_Platform_CountEdges
+ */
+#define DS1307_SQW_GPIO    GPIO_NUM_26
+#define DS1307_PCNT_UNIT   PCNT_UNIT_0
+#define DS1307_PCNT_LIMIT  30000
+
 
 
 /**
@@ -59,6 +75,9 @@ extern "C" {
 
 /**
  * @brief  Initialize platform device to communicate DS1307.
+ * @note   The handler is reset with DS1307_Handler_Init first, so it needs
+ *         no zero initialization. Set Address, Retry and the optional fields
+ *         this port does not provide after this call.
  * @param  Handler: Pointer to handler
  * @retval None
  */
@@ -66,6 +85,23 @@ void
 DS1307_Platform_Init(DS1307_Handler_t *Handler);
 
 
+/**
+ * @brief  Count SQW/OUT edges with the pulse counter over a gate timed by
+ *         esp_timer (DS1307_OscCalCount_t, see DS1307_osccal.h).
+ * @note   The pulse counter is configured on the first call. The gate is
+ *         timed from the APB clock, so the error of the main crystal is
+ *         measured. It cannot be trimmed: use DS1307_OscCal_ActualHz to
+ *         correct baud rate and timer settings.
+ * @param  GateUs: Gate time in microseconds
+ * @param  Edges: Pointer to number of edges
+ * @retval 
+ *         -  0: The operation was successful.
+ *         - -1: Failed to configure the pulse counter.
+ */
+int8_t
+DS1307_Platform_CountEdges(uint32_t GateUs, uint32_t *Edges);
+
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,234 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_coro_i2cdev.hpp
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  DS1307 coroutine transport for Linux i2c-dev
+ *         Functionalities of the this file:
+ *          + Non-blocking transfers run by a worker thread
+ *          + Completion through the executor (eventfd in an epoll loop)
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _DS1307_CORO_I2CDEV_HPP_
+#define _DS1307_CORO_I2CDEV_HPP_
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <cerrno>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/i2c-dev.h>
+#include "DS1307_coro.hpp"
+
+
+namespace ds1307::coro
+{
+
+/**
+ * @brief  Non-blocking transport over a Linux i2c-dev adapter
+ * @note   i2c-dev only has blocking transfers, so they run one by one, in
+ *         start order, on a worker thread of the transport. Done is called
+ *         on that thread; it posts the awaiting coroutine, so the executor
+ *         Notify (an eventfd in the epoll set) wakes the loop, e.g.:
+ *
+ *           executor Exec([Fd] { uint64_t One = 1; write(Fd, &One, 8); });
+ *           i2cdev_transport Bus;
+ *           Bus.open("/dev/i2c-1");
+ *           device<i2cdev_transport> Rtc(Exec, Bus);
+ *           // epoll_wait() on Fd with Exec.next_timeout(), then run_once()
+ *
+ *         The transport must outlive the transfers started on it.
+ */
+class i2cdev_transport
+{
+public:
+  i2cdev_transport() = default;
+  i2cdev_transport(const i2cdev_transport &) = delete;
+  i2cdev_transport &operator=(const i2cdev_transport &) = delete;
+  ~i2cdev_transport() { close(); }
+
+  /**
+   * @brief  Open the adapter and start the worker thread
+   * @param  Path: Path of i2c-dev adapter (e.g. "/dev/i2c-1")
+   * @retval
+   *         -  0: The operation was successful.
+   *         - -1: Failed to open the adapter.
+   */
+  int8_t
+  open(const char *Path)
+  {
+    close();
+    Fd_ = ::open(Path, O_RDWR | O_CLOEXEC);
+    if (Fd_ < 0)
+      return -1;
+
+    SlaveAddress_ = -1;
+    Stop_ = false;
+    Thread_ = std::thread(&i2cdev_transport::Worker, this);
+    return 0;
+  }
+
+  /**
+   * @brief  Stop the worker thread and close the adapter
+   * @note   Transfers still queued complete with -1.
+   */
+  void
+  close()
+  {
+    if (Thread_.joinable())
+    {
+      {
+        std::lock_guard<std::mutex> Lock(Mutex_);
+        Stop_ = true;
+      }
+      Wake_.notify_one();
+      Thread_.join();
+    }
+
+    if (Fd_ >= 0)
+      ::close(Fd_);
+    Fd_ = -1;
+  }
+
+  void
+  start_send(uint8_t Address, const uint8_t *Data, uint8_t Len, completion Done)
+  {
+    Start({true, Address, const_cast<uint8_t *>(Data), Len, Done});
+  }
+
+  void
+  start_receive(uint8_t Address, uint8_t *Data, uint8_t Len, completion Done)
+  {
+    Start({false, Address, Data, Len, Done});
+  }
+
+private:
+  struct request
+  {
+    bool IsSend;
+    uint8_t Address;
+    uint8_t *Data;
+    uint8_t Len;
+    completion Done;
+  };
+
+  int Fd_ = -1;
+  int SlaveAddress_ = -1;
+  bool Stop_ = false;
+  std::thread Thread_;
+  std::mutex Mutex_;
+  std::condition_variable Wake_;
+  std::deque<request> Queue_;
+
+  void
+  Start(const request &Request)
+  {
+    {
+      std::lock_guard<std::mutex> Lock(Mutex_);
+      if (Thread_.joinable() && !Stop_)
+      {
+        Queue_.push_back(Request);
+        Wake_.notify_one();
+        return;
+      }
+    }
+    Request.Done(-1); // not open
+  }
+
+  void
+  Worker()
+  {
+    std::unique_lock<std::mutex> Lock(Mutex_);
+
+    for (;;)
+    {
+      Wake_.wait(Lock, [this] { return Stop_ || !Queue_.empty(); });
+      if (Queue_.empty())
+        return;
+
+      const request Request = Queue_.front();
+      Queue_.pop_front();
+      if (Stop_)
+      {
+        Lock.unlock();
+        Request.Done(-1);
+        Lock.lock();
+        continue;
+      }
+
+      Lock.unlock();
+      Request.Done(Transfer(Request));
+      Lock.lock();
+    }
+  }
+
+  int8_t
+  Transfer(const request &Request)
+  {
+    if (SlaveAddress_ != Request.Address)
+    {
+      if (ioctl(Fd_, I2C_SLAVE, Request.Address) < 0)
+        return ErrnoToResult();
+      SlaveAddress_ = Request.Address;
+    }
+
+    const ssize_t Len = Request.IsSend ?
+                        write(Fd_, Request.Data, Request.Len) :
+                        read(Fd_, Request.Data, Request.Len);
+    return Len == Request.Len ? 0 : ErrnoToResult();
+  }
+
+  // same mapping as DS1307_platform.c of this port
+  static int8_t
+  ErrnoToResult() noexcept
+  {
+    switch (errno)
+    {
+    case EBUSY:
+    case EAGAIN:
+    case ETIMEDOUT:
+      return -2;
+
+    case ENXIO:
+    case EREMOTEIO:
+      return -3;
+
+    default:
+      return -1;
+    }
+  }
+};
+
+} // namespace ds1307::coro
+
+
+#endif //! _DS1307_CORO_I2CDEV_HPP_
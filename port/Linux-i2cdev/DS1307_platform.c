@@ -0,0 +1,312 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_platform.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  DS1307 chip driver platform dependent part
+ *         Functionalities of the this file:
+ *          + Initialization the platform-dependent part of handler
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include "DS1307_platform.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+
+/* Private Variables ------------------------------------------------------------*/
+static DS1307_PlatformDevice_t Default = {DS1307_I2C_DEV, -1, -1};
+
+// adapter selected by the last transfer of this thread
+static __thread DS1307_PlatformDevice_t *Current = NULL;
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####                           
+ ==================================================================================
+ */
+
+static int8_t
+Platform_ErrnoToResult(void)
+{
+  switch (errno)
+  {
+  case EBUSY:
+  case EAGAIN:
+  case ETIMEDOUT:
+    return -2;
+
+  case ENXIO:
+  case EREMOTEIO:
+    return -3;
+
+  default:
+    return -1;
+  }
+}
+
+
+static DS1307_PlatformDevice_t *
+Platform_Device(void)
+{
+  return Current ? Current : &Default;
+}
+
+
+static int8_t
+Platform_SetSlave(DS1307_PlatformDevice_t *Dev, uint8_t Address)
+{
+  if (Dev->SlaveAddress == Address)
+    return 0;
+
+  if (ioctl(Dev->Fd, I2C_SLAVE, Address) < 0)
+    return Platform_ErrnoToResult();
+
+  Dev->SlaveAddress = Address;
+  return 0;
+}
+
+
+static int8_t
+Platform_Open(DS1307_PlatformDevice_t *Dev)
+{
+  Dev->Fd = open(Dev->Path, O_RDWR | O_CLOEXEC);
+  if (Dev->Fd < 0)
+    return -1;
+
+  Dev->SlaveAddress = -1;
+  return 0;
+}
+
+
+static void
+Platform_Close(DS1307_PlatformDevice_t *Dev)
+{
+  if (Dev->Fd >= 0)
+    close(Dev->Fd);
+  Dev->Fd = -1;
+}
+
+
+static int8_t
+Platform_Init(void)
+{
+  Current = &Default;
+  return Platform_Open(&Default);
+}
+
+
+static int8_t
+Platform_DeInit(void)
+{
+  Platform_Close(&Default);
+  return 0;
+}
+
+
+static int8_t
+Platform_Recover(void)
+{
+  DS1307_PlatformDevice_t *Dev = Platform_Device();
+
+  // i2c-dev gives user space no way to clock SCL, so this is no 9-clock
+  // recovery: it only reopens the adapter. A stuck SDA is released only if
+  // the adapter driver has bus recovery and runs it on the failed transfer.
+  Platform_Close(Dev);
+  return Platform_Open(Dev);
+}
+
+
+static int8_t
+Platform_Select(void *Context)
+{
+  Current = (DS1307_PlatformDevice_t *)Context;
+  return 0;
+}
+
+
+static int8_t
+Platform_WriteData(uint8_t Address, uint8_t *Data, uint8_t DataLen)
+{
+  DS1307_PlatformDevice_t *Dev = Platform_Device();
+  int8_t Result = Platform_SetSlave(Dev, Address);
+
+  if (Result < 0)
+    return Result;
+
+  if (write(Dev->Fd, Data, DataLen) != DataLen)
+    return Platform_ErrnoToResult();
+
+  return 0;
+}
+
+
+static int8_t
+Platform_ReadData(uint8_t Address, uint8_t *Data, uint8_t DataLen)
+{
+  DS1307_PlatformDevice_t *Dev = Platform_Device();
+  int8_t Result = Platform_SetSlave(Dev, Address);
+
+  if (Result < 0)
+    return Result;
+
+  if (read(Dev->Fd, Data, DataLen) != DataLen)
+    return Platform_ErrnoToResult();
+
+  return 0;
+}
+
+
+static int8_t
+Platform_WriteReadData(uint8_t Address, uint8_t *TxData, uint8_t TxLen,
+                       uint8_t *RxData, uint8_t RxLen)
+{
+  struct i2c_msg Msgs[2] =
+  {
+    {.addr = Address, .flags = 0, .len = TxLen, .buf = TxData},
+    {.addr = Address, .flags = I2C_M_RD, .len = RxLen, .buf = RxData}
+  };
+  struct i2c_rdwr_ioctl_data Transfer = {.msgs = Msgs, .nmsgs = 2};
+
+  // one ioctl, one repeated START: half the system calls of write() + read()
+  if (ioctl(Platform_Device()->Fd, I2C_RDWR, &Transfer) != 2)
+    return Platform_ErrnoToResult();
+
+  return 0;
+}
+
+
+static void
+Platform_Delay(uint32_t Us)
+{
+  struct timespec Time = {Us / 1000000, (Us % 1000000) * 1000};
+
+  while (nanosleep(&Time, &Time) < 0 && errno == EINTR)
+    continue;
+}
+
+
+static uint32_t
+Platform_GetTimeUs(void)
+{
+  struct timespec Time;
+
+  clock_gettime(CLOCK_MONOTONIC, &Time);
+  return (uint32_t)((uint64_t)Time.tv_sec * 1000000 + Time.tv_nsec / 1000);
+}
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####                           
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize platform device to communicate DS1307.
+ * @note   The handler is reset with DS1307_Handler_Init first, so it needs
+ *         no zero initialization. Set Address and Retry after this call.
+ * @param  Handler: Pointer to handler
+ * @retval None
+ */
+void
+DS1307_Platform_Init(DS1307_Handler_t *Handler)
+{
+  DS1307_Handler_Init(Handler);
+  Handler->PlatformInit = Platform_Init;
+  Handler->PlatformDeInit = Platform_DeInit;
+  Handler->PlatformSend = Platform_WriteData;
+  Handler->PlatformReceive = Platform_ReadData;
+  Handler->PlatformWriteRead = Platform_WriteReadData;
+  Handler->PlatformDelay = Platform_Delay;
+  Handler->PlatformGetTimeUs = Platform_GetTimeUs;
+  Handler->PlatformRecover = Platform_Recover;
+  Handler->PlatformSelect = Platform_Select;
+  Handler->PlatformContext = &Default;
+}
+
+
+/**
+ * @brief  Select i2c-dev adapter used by the next DS1307_Init call.
+ * @note   DS1307_I2C_DEV is used if this function is not called.
+ * @param  Path: Path of i2c-dev adapter (e.g. "/dev/i2c-0")
+ * @retval None
+ */
+void
+DS1307_Platform_SetDevice(const char *Path)
+{
+  Default.Path = Path;
+}
+
+
+/**
+ * @brief  Connect handler to its own i2c-dev adapter and open it.
+ * @note   Handlers opened this way can be used together and from any thread
+ *         (one transfer at a time per handler). PlatformSelect is used to
+ *         switch adapters, so DS1307_mux.h cannot be used with them.
+ *         DS1307_Init/DS1307_DeInit do not open or close the adapter.
+ * @param  Handler: Pointer to handler
+ * @param  Device: Pointer to adapter state, must stay valid until it is closed
+ * @param  Path: Path of i2c-dev adapter (e.g. "/dev/i2c-3")
+ * @retval
+ *         -  0: The operation was successful.
+ *         - -1: Failed to open the adapter.
+ */
+int8_t
+DS1307_Platform_OpenDevice(DS1307_Handler_t *Handler,
+                           DS1307_PlatformDevice_t *Device, const char *Path)
+{
+  Device->Path = Path;
+  if (Platform_Open(Device) < 0)
+    return -1;
+
+  DS1307_Platform_Init(Handler);
+  Handler->PlatformInit = NULL;
+  Handler->PlatformDeInit = NULL;
+  Handler->PlatformContext = Device;
+  return 0;
+}
+
+
+/**
+ * @brief  Close the adapter opened by DS1307_Platform_OpenDevice.
+ * @param  Device: Pointer to adapter state
+ * @retval None
+ */
+void
+DS1307_Platform_CloseDevice(DS1307_PlatformDevice_t *Device)
+{
+  Platform_Close(Device);
+  if (Current == Device)
+    Current = NULL;
+}
@@ -0,0 +1,123 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_platform.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  DS1307 chip driver platform dependent part
+ *         Functionalities of the this file:
+ *          + Initialization the platform-dependent part of handler
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _DS1307_PLATFORM_H_
+#define _DS1307_PLATFORM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include "DS1307.h"
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+
+/**
+ * @brief  i2c-dev adapter of a handler (see DS1307_Platform_OpenDevice)
+ */
+typedef struct DS1307_PlatformDevice_s
+{
+  const char *Path;
+  int         Fd;
+  int         SlaveAddress;
+} DS1307_PlatformDevice_t;
+
+
+/* Functionality Options --------------------------------------------------------*/
+#define DS1307_I2C_DEV   "/dev/i2c-1"
+
+
+
+/**
+ ==================================================================================
+                             ##### Functions #####                                 
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize platform device to communicate DS1307.
+ * @note   The handler is reset with DS1307_Handler_Init first, so it needs
+ *         no zero initialization. Set Address and Retry after this call.
+ * @param  Handler: Pointer to handler
+ * @retval None
+ */
+void
+DS1307_Platform_Init(DS1307_Handler_t *Handler);
+
+
+/**
+ * @brief  Select i2c-dev adapter used by the next DS1307_Init call.
+ * @note   DS1307_I2C_DEV is used if this function is not called.
+ * @param  Path: Path of i2c-dev adapter (e.g. "/dev/i2c-0")
+ * @retval None
+ */
+void
+DS1307_Platform_SetDevice(const char *Path);
+
+
+/**
+ * @brief  Connect handler to its own i2c-dev adapter and open it.
+ * @note   Handlers opened this way can be used together and from any thread
+ *         (one transfer at a time per handler). PlatformSelect is used to
+ *         switch adapters, so DS1307_mux.h cannot be used with them.
+ *         DS1307_Init/DS1307_DeInit do not open or close the adapter.
+ * @param  Handler: Pointer to handler
+ * @param  Device: Pointer to adapter state, must stay valid until it is closed
+ * @param  Path: Path of i2c-dev adapter (e.g. "/dev/i2c-3")
+ * @retval
+ *         -  0: The operation was successful.
+ *         - -1: Failed to open the adapter.
+ */
+int8_t
+DS1307_Platform_OpenDevice(DS1307_Handler_t *Handler,
+                           DS1307_PlatformDevice_t *Device, const char *Path);
+
+
+/**
+ * @brief  Close the adapter opened by DS1307_Platform_OpenDevice.
+ * @param  Device: Pointer to adapter state
+ * @retval None
+ */
+void
+DS1307_Platform_CloseDevice(DS1307_PlatformDevice_t *Device);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif //! _DS1307_PLATFORM_H_
@@ -35,11 +35,6 @@
 #include "main.h"
 
 
-/* Private Constants ------------------------------------------------------------*/
-#if defined(DS1307_PLATFORM_STM32_HAL)
-#define DS1307_TIMEOUT 100
-#endif
-
 
 /**
  ==================================================================================
@@ -47,6 +42,27 @@
  ==================================================================================
  */
 
+static int8_t
+Platform_HalToResult(HAL_StatusTypeDef Status)
+{
+  extern I2C_HandleTypeDef DS1307_HI2C;
+
+  switch (Status)
+  {
+  case HAL_OK:
+    return 0;
+
+  case HAL_BUSY:
+    return -2;
+
+  default:
+    if (HAL_I2C_GetError(&DS1307_HI2C) & HAL_I2C_ERROR_AF)
+      return -3;
+    return -1;
+  }
+}
+
+
 static int8_t
 Platform_Init(void)
 {
@@ -61,14 +77,59 @@ Platform_DeInit(void)
 }
 
 
+static void
+Platform_HalfClock(void)
+{
+  volatile uint32_t Count = SystemCoreClock / 400000; // ~5us, >= 2 cycles per loop
+
+  while (Count--);
+}
+
+
 static int8_t
-Platform_WriteData(uint8_t Address, uint8_t *Data, uint8_t DataLen)
+Platform_Recover(void)
 {
   extern I2C_HandleTypeDef DS1307_HI2C;
+  GPIO_InitTypeDef GPIO_InitStruct = {0};
+  uint8_t i;
+
+  HAL_I2C_DeInit(&DS1307_HI2C);
+
+  // drive the lines as open drain GPIOs
+  HAL_GPIO_WritePin(DS1307_SCL_PORT, DS1307_SCL_PIN, GPIO_PIN_SET);
+  HAL_GPIO_WritePin(DS1307_SDA_PORT, DS1307_SDA_PIN, GPIO_PIN_SET);
+  GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_OD;
+  GPIO_InitStruct.Pull = GPIO_NOPULL;
+  GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+  GPIO_InitStruct.Pin = DS1307_SCL_PIN;
+  HAL_GPIO_Init(DS1307_SCL_PORT, &GPIO_InitStruct);
+  GPIO_InitStruct.Pin = DS1307_SDA_PIN;
+  HAL_GPIO_Init(DS1307_SDA_PORT, &GPIO_InitStruct);
+
+  // clock out the byte the slave is still sending
+  for (i = 0; i < 9 &&
+       HAL_GPIO_ReadPin(DS1307_SDA_PORT, DS1307_SDA_PIN) == GPIO_PIN_RESET; i++)
+  {
+    HAL_GPIO_WritePin(DS1307_SCL_PORT, DS1307_SCL_PIN, GPIO_PIN_RESET);
+    Platform_HalfClock();
+    HAL_GPIO_WritePin(DS1307_SCL_PORT, DS1307_SCL_PIN, GPIO_PIN_SET);
+    Platform_HalfClock();
+  }
+
+  // STOP: SDA rises while SCL is high
+  HAL_GPIO_WritePin(DS1307_SCL_PORT, DS1307_SCL_PIN, GPIO_PIN_RESET);
+  HAL_GPIO_WritePin(DS1307_SDA_PORT, DS1307_SDA_PIN, GPIO_PIN_RESET);
+  Platform_HalfClock();
+  HAL_GPIO_WritePin(DS1307_SCL_PORT, DS1307_SCL_PIN, GPIO_PIN_SET);
+  Platform_HalfClock();
+  HAL_GPIO_WritePin(DS1307_SDA_PORT, DS1307_SDA_PIN, GPIO_PIN_SET);
+  Platform_HalfClock();
+
+  if (HAL_GPIO_ReadPin(DS1307_SDA_PORT, DS1307_SDA_PIN) == GPIO_PIN_RESET)
+    return -1;
 
-  Address <<= 1;
-  if (HAL_I2C_Master_Transmit(&DS1307_HI2C, Address,
-                              Data, DataLen, DS1307_TIMEOUT))
+  // HAL_I2C_MspInit gives the pins back to the peripheral
+  if (HAL_I2C_Init(&DS1307_HI2C) != HAL_OK)
     return -1;
 
   return 0;
@@ -76,16 +137,24 @@ Platform_WriteData(uint8_t Address, uint8_t *Data, uint8_t DataLen)
 
 
 static int8_t
-Platform_ReadData(uint8_t Address, uint8_t *Data, uint8_t DataLen)
+Platform_WriteData(uint8_t Address, uint8_t *Data, uint8_t DataLen)
 {
   extern I2C_HandleTypeDef DS1307_HI2C;
 
   Address <<= 1;
-  if (HAL_I2C_Master_Receive(&DS1307_HI2C, Address,
-                             Data, DataLen, DS1307_TIMEOUT))
-    return -1;
+  return Platform_HalToResult(HAL_I2C_Master_Transmit(&DS1307_HI2C, Address,
+                                                      Data, DataLen, DS1307_TIMEOUT));
+}
 
-  return 0;
+
+static int8_t
+Platform_ReadData(uint8_t Address, uint8_t *Data, uint8_t DataLen)
+{
+  extern I2C_HandleTypeDef DS1307_HI2C;
+
+  Address <<= 1;
+  return Platform_HalToResult(HAL_I2C_Master_Receive(&DS1307_HI2C, Address,
+                                                     Data, DataLen, DS1307_TIMEOUT));
 }
 
 
@@ -98,14 +167,19 @@ Platform_ReadData(uint8_t Address, uint8_t *Data, uint8_t DataLen)
 
 /**
  * @brief  Initialize platform device to communicate DS1307.
+ * @note   The handler is reset with DS1307_Handler_Init first, so it needs
+ *         no zero initialization. Set Address, Retry and the optional fields
+ *         this port does not provide after this call.
  * @param  Handler: Pointer to handler
  * @retval None
  */
 void
 DS1307_Platform_Init(DS1307_Handler_t *Handler)
 {
+  DS1307_Handler_Init(Handler);
   Handler->PlatformInit = Platform_Init;
   Handler->PlatformDeInit = Platform_DeInit;
   Handler->PlatformSend = Platform_WriteData;
   Handler->PlatformReceive = Platform_ReadData;
+  Handler->PlatformRecover = Platform_Recover;
 }
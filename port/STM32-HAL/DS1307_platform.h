@@ -46,6 +46,23 @@ extern "C" {
 /* Functionality Options --------------------------------------------------------*/
 #define DS1307_HI2C      hi2c2
 
+/**
+ * @brief  I2C pins (used to release a stuck bus)
+ */
+#define DS1307_SCL_PORT  GPIOB
+#define DS1307_SCL_PIN   GPIO_PIN_10
+#define DS1307_SDA_PORT  GPIOB
+#define DS1307_SDA_PIN   GPIO_PIN_11
+
+/**
+ * @brief  Timeout of each I2C transfer in ms
+ * @note   DS1307_Retry_t.DeadlineUs does not shorten it, a call can overrun
+ *         the deadline by up to this time.
+ */
+#ifndef DS1307_TIMEOUT
+#define DS1307_TIMEOUT   100
+#endif
+
 
 
 /**
@@ -56,6 +73,9 @@ extern "C" {
 
 /**
  * @brief  Initialize platform device to communicate DS1307.
+ * @note   The handler is reset with DS1307_Handler_Init first, so it needs
+ *         no zero initialization. Set Address, Retry and the optional fields
+ *         this port does not provide after this call.
  * @param  Handler: Pointer to handler
  * @retval None
  */
@@ -0,0 +1,403 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_sim.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  DS1307 simulated platform with fault injection
+ *         Functionalities of the this file:
+ *          + Emulate DS1307 registers, oscillator and bus timing in virtual time
+ *          + Inject bus busy, NACK and bus errors at configurable rates
+ *          + Simulate a bus stuck low until the platform recovers it
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include <string.h>
+#include "DS1307_sim.h"
+
+
+/* Private Constants ------------------------------------------------------------*/
+#define DS1307_SIM_ADDRESS  0x68
+#define DS1307_SIM_REGS     64
+#define DS1307_SIM_US_PER_S 1000000UL
+
+
+/* Private Variables ------------------------------------------------------------*/
+static uint8_t Regs[DS1307_SIM_REGS];
+static uint8_t Pointer;
+static uint32_t Now;          // virtual time in us
+static uint32_t SubSecond;    // oscillator phase in us
+static DS1307_SimFaults_t Config;
+static DS1307_SimStats_t Counters;
+static uint32_t Random = 1;
+static uint8_t BurstLeft;
+static int8_t BurstResult;
+static uint8_t Stuck;
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####                           
+ ==================================================================================
+ */
+
+static uint32_t
+Sim_Random(void)
+{
+  // xorshift32
+  Random ^= Random << 13;
+  Random ^= Random >> 17;
+  Random ^= Random << 5;
+  return Random;
+}
+
+
+static void
+Sim_Tick(uint32_t Seconds)
+{
+  DS1307_DateTime_t DateTime;
+  uint32_t Unix = 0;
+
+  DateTime.Second   = ((Regs[0] >> 4) & 0x07) * 10 + (Regs[0] & 0x0F);
+  DateTime.Minute   = (Regs[1] >> 4) * 10 + (Regs[1] & 0x0F);
+  DateTime.Hour     = ((Regs[2] >> 4) & 0x03) * 10 + (Regs[2] & 0x0F);
+  DateTime.WeekDay  = Regs[3] & 0x07;
+  DateTime.Day      = (Regs[4] >> 4) * 10 + (Regs[4] & 0x0F);
+  DateTime.Month    = (Regs[5] >> 4) * 10 + (Regs[5] & 0x0F);
+  DateTime.Year     = (Regs[6] >> 4) * 10 + (Regs[6] & 0x0F);
+
+  // like the real chip, garbage in the time registers does not tick sensibly
+  if (DS1307_DateTimeToUnix(&DateTime, &Unix) != DS1307_OK ||
+      DS1307_UnixToDateTime(Unix + Seconds, &DateTime) != DS1307_OK)
+    return;
+
+  Regs[0] = ((DateTime.Second / 10) << 4) | (DateTime.Second % 10);
+  Regs[1] = ((DateTime.Minute / 10) << 4) | (DateTime.Minute % 10);
+  Regs[2] = ((DateTime.Hour / 10) << 4) | (DateTime.Hour % 10);
+  Regs[3] = DateTime.WeekDay;
+  Regs[4] = ((DateTime.Day / 10) << 4) | (DateTime.Day % 10);
+  Regs[5] = ((DateTime.Month / 10) << 4) | (DateTime.Month % 10);
+  Regs[6] = ((DateTime.Year / 10) << 4) | (DateTime.Year % 10);
+}
+
+
+static uint32_t
+Sim_BusUs(uint8_t Bytes)
+{
+  // 9 clocks per byte plus START and STOP
+  return ((uint32_t)Bytes * 9 + 2) * DS1307_SIM_US_PER_S / DS1307_SIM_I2C_RATE;
+}
+
+
+static int8_t
+Sim_Fault(void)
+{
+  uint32_t Roll;
+
+  if (BurstLeft)
+  {
+    BurstLeft--;
+    return BurstResult;
+  }
+
+  Roll = Sim_Random() % 1000;
+  if (Roll < Config.BusyPerMille)
+    BurstResult = -2;
+  else if (Roll < (uint32_t)Config.BusyPerMille + Config.NackPerMille)
+    BurstResult = -3;
+  else if (Roll < (uint32_t)Config.BusyPerMille + Config.NackPerMille +
+                  Config.FailPerMille)
+    BurstResult = -1;
+  else
+    return 0;
+
+  BurstLeft = Config.Burst ? Config.Burst - 1 : 0;
+  return BurstResult;
+}
+
+
+static int8_t
+Sim_Transfer(uint8_t Address, uint8_t Len, uint8_t Starts)
+{
+  int8_t Result = 0;
+
+  Counters.Transfers++;
+
+  if (Address != DS1307_SIM_ADDRESS)
+  {
+    DS1307_Sim_Advance(Sim_BusUs(1));
+    return -3;
+  }
+
+  Result = Stuck ? -2 : Sim_Fault();
+  if (Result < 0)
+  {
+    Counters.Faults++;
+    DS1307_Sim_Advance(Config.FaultUs ? Config.FaultUs : Sim_BusUs(1));
+    return Result;
+  }
+
+  // an address byte after each START, a repeated START costs one more clock
+  Counters.Bytes += Len;
+  DS1307_Sim_Advance(Sim_BusUs(Len + Starts) +
+                     (Starts - 1) * DS1307_SIM_US_PER_S / DS1307_SIM_I2C_RATE);
+  return 0;
+}
+
+
+static void
+Sim_Write(uint8_t *Data, uint8_t DataLen)
+{
+  uint8_t i;
+
+  if (!DataLen)
+    return;
+
+  Pointer = Data[0] & (DS1307_SIM_REGS - 1);
+  for (i = 1; i < DataLen; i++)
+  {
+    if (Pointer == 0)
+      SubSecond = 0; // writing SECOND resets the countdown chain
+    Regs[Pointer] = Data[i];
+    Pointer = (Pointer + 1) & (DS1307_SIM_REGS - 1);
+  }
+}
+
+
+static void
+Sim_Read(uint8_t *Data, uint8_t DataLen)
+{
+  uint8_t i;
+
+  for (i = 0; i < DataLen; i++)
+  {
+    Data[i] = Regs[Pointer];
+    Pointer = (Pointer + 1) & (DS1307_SIM_REGS - 1);
+  }
+}
+
+
+static int8_t
+Sim_InitDeInit(void)
+{
+  return 0;
+}
+
+
+static int8_t
+Sim_Recover(void)
+{
+  Counters.Recoveries++;
+  Stuck = 0;
+  DS1307_Sim_Advance(Sim_BusUs(1)); // 9 clocks and STOP
+  return 0;
+}
+
+
+static int8_t
+Sim_Send(uint8_t Address, uint8_t *Data, uint8_t DataLen)
+{
+  int8_t Result = Sim_Transfer(Address, DataLen, 1);
+
+  if (Result < 0)
+    return Result;
+
+  Sim_Write(Data, DataLen);
+  return 0;
+}
+
+
+static int8_t
+Sim_Receive(uint8_t Address, uint8_t *Data, uint8_t DataLen)
+{
+  int8_t Result = Sim_Transfer(Address, DataLen, 1);
+
+  if (Result < 0)
+    return Result;
+
+  Sim_Read(Data, DataLen);
+  return 0;
+}
+
+
+static int8_t
+Sim_WriteRead(uint8_t Address, uint8_t *TxData, uint8_t TxLen,
+              uint8_t *RxData, uint8_t RxLen)
+{
+  int8_t Result = Sim_Transfer(Address, TxLen + RxLen, 2);
+
+  if (Result < 0)
+    return Result;
+
+  Sim_Write(TxData, TxLen);
+  Sim_Read(RxData, RxLen);
+  return 0;
+}
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####                           
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize the simulated platform and connect it to handler.
+ * @note   Registers are set to the DS1307 power-on state (oscillator halted)
+ *         and PlatformDelay/PlatformGetTimeUs are set to the virtual clock.
+ *         The handler is reset with DS1307_Handler_Init first.
+ * @param  Handler: Pointer to handler
+ * @retval None
+ */
+void
+DS1307_Sim_Init(DS1307_Handler_t *Handler)
+{
+  static const uint8_t PowerOn[8] = {0x80, 0x00, 0x00, 0x01, 0x01, 0x01, 0x00, 0x03};
+
+  memset(Regs, 0, sizeof(Regs));
+  memcpy(Regs, PowerOn, sizeof(PowerOn));
+  Pointer = 0;
+  SubSecond = 0;
+  Stuck = 0;
+  memset(&Counters, 0, sizeof(Counters));
+
+  DS1307_Handler_Init(Handler);
+  Handler->PlatformInit = Sim_InitDeInit;
+  Handler->PlatformDeInit = Sim_InitDeInit;
+  Handler->PlatformSend = Sim_Send;
+  Handler->PlatformReceive = Sim_Receive;
+  Handler->PlatformWriteRead = Sim_WriteRead;
+  Handler->PlatformRecover = Sim_Recover;
+  Handler->PlatformDelay = DS1307_Sim_Advance;
+  Handler->PlatformGetTimeUs = DS1307_Sim_GetTimeUs;
+}
+
+
+/**
+ * @brief  Set fault injection options (NULL disables fault injection)
+ * @param  Faults: Pointer to options
+ * @retval None
+ */
+void
+DS1307_Sim_SetFaults(const DS1307_SimFaults_t *Faults)
+{
+  if (Faults)
+    Config = *Faults;
+  else
+    memset(&Config, 0, sizeof(Config));
+
+  if (Config.Seed)
+    Random = Config.Seed;
+  BurstLeft = 0;
+}
+
+
+/**
+ * @brief  Hold SDA low (as after a reset in the middle of a read)
+ * @note   Every transfer returns -2 until PlatformRecover is called.
+ * @retval None
+ */
+void
+DS1307_Sim_StuckBus(void)
+{
+  Stuck = 1;
+}
+
+
+/**
+ * @brief  Advance virtual time (the oscillator ticks if it is running)
+ * @param  Us: Time in microseconds
+ * @retval None
+ */
+void
+DS1307_Sim_Advance(uint32_t Us)
+{
+  Now += Us;
+
+  if (Regs[0] & 0x80)
+    return; // oscillator is halted
+
+  SubSecond += Us;
+  if (SubSecond >= DS1307_SIM_US_PER_S)
+  {
+    Sim_Tick(SubSecond / DS1307_SIM_US_PER_S);
+    SubSecond %= DS1307_SIM_US_PER_S;
+  }
+}
+
+
+/**
+ * @brief  Get virtual time
+ * @retval Virtual time in microseconds
+ */
+uint32_t
+DS1307_Sim_GetTimeUs(void)
+{
+  return Now;
+}
+
+
+/**
+ * @brief  Get and reset simulator statistics
+ * @param  Stats: Pointer to statistics
+ * @retval None
+ */
+void
+DS1307_Sim_GetStats(DS1307_SimStats_t *Stats)
+{
+  *Stats = Counters;
+  memset(&Counters, 0, sizeof(Counters));
+}
+
+
+/**
+ * @brief  Direct access to the 64 simulated registers (time, control, RAM)
+ * @retval Pointer to registers
+ */
+uint8_t *
+DS1307_Sim_Registers(void)
+{
+  return Regs;
+}
+
+
+/**
+ * @brief  Write one register like a bus write does, without bus time
+ * @note   For bus models outside the simulator (e.g. simavr TWI slave).
+ *         Writing SECOND resets the countdown chain.
+ * @param  Reg: Register address (0 to 63)
+ * @param  Value: Register value
+ * @retval None
+ */
+void
+DS1307_Sim_WriteRegister(uint8_t Reg, uint8_t Value)
+{
+  uint8_t Data[2];
+
+  Data[0] = Reg;
+  Data[1] = Value;
+  Sim_Write(Data, sizeof(Data));
+}
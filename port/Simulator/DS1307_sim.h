@@ -0,0 +1,170 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_sim.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  DS1307 simulated platform with fault injection
+ *         Functionalities of the this file:
+ *          + Emulate DS1307 registers, oscillator and bus timing in virtual time
+ *          + Inject bus busy, NACK and bus errors at configurable rates
+ *          + Simulate a bus stuck low until the platform recovers it
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _DS1307_SIM_H_
+#define _DS1307_SIM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include "DS1307.h"
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+
+/**
+ * @brief  Fault injection options
+ * @note   Rates are in 1/1000 of transfers. When a fault is injected, the
+ *         next Burst-1 transfers fail the same way (noise bursts).
+ */
+typedef struct DS1307_SimFaults_s
+{
+  uint16_t  BusyPerMille;   // transfer returns -2 (bus busy)
+  uint16_t  NackPerMille;   // transfer returns -3 (NACK)
+  uint16_t  FailPerMille;   // transfer returns -1 (bus error)
+  uint8_t   Burst;          // length of fault bursts (0 or 1: single faults)
+  uint32_t  FaultUs;        // time lost by a failed transfer (0: one byte time)
+  uint32_t  Seed;           // seed of fault generator (0: keep current state)
+} DS1307_SimFaults_t;
+
+/**
+ * @brief  Simulator statistics
+ */
+typedef struct DS1307_SimStats_s
+{
+  uint32_t  Transfers;      // transfers requested by the driver
+  uint32_t  Faults;         // transfers failed by fault injection
+  uint32_t  Bytes;          // bytes moved on the simulated bus
+  uint32_t  Recoveries;     // calls of PlatformRecover
+} DS1307_SimStats_t;
+
+
+/* Functionality Options --------------------------------------------------------*/
+#define DS1307_SIM_I2C_RATE  100000
+
+
+
+/**
+ ==================================================================================
+                             ##### Functions #####                                 
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize the simulated platform and connect it to handler.
+ * @note   Registers are set to the DS1307 power-on state (oscillator halted)
+ *         and PlatformDelay/PlatformGetTimeUs are set to the virtual clock.
+ *         The handler is reset with DS1307_Handler_Init first.
+ * @param  Handler: Pointer to handler
+ * @retval None
+ */
+void
+DS1307_Sim_Init(DS1307_Handler_t *Handler);
+
+
+/**
+ * @brief  Set fault injection options (NULL disables fault injection)
+ * @param  Faults: Pointer to options
+ * @retval None
+ */
+void
+DS1307_Sim_SetFaults(const DS1307_SimFaults_t *Faults);
+
+
+/**
+ * @brief  Hold SDA low (as after a reset in the middle of a read)
+ * @note   Every transfer returns -2 until PlatformRecover is called.
+ * @retval None
+ */
+void
+DS1307_Sim_StuckBus(void);
+
+
+/**
+ * @brief  Advance virtual time (the oscillator ticks if it is running)
+ * @param  Us: Time in microseconds
+ * @retval None
+ */
+void
+DS1307_Sim_Advance(uint32_t Us);
+
+
+/**
+ * @brief  Get virtual time
+ * @retval Virtual time in microseconds
+ */
+uint32_t
+DS1307_Sim_GetTimeUs(void);
+
+
+/**
+ * @brief  Get and reset simulator statistics
+ * @param  Stats: Pointer to statistics
+ * @retval None
+ */
+void
+DS1307_Sim_GetStats(DS1307_SimStats_t *Stats);
+
+
+/**
+ * @brief  Direct access to the 64 simulated registers (time, control, RAM)
+ * @retval Pointer to registers
+ */
+uint8_t *
+DS1307_Sim_Registers(void);
+
+
+/**
+ * @brief  Write one register like a bus write does, without bus time
+ * @note   For bus models outside the simulator (e.g. simavr TWI slave).
+ *         Writing SECOND resets the countdown chain.
+ * @param  Reg: Register address (0 to 63)
+ * @param  Value: Register value
+ * @retval None
+ */
+void
+DS1307_Sim_WriteRegister(uint8_t Reg, uint8_t Value);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif //! _DS1307_SIM_H_
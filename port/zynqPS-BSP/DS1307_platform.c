@@ -87,9 +87,28 @@ Platform_DeInit(void)
   return 0;
 }
 
+static int8_t
+Platform_Recover(void)
+{
+  /*
+   * MIO pins of PS I2C can not be clocked from here, resetting the
+   * controller aborts the transfer and releases SCL/SDA on the master side.
+   */
+  XIicPs_Reset(&Iic);
+  XIicPs_SetSClk(&Iic, IIC_SCLK_RATE);
+
+  if (XIicPs_BusIsBusy(&Iic))
+    return -1;
+
+  return 0;
+}
+
 static int8_t
 Platform_WriteData(uint8_t Address, uint8_t *Data, uint8_t DataLen)
 {
+  if (XIicPs_BusIsBusy(&Iic))
+    return -2;
+
   if (XIicPs_MasterSendPolled(&Iic, Data, DataLen, Address) != XST_SUCCESS)
     return -1;
 
@@ -99,6 +118,9 @@ Platform_WriteData(uint8_t Address, uint8_t *Data, uint8_t DataLen)
 static int8_t
 Platform_ReadData(uint8_t Address, uint8_t *Data, uint8_t DataLen)
 {
+  if (XIicPs_BusIsBusy(&Iic))
+    return -2;
+
   if (XIicPs_MasterRecvPolled(&Iic, Data, DataLen, Address) != XST_SUCCESS)
     return -1;
 
@@ -115,14 +137,19 @@ Platform_ReadData(uint8_t Address, uint8_t *Data, uint8_t DataLen)
 
 /**
  * @brief  Initialize platform device to communicate DS1307.
+ * @note   The handler is reset with DS1307_Handler_Init first, so it needs
+ *         no zero initialization. Set Address, Retry and the optional fields
+ *         this port does not provide after this call.
  * @param  Handler: Pointer to handler
  * @retval None
  */
 void
 DS1307_Platform_Init(DS1307_Handler_t *Handler)
 {
+  DS1307_Handler_Init(Handler);
   Handler->PlatformInit = Platform_Init;
   Handler->PlatformDeInit = Platform_DeInit;
   Handler->PlatformSend = Platform_WriteData;
   Handler->PlatformReceive = Platform_ReadData;
+  Handler->PlatformRecover = Platform_Recover;
 }
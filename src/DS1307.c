@@ -7,6 +7,7 @@
  *          + Get and Set date and time
  *          + Read and Write non-volatile embedded RAM of DS1307 chip
  *          + Control squarewave output signal
+ *          + Convert date and time to/from Unix time
  **********************************************************************************
  *
  * Copyright (c) 2021 Hossein.M (MIT License)
@@ -39,7 +40,7 @@
 
 /* Private Constants ------------------------------------------------------------*/
 /**
- * @brief  The DS1307 Address on I2C BUS
+ * @brief  Default DS1307 Address on I2C BUS (Handler->Address = 0)
  */ 
 #define DS1307_ADDRESS  0x68
 
@@ -59,7 +60,6 @@
  * @brief  Non-volatile RAM Address
  */ 
 #define DS1307_RAM      0x08  // the address of first byte of Non-volatile RAM
-#define DS1307_RAM_SIZE 56    // size of Non-volatile
 
 /**
  * @brief  CONTROL register bits
@@ -69,6 +69,19 @@
 #define DS1307_RS0      0
 #define DS1307_RS1      1
 
+/**
+ * @brief  Time conversion constants
+ */
+#define DS1307_UNIX_2000      946684800UL // Unix time of 2000-01-01 00:00:00
+#define DS1307_SEC_PER_DAY    86400UL
+
+
+/**
+ * @brief  Shadow valid flags
+ */
+#define DS1307_SHADOW_CONTROL 0x01  // ShadowControl holds CONTROL register
+#define DS1307_SHADOW_CH      0x02  // CH bit of ShadowSecond is valid
+
 
 /* Private Macro ----------------------------------------------------------------*/
 #ifndef MIN
@@ -102,12 +115,231 @@ DS1307_BCDtoDEC(uint8_t BCD)
   return DEC;
 }
 
+static uint8_t
+DS1307_BCDInRange(uint8_t BCD, uint8_t Min, uint8_t Max)
+{
+  if ((BCD & 0x0F) > 9 || (BCD >> 4) > 9)
+    return 0;
+
+  BCD = DS1307_BCDtoDEC(BCD);
+  return (BCD >= Min && BCD <= Max) ? 1 : 0;
+}
+
+static void
+DS1307_DecodeDateTime(const uint8_t *Buffer, DS1307_DateTime_t *DateTime)
+{
+  DateTime->Second  = DS1307_BCDtoDEC(Buffer[0] & 0x7F);
+  DateTime->Minute  = DS1307_BCDtoDEC(Buffer[1]);
+  DateTime->Hour    = DS1307_BCDtoDEC(Buffer[2]);
+  DateTime->WeekDay = DS1307_BCDtoDEC(Buffer[3]);
+  DateTime->Day     = DS1307_BCDtoDEC(Buffer[4]);
+  DateTime->Month   = DS1307_BCDtoDEC(Buffer[5]);
+  DateTime->Year    = DS1307_BCDtoDEC(Buffer[6]);
+}
+
+static uint8_t
+DS1307_EncodeDateTime(const DS1307_DateTime_t *DateTime,
+                      DS1307_RunHalt_t RunHalt, uint8_t *Buffer)
+{
+  if (DateTime->Second > 59 ||
+      DateTime->Minute > 59 ||
+      DateTime->Hour > 23 ||
+      DateTime->WeekDay > 7 || DateTime->WeekDay == 0 ||
+      DateTime->Day > 31 || DateTime->Day == 0 ||
+      DateTime->Month > 12 || DateTime->Month == 0 ||
+      DateTime->Year > 99)
+    return 0;
+
+  // convert value of parameter to BCD
+  Buffer[0] = DS1307_DECtoBCD(DateTime->Second) & 0x7F; // clear CH bit
+  if (RunHalt == DS1307_RunHalt_Halt)
+    Buffer[0] |= 0x80; // set CH bit to halt the oscillator
+  Buffer[1] = DS1307_DECtoBCD(DateTime->Minute);
+  Buffer[2] = DS1307_DECtoBCD(DateTime->Hour);
+  Buffer[3] = DS1307_DECtoBCD(DateTime->WeekDay);
+  Buffer[4] = DS1307_DECtoBCD(DateTime->Day);
+  Buffer[5] = DS1307_DECtoBCD(DateTime->Month);
+  Buffer[6] = DS1307_DECtoBCD(DateTime->Year);
+  return 1;
+}
+
+static uint8_t
+DS1307_IsLeapYear(uint8_t Year)
+{
+  return ((Year & 0x03) == 0) ? 1 : 0; // 2000 to 2099
+}
+
+static uint8_t
+DS1307_DaysInMonth(uint8_t Year, uint8_t Month)
+{
+  static const uint8_t Days[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+  if (Month == 2 && DS1307_IsLeapYear(Year))
+    return 29;
+  return Days[Month - 1];
+}
+
+static void
+DS1307_DecodeProbe(DS1307_Handler_t *Handler, const uint8_t *Buffer,
+                   DS1307_Probe_t *Probe)
+{
+  uint8_t Invalid = 0;
+
+  Handler->ShadowSecond = Buffer[0];
+  Handler->ShadowControl = Buffer[7];
+  Handler->ShadowValid |= DS1307_SHADOW_CH | DS1307_SHADOW_CONTROL;
+
+  if (!DS1307_BCDInRange(Buffer[0] & 0x7F, 0, 59))
+    Invalid |= DS1307_Field_Second;
+  if (!DS1307_BCDInRange(Buffer[1], 0, 59))
+    Invalid |= DS1307_Field_Minute;
+  if (!DS1307_BCDInRange(Buffer[2], 0, 23)) // 12-hour mode is not supported
+    Invalid |= DS1307_Field_Hour;
+  if (!DS1307_BCDInRange(Buffer[3], 1, 7))
+    Invalid |= DS1307_Field_WeekDay;
+  if (!DS1307_BCDInRange(Buffer[5], 1, 12))
+    Invalid |= DS1307_Field_Month;
+  if (!DS1307_BCDInRange(Buffer[6], 0, 99))
+    Invalid |= DS1307_Field_Year;
+  if (!DS1307_BCDInRange(Buffer[4], 1, 31) ||
+      (!(Invalid & (DS1307_Field_Month | DS1307_Field_Year)) &&
+       DS1307_BCDtoDEC(Buffer[4]) > DS1307_DaysInMonth(DS1307_BCDtoDEC(Buffer[6]),
+                                                       DS1307_BCDtoDEC(Buffer[5]))))
+    Invalid |= DS1307_Field_Day;
+
+  Probe->Present = 1;
+  Probe->Halted = (Buffer[0] & 0x80) ? 1 : 0;
+  Probe->Invalid = Invalid;
+  Probe->Control = Buffer[7];
+  memcpy(Probe->TimeRegs, Buffer, sizeof(Probe->TimeRegs));
+  Probe->ControlValid = (Buffer[7] & 0x6C) ? 0 : 1;
+
+  if (Buffer[7] & (1 << DS1307_SQWE))
+    Probe->OutWave = (DS1307_OutWave_t)(DS1307_OutWave_1Hz + (Buffer[7] & 0x03));
+  else if (Buffer[7] & (1 << DS1307_OUT))
+    Probe->OutWave = DS1307_OutWave_High;
+  else
+    Probe->OutWave = DS1307_OutWave_Low;
+
+  DS1307_DecodeDateTime(Buffer, &Probe->DateTime);
+}
+
+static uint8_t
+DS1307_EncodeOutWave(DS1307_OutWave_t OutWave, uint8_t *ControlReg)
+{
+  switch (OutWave)
+  {
+  case DS1307_OutWave_Low:
+    *ControlReg = 0;
+    break;
+
+  case DS1307_OutWave_High:
+    *ControlReg = (1 << DS1307_OUT);
+    break;
+
+  case DS1307_OutWave_1Hz:
+    *ControlReg = (1 << DS1307_SQWE);
+    break;
+
+  case DS1307_OutWave_4KHz:
+    *ControlReg = (1 << DS1307_SQWE) | (1 << DS1307_RS0);
+    break;
+
+  case DS1307_OutWave_8KHz:
+    *ControlReg = (1 << DS1307_SQWE) | (1 << DS1307_RS1);
+    break;
+
+  case DS1307_OutWave_32KHz:
+    *ControlReg = (1 << DS1307_SQWE) | (3 << DS1307_RS0);
+    break;
+
+  default:
+    return 0;
+  }
+
+  return 1;
+}
+
+static DS1307_Result_t
+DS1307_BusResult(int8_t Err)
+{
+  switch (Err)
+  {
+  case -2:
+    return DS1307_BUS_BUSY;
+
+  case -3:
+    return DS1307_NACK;
+
+  default:
+    return DS1307_FAIL;
+  }
+}
+
+static uint32_t
+DS1307_TimeUs(DS1307_Handler_t *Handler)
+{
+  return Handler->PlatformGetTimeUs ? Handler->PlatformGetTimeUs() : 0;
+}
+
+static uint8_t
+DS1307_RetryWait(DS1307_Handler_t *Handler, uint8_t Attempt, uint32_t Start)
+{
+  const DS1307_Retry_t *Retry = &Handler->Retry;
+  uint32_t Delay = Retry->BackoffUs;
+
+  if (Attempt >= Retry->MaxRetries)
+    return 0;
+
+  // exponential backoff, Attempt is bounded to keep the shift defined
+  Delay <<= MIN(Attempt, 15);
+  if (Retry->BackoffMaxUs && Delay > Retry->BackoffMaxUs)
+    Delay = Retry->BackoffMaxUs;
+
+  if (Retry->DeadlineUs && Handler->PlatformGetTimeUs &&
+      (uint32_t)(Handler->PlatformGetTimeUs() - Start) + Delay >= Retry->DeadlineUs)
+    return 0;
+
+  if (Delay && Handler->PlatformDelay)
+    Handler->PlatformDelay(Delay);
+
+  return 1;
+}
+
+static void
+DS1307_TransferFailed(DS1307_Handler_t *Handler)
+{
+#if DS1307_RECOVER_AFTER
+  if (++Handler->FailCount < DS1307_RECOVER_AFTER)
+    return;
+
+  Handler->FailCount = 0;
+  if (Handler->PlatformRecover)
+  {
+    Handler->ShadowValid = 0;
+    Handler->PlatformRecover();
+  }
+#else
+  (void)Handler;
+#endif
+}
+
+static int8_t
+DS1307_Select(DS1307_Handler_t *Handler)
+{
+  return Handler->PlatformSelect ?
+         Handler->PlatformSelect(Handler->PlatformContext) : 0;
+}
+
 static int8_t
 DS1307_WriteRegs(DS1307_Handler_t *Handler,
                  uint8_t StartReg, uint8_t *Data, uint8_t BytesCount)
 {
   uint8_t Buffer[DS1307_SEND_BUFFER_SIZE];
   uint8_t Len = 0;
+  uint8_t Attempt = 0;
+  uint32_t Start = DS1307_TimeUs(Handler);
+  int8_t Err = 0;
 
   Buffer[0] = StartReg; // send register address to set RTC pointer
   while (BytesCount)
@@ -115,14 +347,20 @@ DS1307_WriteRegs(DS1307_Handler_t *Handler,
     Len = MIN(BytesCount, sizeof(Buffer)-1);
     memcpy((void*)(Buffer+1), (const void*)Data, Len);
 
-    if (Handler->PlatformSend(DS1307_ADDRESS, Buffer, Len+1) < 0)
-      return -1;
+    while ((Err = DS1307_Select(Handler)) < 0 ||
+           (Err = Handler->PlatformSend(Handler->Address, Buffer, Len+1)) < 0)
+    {
+      DS1307_TransferFailed(Handler);
+      if (!DS1307_RetryWait(Handler, Attempt++, Start))
+        return Err;
+    }
 
     Data += Len;
     Buffer[0] += Len;
     BytesCount -= Len;
   }
 
+  Handler->FailCount = 0;
   return 0;
 }
 
@@ -130,13 +368,66 @@ static int8_t
 DS1307_ReadRegs(DS1307_Handler_t *Handler,
                 uint8_t StartReg, uint8_t *Data, uint8_t BytesCount)
 {
-  if (Handler->PlatformSend(DS1307_ADDRESS, &StartReg, 1) < 0)
-    return -1;
+  uint8_t Attempt = 0;
+  uint32_t Start = DS1307_TimeUs(Handler);
+  int8_t Err = 0;
 
-  if (Handler->PlatformReceive(DS1307_ADDRESS, Data, BytesCount) < 0)
-    return -1;
+  for (;;)
+  {
+    Err = DS1307_Select(Handler);
+    if (Err >= 0 && Handler->PlatformWriteRead)
+      Err = Handler->PlatformWriteRead(Handler->Address, &StartReg, 1, Data, BytesCount);
+    else
+    {
+      if (Err >= 0)
+        Err = Handler->PlatformSend(Handler->Address, &StartReg, 1);
+      if (Err >= 0)
+        Err = Handler->PlatformReceive(Handler->Address, Data, BytesCount);
+    }
+    if (Err >= 0)
+    {
+      Handler->FailCount = 0;
+      return 0;
+    }
+
+    DS1307_TransferFailed(Handler);
+    if (!DS1307_RetryWait(Handler, Attempt++, Start))
+      return Err;
+  }
+}
 
-  return 0;
+
+
+static DS1307_Result_t
+DS1307_WaitEdge(DS1307_Handler_t *Handler, uint16_t MaxPolls, uint32_t TimeoutUs)
+{
+  uint32_t Start = 0;
+  uint8_t First = 0;
+  uint8_t Second = 0;
+  int8_t Err = 0;
+
+  if ((Err = DS1307_ReadRegs(Handler, DS1307_SECOND, &First, 1)) < 0)
+    return DS1307_BusResult(Err);
+
+  if (First & 0x80)
+    return DS1307_FAIL; // oscillator is halted, no edge will come
+
+  if (TimeoutUs)
+    Start = Handler->PlatformGetTimeUs();
+
+  do
+  {
+    if ((Err = DS1307_ReadRegs(Handler, DS1307_SECOND, &Second, 1)) < 0)
+      return DS1307_BusResult(Err);
+
+    if (Second != First)
+      return DS1307_OK;
+
+    if (TimeoutUs && Handler->PlatformGetTimeUs() - Start >= TimeoutUs)
+      return DS1307_FAIL;
+  } while (!MaxPolls || --MaxPolls);
+
+  return DS1307_FAIL;
 }
 
 
@@ -147,6 +438,24 @@ DS1307_ReadRegs(DS1307_Handler_t *Handler,
  ==================================================================================
  */
 
+/**
+ * @brief  Reset all fields of handler to their defaults
+ * @note   Platform functions become NULL, Address 0 (DS1307_ADDRESS), no hot
+ *         RAM range, no retries and no register shadow. Use it instead of
+ *         zero initialization, then set the platform functions and options.
+ *         DS1307_Platform_Init of the ports calls it.
+ * @param  Handler: Pointer to handler
+ * @retval None
+ */
+void
+DS1307_Handler_Init(DS1307_Handler_t *Handler)
+{
+  static const DS1307_Handler_t Defaults = {0};
+
+  *Handler = Defaults;
+}
+
+
 /**
  * @brief  Initialize DS1307 
  * @param  Handler: Pointer to handler
@@ -162,6 +471,11 @@ DS1307_Init(DS1307_Handler_t *Handler)
       !Handler->PlatformReceive)
     return DS1307_INVALID_PARAM;
 
+  if (!Handler->Address)
+    Handler->Address = DS1307_ADDRESS;
+  Handler->ShadowValid = 0;
+  Handler->FailCount = 0;
+
   if (Handler->PlatformInit)
     if (Handler->PlatformInit() < 0)
       return DS1307_FAIL;
@@ -169,6 +483,62 @@ DS1307_Init(DS1307_Handler_t *Handler)
   return DS1307_OK;
 }
 
+/**
+ * @brief  Initialize DS1307 and probe its state in one transaction
+ * @note   Same as DS1307_Init followed by DS1307_Probe. Applications can check
+ *         Probe->Halted and Probe->Invalid instead of separate reads to find
+ *         out whether the clock lost power.
+ * @param  Handler: Pointer to handler
+ * @param  Probe: Pointer to probe result
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer (not present).
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_InitProbe(DS1307_Handler_t *Handler, DS1307_Probe_t *Probe)
+{
+  DS1307_Result_t Result = DS1307_Init(Handler);
+
+  if (Result != DS1307_OK)
+    return Result;
+
+  return DS1307_Probe(Handler, Probe);
+}
+
+/**
+ * @brief  Read the whole state of DS1307 in one transaction
+ * @note   Registers 0x00 to 0x07 are read in one 8-byte burst. The CONTROL
+ *         and CH shadows of handler are seeded from the result.
+ * @param  Handler: Pointer to handler
+ * @param  Probe: Pointer to probe result
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer (not present).
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_Probe(DS1307_Handler_t *Handler, DS1307_Probe_t *Probe)
+{
+  uint8_t Buffer[8] = {0};
+  int8_t Err = 0;
+
+  if (!Probe)
+    return DS1307_INVALID_PARAM;
+
+  Probe->Present = 0;
+  if ((Err = DS1307_ReadRegs(Handler, DS1307_SECOND, Buffer, 8)) < 0)
+    return DS1307_BusResult(Err);
+
+  DS1307_DecodeProbe(Handler, Buffer, Probe);
+
+  return DS1307_OK;
+}
+
 /**
  * @brief  Uninitialize DS1307 
  * @param  Handler: Pointer to handler
@@ -186,6 +556,44 @@ DS1307_DeInit(DS1307_Handler_t *Handler)
   return DS1307_OK;
 }
 
+/**
+ * @brief  Release a stuck bus (e.g. SDA held low by DS1307 after a reset in
+ *         the middle of a transfer) using PlatformRecover
+ * @param  Handler: Pointer to handler
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to release the bus.
+ *         - DS1307_INVALID_PARAM: Platform has no recovery function.
+ */
+DS1307_Result_t
+DS1307_RecoverBus(DS1307_Handler_t *Handler)
+{
+  if (!Handler->PlatformRecover)
+    return DS1307_INVALID_PARAM;
+
+  Handler->FailCount = 0;
+  Handler->ShadowValid = 0;
+  if (Handler->PlatformRecover() < 0)
+    return DS1307_FAIL;
+
+  return DS1307_OK;
+}
+
+
+/**
+ * @brief  Forget the register shadow of the handler
+ * @note   The next set functions write their registers unconditionally and
+ *         refresh the shadow. Needed with DS1307_WRITE_ELISION when the chip
+ *         may have been written through another path.
+ * @param  Handler: Pointer to handler
+ * @retval None
+ */
+void
+DS1307_InvalidateCache(DS1307_Handler_t *Handler)
+{
+  Handler->ShadowValid = 0;
+}
+
 
 
 /**
@@ -197,6 +605,7 @@ DS1307_DeInit(DS1307_Handler_t *Handler)
 /**
  * @brief  Set date and time on DS1307 real time chip and Run/Halt option of
  *         oscillator
+ * @note   Time registers are written as described for DS1307_SetDateTime.
  * 
  * @param  Handler: Pointer to handler
  * @param  DateTime: Pointer to date and time value structure. If NULL, the 
@@ -205,6 +614,8 @@ DS1307_DeInit(DS1307_Handler_t *Handler)
  * @retval DS1307_Result_t
  *         - DS1307_OK: Operation was successful.
  *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
  *         - DS1307_INVALID_PARAM: One of parameters is invalid.
  */
 DS1307_Result_t
@@ -212,46 +623,76 @@ DS1307_SetDateTimeRunHalt(DS1307_Handler_t *Handler, DS1307_DateTime_t *DateTime
                           DS1307_RunHalt_t RunHalt)
 {
   uint8_t Buffer[7] = {0};
+  int8_t Err = 0;
+#if DS1307_TIME_ELISION
+  uint8_t Current[7] = {0};
+  uint8_t First = 0;
+  uint8_t Last = 6;
+#endif
 
   if (DateTime)
   {
-    if (DateTime->Second > 59 ||
-        DateTime->Minute > 59 ||
-        DateTime->Hour > 23 ||
-        DateTime->WeekDay > 7 || DateTime->WeekDay == 0 ||
-        DateTime->Day > 31 || DateTime->Day == 0 ||
-        DateTime->Month > 12 || DateTime->Month == 0 ||
-        DateTime->Year > 99)
+    if (!DS1307_EncodeDateTime(DateTime, RunHalt, Buffer))
       return DS1307_INVALID_PARAM;
 
-    // convert value of parameter to BCD
-    Buffer[0] = DS1307_DECtoBCD(DateTime->Second) & 0x7F; // clear CH bit
-    if (RunHalt == DS1307_RunHalt_Halt)
-      Buffer[0] |= 0x80; // set CH bit to halt the oscillator
-    Buffer[1] = DS1307_DECtoBCD(DateTime->Minute);
-    Buffer[2] = DS1307_DECtoBCD(DateTime->Hour);
-    Buffer[3] = DS1307_DECtoBCD(DateTime->WeekDay);
-    Buffer[4] = DS1307_DECtoBCD(DateTime->Day);
-    Buffer[5] = DS1307_DECtoBCD(DateTime->Month);
-    Buffer[6] = DS1307_DECtoBCD(DateTime->Year);
-
-    if (DS1307_WriteRegs(Handler, DS1307_SECOND, Buffer, 7) < 0)
-      return DS1307_FAIL;
+#if DS1307_TIME_ELISION
+    if ((Err = DS1307_ReadRegs(Handler, DS1307_SECOND, Current, 7)) < 0)
+      return DS1307_BusResult(Err);
+
+    // a carry out of SECOND may hit registers that are not rewritten
+    if ((Current[0] & 0x7F) != 0x59)
+    {
+      while (First < 7 && Buffer[First] == Current[First])
+        First++;
+      if (First == 7)
+      {
+        Handler->ShadowSecond = Buffer[0];
+        Handler->ShadowValid |= DS1307_SHADOW_CH;
+        return DS1307_OK; // chip already holds this date and time
+      }
+      while (Buffer[Last] == Current[Last])
+        Last--;
+    }
+
+    if ((Err = DS1307_WriteRegs(Handler, DS1307_SECOND + First,
+                                &Buffer[First], Last - First + 1)) < 0)
+    {
+      Handler->ShadowValid &= ~DS1307_SHADOW_CH;
+      return DS1307_BusResult(Err);
+    }
+#else
+    if ((Err = DS1307_WriteRegs(Handler, DS1307_SECOND, Buffer, 7)) < 0)
+    {
+      Handler->ShadowValid &= ~DS1307_SHADOW_CH;
+      return DS1307_BusResult(Err);
+    }
+#endif
   }
   else
   {
-    if (DS1307_ReadRegs(Handler, DS1307_SECOND, Buffer, 1) < 0)
-      return DS1307_FAIL;
+#if DS1307_WRITE_ELISION
+    if ((Handler->ShadowValid & DS1307_SHADOW_CH) &&
+        ((Handler->ShadowSecond & 0x80) ? DS1307_RunHalt_Halt : DS1307_RunHalt_Run) == RunHalt)
+      return DS1307_OK; // CH bit already has the requested value
+#endif
+
+    if ((Err = DS1307_ReadRegs(Handler, DS1307_SECOND, Buffer, 1)) < 0)
+      return DS1307_BusResult(Err);
     
     if (RunHalt == DS1307_RunHalt_Halt)
       Buffer[0] |= 0x80; // set CH bit to halt the oscillator
     else
       Buffer[0] &= 0x7F; // clear CH bit
 
-    if (DS1307_WriteRegs(Handler, DS1307_SECOND, Buffer, 1) < 0)
-      return DS1307_FAIL;
+    if ((Err = DS1307_WriteRegs(Handler, DS1307_SECOND, Buffer, 1)) < 0)
+    {
+      Handler->ShadowValid &= ~DS1307_SHADOW_CH;
+      return DS1307_BusResult(Err);
+    }
   }
-  
+
+  Handler->ShadowSecond = Buffer[0];
+  Handler->ShadowValid |= DS1307_SHADOW_CH;
   return DS1307_OK;
 }
 
@@ -259,11 +700,19 @@ DS1307_SetDateTimeRunHalt(DS1307_Handler_t *Handler, DS1307_DateTime_t *DateTime
 /**
  * @brief  Set date and time on DS1307 real time chip
  * @note   This function sets the oscillator to run state.
+ * @note   With DS1307_TIME_ELISION 0 (default) all time registers are written
+ *         in one transfer. Writing SECOND restarts the countdown chain, so
+ *         the next seconds transition comes 1 s after this call. With
+ *         DS1307_TIME_ELISION 1 only the registers that differ from the chip
+ *         are written and the chain is restarted only if SECOND changes; use
+ *         DS1307_SetDateTimeAligned when the restart is needed.
  * @param  Handler: Pointer to handler
  * @param  DateTime: Pointer to date and time value structure
  * @retval DS1307_Result_t
  *         - DS1307_OK: Operation was successful.
  *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
  *         - DS1307_INVALID_PARAM: One of parameters is invalid.
  */
 DS1307_Result_t
@@ -275,6 +724,43 @@ DS1307_SetDateTime(DS1307_Handler_t *Handler, DS1307_DateTime_t *DateTime)
 }
 
 
+/**
+ * @brief  Write date and time in a single transfer, even if unchanged
+ * @note   Writing SECOND restarts the countdown chain, so the next seconds
+ *         transition comes 1 s after this transfer. Call it at a whole second
+ *         of the reference clock to align the DS1307 with it. The oscillator
+ *         is set to run state. Same as DS1307_SetDateTime when
+ *         DS1307_TIME_ELISION is 0.
+ * @param  Handler: Pointer to handler
+ * @param  DateTime: Pointer to date and time value structure
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_SetDateTimeAligned(DS1307_Handler_t *Handler, DS1307_DateTime_t *DateTime)
+{
+  uint8_t Buffer[7] = {0};
+  int8_t Err = 0;
+
+  if (!DateTime || !DS1307_EncodeDateTime(DateTime, DS1307_RunHalt_Run, Buffer))
+    return DS1307_INVALID_PARAM;
+
+  if ((Err = DS1307_WriteRegs(Handler, DS1307_SECOND, Buffer, 7)) < 0)
+  {
+    Handler->ShadowValid &= ~DS1307_SHADOW_CH;
+    return DS1307_BusResult(Err);
+  }
+
+  Handler->ShadowSecond = Buffer[0];
+  Handler->ShadowValid |= DS1307_SHADOW_CH;
+  return DS1307_OK;
+}
+
+
 /**
  * @brief  Get date and time from DS1307 real time chip
  * @param  Handler: Pointer to handler
@@ -282,23 +768,74 @@ DS1307_SetDateTime(DS1307_Handler_t *Handler, DS1307_DateTime_t *DateTime)
  * @retval DS1307_Result_t
  *         - DS1307_OK: Operation was successful.
  *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
  */
 DS1307_Result_t
 DS1307_GetDateTime(DS1307_Handler_t *Handler, DS1307_DateTime_t *DateTime)
+{
+  return DS1307_GetFields(Handler, DS1307_Field_All, DateTime);
+}
+
+
+/**
+ * @brief  Get some fields of date and time from DS1307 real time chip
+ * @note   Only the contiguous register window that covers the requested fields
+ *         is read (e.g. 1 byte for DS1307_Field_Second) and only requested
+ *         fields are decoded. Other fields of DateTime are left untouched.
+ * @param  Handler: Pointer to handler
+ * @param  Fields: Bitwise OR of DS1307_Field_t values
+ * @param  DateTime: pointer to date and time value structure
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_GetFields(DS1307_Handler_t *Handler, uint8_t Fields,
+                 DS1307_DateTime_t *DateTime)
 {
   uint8_t Buffer[7] = {0};
+  uint8_t First = 0;
+  uint8_t Last = 6;
+  int8_t Err = 0;
 
-  if (DS1307_ReadRegs(Handler, DS1307_SECOND, Buffer, 7) < 0)
-    return DS1307_FAIL;
+  Fields &= DS1307_Field_All;
+  if (!Fields || !DateTime)
+    return DS1307_INVALID_PARAM;
+
+  while (!(Fields & (1 << First)))
+    First++;
+  while (!(Fields & (1 << Last)))
+    Last--;
+
+  if ((Err = DS1307_ReadRegs(Handler, DS1307_SECOND + First,
+                             &Buffer[First], Last - First + 1)) < 0)
+    return DS1307_BusResult(Err);
+
+  if (Fields & DS1307_Field_Second)
+  {
+    Handler->ShadowSecond = Buffer[0];
+    Handler->ShadowValid |= DS1307_SHADOW_CH;
+  }
 
   // convert BCD value to decimal
-  DateTime->Second  = DS1307_BCDtoDEC(Buffer[0] & 0x7F);
-  DateTime->Minute  = DS1307_BCDtoDEC(Buffer[1]);
-  DateTime->Hour    = DS1307_BCDtoDEC(Buffer[2]);
-  DateTime->WeekDay = DS1307_BCDtoDEC(Buffer[3]);
-  DateTime->Day     = DS1307_BCDtoDEC(Buffer[4]);
-  DateTime->Month   = DS1307_BCDtoDEC(Buffer[5]);
-  DateTime->Year    = DS1307_BCDtoDEC(Buffer[6]);
+  if (Fields & DS1307_Field_Second)
+    DateTime->Second  = DS1307_BCDtoDEC(Buffer[0] & 0x7F);
+  if (Fields & DS1307_Field_Minute)
+    DateTime->Minute  = DS1307_BCDtoDEC(Buffer[1]);
+  if (Fields & DS1307_Field_Hour)
+    DateTime->Hour    = DS1307_BCDtoDEC(Buffer[2]);
+  if (Fields & DS1307_Field_WeekDay)
+    DateTime->WeekDay = DS1307_BCDtoDEC(Buffer[3]);
+  if (Fields & DS1307_Field_Day)
+    DateTime->Day     = DS1307_BCDtoDEC(Buffer[4]);
+  if (Fields & DS1307_Field_Month)
+    DateTime->Month   = DS1307_BCDtoDEC(Buffer[5]);
+  if (Fields & DS1307_Field_Year)
+    DateTime->Year    = DS1307_BCDtoDEC(Buffer[6]);
 
   return DS1307_OK;
 }
@@ -311,25 +848,177 @@ DS1307_GetDateTime(DS1307_Handler_t *Handler, DS1307_DateTime_t *DateTime)
  * @retval DS1307_Result_t
  *         - DS1307_OK: Operation was successful.
  *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
  *         - DS1307_INVALID_PARAM: One of parameters is invalid.
  */
 DS1307_Result_t
 DS1307_GetRunHalt(DS1307_Handler_t *Handler, DS1307_RunHalt_t *RunHalt)
 {
   uint8_t Buffer[1] = {0};
+  int8_t Err = 0;
 
   if (!RunHalt)
     return DS1307_INVALID_PARAM;
   
-  if (DS1307_ReadRegs(Handler, DS1307_SECOND, Buffer, 1) < 0)
-    return DS1307_FAIL;
-  
+  if ((Err = DS1307_ReadRegs(Handler, DS1307_SECOND, Buffer, 1)) < 0)
+    return DS1307_BusResult(Err);
+
+  Handler->ShadowSecond = Buffer[0];
+  Handler->ShadowValid |= DS1307_SHADOW_CH;
   *RunHalt = (Buffer[0] & 0x80) ? DS1307_RunHalt_Halt : DS1307_RunHalt_Run;
   return DS1307_OK;
 }
 
 
 
+/**
+ * @brief  Wait for the next seconds transition of DS1307
+ * @note   Only the SECOND register is polled (1 byte per poll), so this function
+ *         returns as soon as possible after the transition.
+ * @param  Handler: Pointer to handler
+ * @param  MaxPolls: Maximum number of polls before giving up (0 = no limit)
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data, the oscillator is
+ *                        halted or no transition was seen in MaxPolls polls.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
+ */
+DS1307_Result_t
+DS1307_WaitSecondEdge(DS1307_Handler_t *Handler, uint16_t MaxPolls)
+{
+  return DS1307_WaitEdge(Handler, MaxPolls, 0);
+}
+
+
+/**
+ * @brief  Wait for the next seconds transition of DS1307 with a time limit
+ * @note   Same as DS1307_WaitSecondEdge, but the limit does not depend on the
+ *         bus speed. PlatformGetTimeUs is required.
+ * @param  Handler: Pointer to handler
+ * @param  TimeoutUs: Time limit in microseconds (more than 1 s to see an edge
+ *                    in all cases)
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data, the oscillator is
+ *                        halted or no transition was seen in TimeoutUs.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
+ *         - DS1307_INVALID_PARAM: PlatformGetTimeUs is not set or TimeoutUs
+ *                                 is 0.
+ */
+DS1307_Result_t
+DS1307_WaitSecondEdgeUs(DS1307_Handler_t *Handler, uint32_t TimeoutUs)
+{
+  if (!Handler->PlatformGetTimeUs || !TimeoutUs)
+    return DS1307_INVALID_PARAM;
+
+  return DS1307_WaitEdge(Handler, 0, TimeoutUs);
+}
+
+
+/**
+ * @brief  Find the next seconds transition and timestamp it
+ * @note   SECOND is polled with 1-byte reads (a single repeated START transfer
+ *         when PlatformWriteRead is set). The transition lies between the
+ *         start of the last read that saw the old second and the end of the
+ *         first read that saw the new one; Edge->TimeUs is the middle of this
+ *         window. With PollUs != 0 the coarse edge found at that cadence is
+ *         refined one second later by back-to-back reads started
+ *         DS1307_EDGE_GUARD_US before the predicted transition.
+ * @param  Handler: Pointer to handler (PlatformGetTimeUs is required,
+ *                  PlatformDelay too if PollUs != 0)
+ * @param  PollUs: Delay between reads of the coarse search (0 = back-to-back)
+ * @param  MaxReads: Maximum number of reads before giving up (0 = no limit)
+ * @param  Edge: Pointer to result
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data, the oscillator is
+ *                        halted or no transition was seen in MaxReads reads.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_FindSecondEdge(DS1307_Handler_t *Handler, uint32_t PollUs,
+                      uint16_t MaxReads, DS1307_SecondEdge_t *Edge)
+{
+  uint8_t Buffer[7];
+  uint8_t First = 0;
+  uint8_t Second = 0;
+  uint8_t Fine = 0;
+  uint32_t Before = 0;
+  uint32_t After = 0;
+  uint32_t LastBefore = 0;
+  uint32_t Wait = 0;
+  int8_t Err = 0;
+
+  if (!Edge || !Handler->PlatformGetTimeUs || (PollUs && !Handler->PlatformDelay))
+    return DS1307_INVALID_PARAM;
+
+  Edge->Reads = 1;
+  LastBefore = Handler->PlatformGetTimeUs();
+  if ((Err = DS1307_ReadRegs(Handler, DS1307_SECOND, &First, 1)) < 0)
+    return DS1307_BusResult(Err);
+
+  if (First & 0x80)
+    return DS1307_FAIL; // oscillator is halted, no edge will come
+
+  for (;;)
+  {
+    if (MaxReads && Edge->Reads >= MaxReads)
+      return DS1307_FAIL;
+
+    if (PollUs && !Fine)
+      Handler->PlatformDelay(PollUs);
+
+    Edge->Reads++;
+    Before = Handler->PlatformGetTimeUs();
+    if ((Err = DS1307_ReadRegs(Handler, DS1307_SECOND, &Second, 1)) < 0)
+      return DS1307_BusResult(Err);
+    After = Handler->PlatformGetTimeUs();
+
+    if (Second == First)
+    {
+      LastBefore = Before;
+      continue;
+    }
+
+    if (!PollUs || Fine)
+      break;
+
+    // coarse edge is in [LastBefore, After], wake up just before the next one
+    Fine = 1;
+    First = Second;
+    Wait = LastBefore + 1000000UL - DS1307_EDGE_GUARD_US - After;
+    if (Wait < 1000000UL)
+      Handler->PlatformDelay(Wait);
+    Edge->Reads++;
+    LastBefore = Handler->PlatformGetTimeUs();
+    if ((Err = DS1307_ReadRegs(Handler, DS1307_SECOND, &First, 1)) < 0)
+      return DS1307_BusResult(Err);
+    if (First != Second)
+      Fine = 0; // woke up too late, search the next edge coarsely again
+  }
+
+  Edge->WindowUs = After - LastBefore;
+  Edge->TimeUs = LastBefore + Edge->WindowUs / 2;
+
+  // the other registers belong to the new second for almost 1 s
+  Edge->Reads++;
+  if ((Err = DS1307_ReadRegs(Handler, DS1307_SECOND, Buffer, 7)) < 0)
+    return DS1307_BusResult(Err);
+
+  if (Buffer[0] != Second)
+    return DS1307_FAIL;
+
+  DS1307_DecodeDateTime(Buffer, &Edge->DateTime);
+  return DS1307_OK;
+}
+
+
+
 /**
  ==================================================================================
                        ##### Public Memory Functions #####                         
@@ -341,23 +1030,30 @@ DS1307_GetRunHalt(DS1307_Handler_t *Handler, DS1307_RunHalt_t *RunHalt)
  * @param  Handler: Pointer to handler
  * @param  Address: address of block beginning (0 to 55)
  * @param  Data: pointer to data array
- * @param  Size: data size (1 to 56)
+ * @param  Size: data size (0 to 56, 0 does nothing)
  * @retval DS1307_Result_t
  *         - DS1307_OK: Operation was successful.
  *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
  *         - DS1307_INVALID_PARAM: Requested area is out of range.
  */
 DS1307_Result_t
 DS1307_WriteRAM(DS1307_Handler_t *Handler,
                 uint8_t Address, uint8_t *Data, uint8_t Size)
 {
-  Address += 8;
+  int8_t Err = 0;
+
+  if (!Size)
+    return DS1307_OK;
 
-  if ((Address + Size) > 0x3f)
+  if ((Address + Size) > DS1307_RAM_SIZE)
     return DS1307_INVALID_PARAM;
 
-  if (DS1307_WriteRegs(Handler, Address, Data, Size) < 0)
-    return DS1307_FAIL;
+  Address += DS1307_RAM;
+
+  if ((Err = DS1307_WriteRegs(Handler, Address, Data, Size)) < 0)
+    return DS1307_BusResult(Err);
 
   return DS1307_OK;
 }
@@ -368,28 +1064,182 @@ DS1307_WriteRAM(DS1307_Handler_t *Handler,
  * @param  Handler: Pointer to handler
  * @param  Address: address of block beginning (0 to 55)
  * @param  Data: pointer to data array
- * @param  Size: data size (1 to 56)
+ * @param  Size: data size (0 to 56, 0 does nothing)
  * @retval DS1307_Result_t
  *         - DS1307_OK: Operation was successful.
  *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
  *         - DS1307_INVALID_PARAM: Requested area is out of range.
  */
 DS1307_Result_t
 DS1307_ReadRAM(DS1307_Handler_t *Handler,
                uint8_t Address, uint8_t *Data, uint8_t Size)
 {
-  Address += 8;
+  int8_t Err = 0;
+
+  if (!Size)
+    return DS1307_OK;
 
-  if ((Address + Size) > 0x3f)
+  if ((Address + Size) > DS1307_RAM_SIZE)
     return DS1307_INVALID_PARAM;
 
-  if (DS1307_ReadRegs(Handler, Address, Data, Size) < 0)
-    return DS1307_FAIL;
+  Address += DS1307_RAM;
+
+  if ((Err = DS1307_ReadRegs(Handler, Address, Data, Size)) < 0)
+    return DS1307_BusResult(Err);
+
+  return DS1307_OK;
+}
+
+
+/**
+ * @brief  Set the hot Non-volatile RAM range of handler
+ * @note   The hot range is fetched in the same burst as date and time by
+ *         DS1307_GetDateTimeAndRAM. The burst also carries CONTROL and the
+ *         RAM bytes before Address, so hot ranges near 0 are cheapest.
+ * @param  Handler: Pointer to handler
+ * @param  Address: address of range beginning (0 to 55)
+ * @param  Size: range size (0 to 56, 0 disables the hot range)
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_INVALID_PARAM: Requested area is out of range.
+ */
+DS1307_Result_t
+DS1307_SetHotRAM(DS1307_Handler_t *Handler, uint8_t Address, uint8_t Size)
+{
+  if ((Address + Size) > DS1307_RAM_SIZE)
+    return DS1307_INVALID_PARAM;
+
+  Handler->HotAddress = Address;
+  Handler->HotSize = Size;
+  return DS1307_OK;
+}
+
+
+/**
+ * @brief  Get date and time and the hot Non-volatile RAM range in one transaction
+ * @param  Handler: Pointer to handler
+ * @param  DateTime: pointer to date and time value structure
+ * @param  Data: pointer to data array of HotSize bytes (may be NULL if HotSize is 0)
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid or the hot
+ *                                 range of handler is out of RAM.
+ */
+DS1307_Result_t
+DS1307_GetDateTimeAndRAM(DS1307_Handler_t *Handler,
+                         DS1307_DateTime_t *DateTime, uint8_t *Data)
+{
+  uint8_t Buffer[DS1307_RAM + DS1307_RAM_SIZE];
+  uint8_t Len = DS1307_RAM;
+  int8_t Err = 0;
+
+  if (!DateTime || (Handler->HotSize && !Data))
+    return DS1307_INVALID_PARAM;
+
+  // the range may have been set without DS1307_SetHotRAM
+  if (Handler->HotSize && (Handler->HotAddress + Handler->HotSize) > DS1307_RAM_SIZE)
+    return DS1307_INVALID_PARAM;
+
+  // the register file is contiguous: time, CONTROL, then RAM
+  if (Handler->HotSize)
+    Len += Handler->HotAddress + Handler->HotSize;
+
+  if ((Err = DS1307_ReadRegs(Handler, DS1307_SECOND, Buffer, Len)) < 0)
+    return DS1307_BusResult(Err);
+
+  Handler->ShadowSecond = Buffer[0];
+  Handler->ShadowControl = Buffer[DS1307_CONTROL];
+  Handler->ShadowValid |= DS1307_SHADOW_CH | DS1307_SHADOW_CONTROL;
+
+  DS1307_DecodeDateTime(Buffer, DateTime);
+  if (Handler->HotSize)
+    memcpy(Data, &Buffer[DS1307_RAM + Handler->HotAddress], Handler->HotSize);
 
   return DS1307_OK;
 }
 
 
+/**
+ * @brief  Write date and time, output wave and the whole Non-volatile RAM
+ *         (the 64-byte register image) in a single burst
+ * @note   One transfer needs DS1307_SEND_BUFFER_SIZE >= 65, smaller buffers
+ *         split the image. The oscillator is set to run state and the
+ *         countdown chain restarts as with DS1307_SetDateTimeAligned.
+ * @param  Handler: Pointer to handler
+ * @param  DateTime: Pointer to date and time value structure
+ * @param  OutWave: Output wave state
+ * @param  Ram: Pointer to the 56 bytes of Non-volatile RAM
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_WriteImage(DS1307_Handler_t *Handler, DS1307_DateTime_t *DateTime,
+                  DS1307_OutWave_t OutWave, const uint8_t *Ram)
+{
+  uint8_t Image[DS1307_RAM + DS1307_RAM_SIZE];
+  int8_t Err = 0;
+
+  if (!DateTime || !Ram ||
+      !DS1307_EncodeDateTime(DateTime, DS1307_RunHalt_Run, Image) ||
+      !DS1307_EncodeOutWave(OutWave, &Image[DS1307_CONTROL]))
+    return DS1307_INVALID_PARAM;
+
+  memcpy(&Image[DS1307_RAM], Ram, DS1307_RAM_SIZE);
+
+  if ((Err = DS1307_WriteRegs(Handler, DS1307_SECOND, Image, sizeof(Image))) < 0)
+  {
+    Handler->ShadowValid = 0;
+    return DS1307_BusResult(Err);
+  }
+
+  Handler->ShadowSecond = Image[DS1307_SECOND];
+  Handler->ShadowControl = Image[DS1307_CONTROL];
+  Handler->ShadowValid |= DS1307_SHADOW_CH | DS1307_SHADOW_CONTROL;
+  return DS1307_OK;
+}
+
+
+/**
+ * @brief  Read the 64-byte register image in a single burst
+ * @note   Date, time and CONTROL are decoded as by DS1307_Probe.
+ * @param  Handler: Pointer to handler
+ * @param  Probe: Pointer to decoded date, time and CONTROL
+ * @param  Ram: Pointer to the 56 bytes of Non-volatile RAM
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_ReadImage(DS1307_Handler_t *Handler, DS1307_Probe_t *Probe, uint8_t *Ram)
+{
+  uint8_t Image[DS1307_RAM + DS1307_RAM_SIZE];
+  int8_t Err = 0;
+
+  if (!Probe || !Ram)
+    return DS1307_INVALID_PARAM;
+
+  Probe->Present = 0;
+  if ((Err = DS1307_ReadRegs(Handler, DS1307_SECOND, Image, sizeof(Image))) < 0)
+    return DS1307_BusResult(Err);
+
+  DS1307_DecodeProbe(Handler, Image, Probe);
+  memcpy(Ram, &Image[DS1307_RAM], DS1307_RAM_SIZE);
+  return DS1307_OK;
+}
+
+
 
 /**
  ==================================================================================
@@ -411,45 +1261,133 @@ DS1307_ReadRAM(DS1307_Handler_t *Handler,
  * @retval DS1307_Result_t
  *         - DS1307_OK: Operation was successful.
  *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
  *         - DS1307_INVALID_PARAM: One of parameters is invalid.
  */
 DS1307_Result_t
 DS1307_SetOutWave(DS1307_Handler_t *Handler, DS1307_OutWave_t OutWave)
 {
   uint8_t ControlReg;
+  int8_t Err = 0;
 
-  switch (OutWave)
+  if (!DS1307_EncodeOutWave(OutWave, &ControlReg))
+    return DS1307_INVALID_PARAM;
+
+#if DS1307_WRITE_ELISION
+  if ((Handler->ShadowValid & DS1307_SHADOW_CONTROL) &&
+      Handler->ShadowControl == ControlReg)
+    return DS1307_OK;
+#endif
+
+  if ((Err = DS1307_WriteRegs(Handler, DS1307_CONTROL, &ControlReg, 1)) < 0)
   {
-  case DS1307_OutWave_Low:
-    ControlReg = 0;
-    break;
+    Handler->ShadowValid &= ~DS1307_SHADOW_CONTROL;
+    return DS1307_BusResult(Err);
+  }
 
-  case DS1307_OutWave_High:
-    ControlReg = (1 << DS1307_OUT);
-    break;
+  Handler->ShadowControl = ControlReg;
+  Handler->ShadowValid |= DS1307_SHADOW_CONTROL;
+  return DS1307_OK;
+}
 
-  case DS1307_OutWave_1Hz:
-    ControlReg = (1 << DS1307_SQWE);
-    break;
 
-  case DS1307_OutWave_4KHz:
-    ControlReg = (1 << DS1307_SQWE) | (1 << DS1307_RS0);
-    break;
 
-  case DS1307_OutWave_8KHz:
-    ControlReg = (1 << DS1307_SQWE) | (1 << DS1307_RS1);
-    break;
+/**
+ ==================================================================================
+                     ##### Public Conversion Functions #####                       
+ ==================================================================================
+ */
 
-  case DS1307_OutWave_32KHz:
-    ControlReg = (1 << DS1307_SQWE) | (3 << DS1307_RS0);
-    break;
+/**
+ * @brief  Convert date and time to Unix time
+ * @note   Year 0 to 99 of DS1307 is interpreted as 2000 to 2099.
+ * @param  DateTime: Pointer to date and time value structure
+ * @param  Unix: Pointer to Unix time (seconds since 1970-01-01 00:00:00)
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_DateTimeToUnix(const DS1307_DateTime_t *DateTime, uint32_t *Unix)
+{
+  uint32_t Days = 0;
+  uint8_t Month = 0;
 
-  default:
+  if (!DateTime || !Unix)
     return DS1307_INVALID_PARAM;
+
+  if (DateTime->Second > 59 ||
+      DateTime->Minute > 59 ||
+      DateTime->Hour > 23 ||
+      DateTime->Month > 12 || DateTime->Month == 0 ||
+      DateTime->Year > 99 ||
+      DateTime->Day == 0 ||
+      DateTime->Day > DS1307_DaysInMonth(DateTime->Year, DateTime->Month))
+    return DS1307_INVALID_PARAM;
+
+  // days of passed years (2000 is a leap year)
+  Days = (uint32_t)DateTime->Year * 365 + ((DateTime->Year + 3) >> 2);
+  for (Month = 1; Month < DateTime->Month; Month++)
+    Days += DS1307_DaysInMonth(DateTime->Year, Month);
+  Days += DateTime->Day - 1;
+
+  *Unix = DS1307_UNIX_2000 + Days * DS1307_SEC_PER_DAY +
+          (uint32_t)DateTime->Hour * 3600 +
+          (uint32_t)DateTime->Minute * 60 +
+          DateTime->Second;
+
+  return DS1307_OK;
+}
+
+
+/**
+ * @brief  Convert Unix time to date and time
+ * @note   WeekDay is filled as 1 = Monday ... 7 = Sunday.
+ * @param  Unix: Unix time (2000-01-01 00:00:00 to 2099-12-31 23:59:59)
+ * @param  DateTime: Pointer to date and time value structure
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_UnixToDateTime(uint32_t Unix, DS1307_DateTime_t *DateTime)
+{
+  uint32_t Days = 0;
+  uint32_t Secs = 0;
+  uint16_t YearDays = 0;
+  uint8_t MonthDays = 0;
+
+  if (!DateTime || Unix < DS1307_UNIX_2000)
+    return DS1307_INVALID_PARAM;
+
+  Unix -= DS1307_UNIX_2000;
+  Days = Unix / DS1307_SEC_PER_DAY;
+  Secs = Unix % DS1307_SEC_PER_DAY;
+
+  DateTime->Second  = Secs % 60;
+  DateTime->Minute  = (Secs / 60) % 60;
+  DateTime->Hour    = Secs / 3600;
+  DateTime->WeekDay = ((Days + 5) % 7) + 1; // 2000-01-01 was Saturday
+
+  DateTime->Year = 0;
+  while (1)
+  {
+    YearDays = DS1307_IsLeapYear(DateTime->Year) ? 366 : 365;
+    if (Days < YearDays)
+      break;
+    Days -= YearDays;
+    if (++DateTime->Year > 99)
+      return DS1307_INVALID_PARAM;
   }
 
-  if (DS1307_WriteRegs(Handler, DS1307_CONTROL, &ControlReg, 1) < 0)
-    return DS1307_FAIL;
+  DateTime->Month = 1;
+  while (Days >= (MonthDays = DS1307_DaysInMonth(DateTime->Year, DateTime->Month)))
+  {
+    Days -= MonthDays;
+    DateTime->Month++;
+  }
+  DateTime->Day = Days + 1;
 
   return DS1307_OK;
 }
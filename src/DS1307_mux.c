@@ -0,0 +1,186 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_mux.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  DS1307 behind TCA9548A-style I2C multiplexers
+ *         Functionalities of the this file:
+ *          + Select the mux channel of a handler before each transfer
+ *          + Track the open channel per bus and skip redundant channel selects
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include "DS1307_mux.h"
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####                           
+ ==================================================================================
+ */
+
+static int8_t
+DS1307_Mux_Write(DS1307_MuxBus_t *Bus, uint8_t MuxAddress, uint8_t Mask)
+{
+  int8_t Err = Bus->Send(MuxAddress, &Mask, 1);
+
+  Bus->Selects++;
+  if (Err < 0)
+    Bus->Known = 0;
+
+  return Err;
+}
+
+static int8_t
+DS1307_Mux_Select(void *Context)
+{
+  DS1307_MuxPort_t *Port = (DS1307_MuxPort_t *)Context;
+  DS1307_MuxBus_t *Bus = Port->Bus;
+  int8_t Err = 0;
+
+  if (Bus->Known && Bus->MuxAddress == Port->MuxAddress &&
+      Bus->Channel == Port->Channel)
+  {
+    Bus->Skips++;
+    return 0;
+  }
+
+  // a channel left open on another mux would put two DS1307 on the bus.
+  // MuxAddress is kept when a write fails, so a mux in unknown state is
+  // closed here as well.
+  if (Bus->MuxAddress && Bus->MuxAddress != Port->MuxAddress)
+    if ((Err = DS1307_Mux_Write(Bus, Bus->MuxAddress, 0)) < 0)
+      return Err;
+
+  if ((Err = DS1307_Mux_Write(Bus, Port->MuxAddress, 1 << Port->Channel)) < 0)
+  {
+    Bus->MuxAddress = Port->MuxAddress; // may have opened the channel
+    return Err;
+  }
+
+  Bus->MuxAddress = Port->MuxAddress;
+  Bus->Channel = Port->Channel;
+  Bus->Known = 1;
+  return 0;
+}
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####                           
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize a mux bus
+ * @param  Bus: Pointer to bus
+ * @param  Send: Function to send data on the bus
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_MuxBus_Init(DS1307_MuxBus_t *Bus, DS1307_PlatformSendReceive_t Send)
+{
+  if (!Bus || !Send)
+    return DS1307_INVALID_PARAM;
+
+  Bus->Send = Send;
+  Bus->MuxAddress = 0;
+  Bus->Channel = 0;
+  Bus->Known = 0;
+  Bus->Selects = 0;
+  Bus->Skips = 0;
+
+  return DS1307_OK;
+}
+
+
+/**
+ * @brief  Forget the channel state of a bus (e.g. after a mux reset); the
+ *         next transfer selects its channel again
+ * @param  Bus: Pointer to bus
+ * @retval None
+ */
+void
+DS1307_MuxBus_Invalidate(DS1307_MuxBus_t *Bus)
+{
+  Bus->Known = 0;
+}
+
+
+/**
+ * @brief  Close the open channel of a bus
+ * @param  Bus: Pointer to bus
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send data.
+ */
+DS1307_Result_t
+DS1307_MuxBus_Release(DS1307_MuxBus_t *Bus)
+{
+  if (!Bus->MuxAddress)
+    return DS1307_OK;
+
+  if (DS1307_Mux_Write(Bus, Bus->MuxAddress, 0) < 0)
+    return DS1307_FAIL;
+
+  Bus->MuxAddress = 0;
+  Bus->Known = 1;
+  return DS1307_OK;
+}
+
+
+/**
+ * @brief  Place a handler behind a mux channel
+ * @note   Sets PlatformSelect and PlatformContext of handler. Port must stay
+ *         valid while the handler is used.
+ * @param  Handler: Pointer to handler
+ * @param  Port: Pointer to port storage of this handler
+ * @param  Bus: Pointer to bus of the mux
+ * @param  MuxAddress: 7-bit address of mux
+ * @param  Channel: Channel of mux (0 to 7)
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_Mux_Attach(DS1307_Handler_t *Handler, DS1307_MuxPort_t *Port,
+                  DS1307_MuxBus_t *Bus, uint8_t MuxAddress, uint8_t Channel)
+{
+  if (!Handler || !Port || !Bus || !MuxAddress || MuxAddress > 127 || Channel > 7)
+    return DS1307_INVALID_PARAM;
+
+  Port->Bus = Bus;
+  Port->MuxAddress = MuxAddress;
+  Port->Channel = Channel;
+
+  Handler->PlatformSelect = DS1307_Mux_Select;
+  Handler->PlatformContext = Port;
+
+  return DS1307_OK;
+}
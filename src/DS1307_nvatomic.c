@@ -0,0 +1,180 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_nvatomic.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  DS1307 power-fail-atomic NVRAM records
+ *         Functionalities of the this file:
+ *          + A/B slots with sequence number and CRC-8
+ *          + Commit completed by a single-byte slot selector write
+ *          + Recovery with one bulk read
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include <string.h>
+#include "DS1307_nvatomic.h"
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####                           
+ ==================================================================================
+ */
+
+/**
+ * @brief  CRC-8 (polynomial 0x31, initial 0xFF)
+ */
+static uint8_t
+DS1307_NvAtomic_CRC8(const uint8_t *Data, uint8_t Len)
+{
+  uint8_t CRC = 0xFF;
+  uint8_t Bit = 0;
+
+  while (Len--)
+  {
+    CRC ^= *Data++;
+    for (Bit = 0; Bit < 8; Bit++)
+      CRC = (CRC & 0x80) ? (uint8_t)((CRC << 1) ^ 0x31) : (uint8_t)(CRC << 1);
+  }
+
+  return CRC;
+}
+
+/**
+ * @brief  Check slot [Seq][Data][CRC]
+ */
+static uint8_t
+DS1307_NvAtomic_SlotValid(const uint8_t *Slot, uint8_t Size)
+{
+  return (DS1307_NvAtomic_CRC8(Slot, Size + 1) == Slot[Size + 1]) ? 1 : 0;
+}
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####                           
+ ==================================================================================
+ */
+
+/**
+ * @brief  Recover the last committed record with one bulk read
+ * @note   If no valid record exists (e.g. first power-up), NvAtomic->Valid is
+ *         cleared and Data is left untouched; commit the defaults then.
+ * @param  NvAtomic: Pointer to record handler
+ * @param  Handler: Pointer to initialized DS1307 handler
+ * @param  Address: Address of region in NVRAM (0 to 55)
+ * @param  Size: Size of record (1 to DS1307_NVATOMIC_MAX_SIZE)
+ * @param  Data: Pointer to record buffer (Size bytes)
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_INVALID_PARAM: Region is out of NVRAM.
+ */
+DS1307_Result_t
+DS1307_NvAtomic_Load(DS1307_NvAtomic_t *NvAtomic, DS1307_Handler_t *Handler,
+                     uint8_t Address, uint8_t Size, uint8_t *Data)
+{
+  uint8_t Region[DS1307_NVATOMIC_REGION_SIZE(DS1307_NVATOMIC_MAX_SIZE)];
+  uint8_t *Slot[2];
+  uint8_t Valid[2];
+  uint8_t Active = 0;
+
+  if (!NvAtomic || !Handler || !Data ||
+      Size == 0 || Size > DS1307_NVATOMIC_MAX_SIZE ||
+      Address + DS1307_NVATOMIC_REGION_SIZE(Size) > DS1307_RAM_SIZE)
+    return DS1307_INVALID_PARAM;
+
+  NvAtomic->Handler = Handler;
+  NvAtomic->Address = Address;
+  NvAtomic->Size = Size;
+  NvAtomic->Active = 0;
+  NvAtomic->Sequence = 0;
+  NvAtomic->Valid = 0;
+
+  if (DS1307_ReadRAM(Handler, Address, Region,
+                     DS1307_NVATOMIC_REGION_SIZE(Size)) != DS1307_OK)
+    return DS1307_FAIL;
+
+  Slot[0] = &Region[1];
+  Slot[1] = &Region[1 + Size + 2];
+  Valid[0] = DS1307_NvAtomic_SlotValid(Slot[0], Size);
+  Valid[1] = DS1307_NvAtomic_SlotValid(Slot[1], Size);
+
+  if (Region[0] <= 1 && Valid[Region[0]])
+    Active = Region[0];
+  else if (Valid[0] && Valid[1]) // selector is corrupted, take the newest one
+    Active = ((int8_t)(Slot[1][0] - Slot[0][0]) > 0) ? 1 : 0;
+  else if (Valid[0] || Valid[1])
+    Active = Valid[1];
+  else
+    return DS1307_OK; // nothing was committed yet
+
+  NvAtomic->Active = Active;
+  NvAtomic->Sequence = Slot[Active][0];
+  NvAtomic->Valid = 1;
+  memcpy(Data, &Slot[Active][1], Size);
+
+  return DS1307_OK;
+}
+
+
+/**
+ * @brief  Commit a new record
+ * @note   The inactive slot is written first, then the selector byte.
+ * @param  NvAtomic: Pointer to record handler (loaded by DS1307_NvAtomic_Load)
+ * @param  Data: Pointer to record (NvAtomic->Size bytes)
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data. The previous record
+ *                        remains valid.
+ */
+DS1307_Result_t
+DS1307_NvAtomic_Commit(DS1307_NvAtomic_t *NvAtomic, const uint8_t *Data)
+{
+  uint8_t Slot[DS1307_NVATOMIC_MAX_SIZE + 2];
+  uint8_t Target = NvAtomic->Valid ? (NvAtomic->Active ^ 1) : 0;
+  uint8_t Size = NvAtomic->Size;
+
+  Slot[0] = (uint8_t)(NvAtomic->Sequence + 1);
+  memcpy(&Slot[1], Data, Size);
+  Slot[Size + 1] = DS1307_NvAtomic_CRC8(Slot, Size + 1);
+
+  if (DS1307_WriteRAM(NvAtomic->Handler,
+                      NvAtomic->Address + 1 + Target * (Size + 2),
+                      Slot, Size + 2) != DS1307_OK)
+    return DS1307_FAIL;
+
+  // commit point
+  if (DS1307_WriteRAM(NvAtomic->Handler, NvAtomic->Address, &Target, 1) != DS1307_OK)
+    return DS1307_FAIL;
+
+  NvAtomic->Active = Target;
+  NvAtomic->Sequence = Slot[0];
+  NvAtomic->Valid = 1;
+
+  return DS1307_OK;
+}
@@ -0,0 +1,373 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_nvlog.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  DS1307 timestamped event log in NVRAM
+ *         Functionalities of the this file:
+ *          + Ring buffer of events with delta-encoded RTC timestamps
+ *          + O(1) append: new entry plus 1-byte head update
+ *          + Recovery with one bulk read
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stddef.h>
+#include "DS1307_nvlog.h"
+
+
+/* Private Constants ------------------------------------------------------------*/
+#define DS1307_NVLOG_MAGIC    0xE5
+#define DS1307_NVLOG_HEAD     1       // offset of head byte in region
+#define DS1307_NVLOG_BASE     2       // offset of base time in region
+#define DS1307_NVLOG_ENTRIES  6       // offset of first entry in region
+#define DS1307_NVLOG_ENTRY    4       // size of entry
+#define DS1307_NVLOG_WRAPPED  0x80    // head flag: log is full (Capacity-1 events)
+#define DS1307_NVLOG_INDEX    0x0F    // head mask: index of next entry
+#define DS1307_NVLOG_MAX_DELTA 0xFFFFFFUL
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####                           
+ ==================================================================================
+ */
+
+static uint32_t
+DS1307_NvLog_Get24(const uint8_t *Data)
+{
+  return (uint32_t)Data[0] | ((uint32_t)Data[1] << 8) | ((uint32_t)Data[2] << 16);
+}
+
+static void
+DS1307_NvLog_Put24(uint8_t *Data, uint32_t Value)
+{
+  Data[0] = (uint8_t)Value;
+  Data[1] = (uint8_t)(Value >> 8);
+  Data[2] = (uint8_t)(Value >> 16);
+}
+
+static uint8_t
+DS1307_NvLog_Slot(const DS1307_NvLog_t *NvLog, uint8_t Index)
+{
+  uint8_t Next = NvLog->Head & DS1307_NVLOG_INDEX;
+
+  // Index 0 is the newest entry, just before Next
+  return (uint8_t)((Next + NvLog->Capacity - 1 - Index) % NvLog->Capacity);
+}
+
+static DS1307_Result_t
+DS1307_NvLog_Format(DS1307_NvLog_t *NvLog, uint32_t Base)
+{
+  uint8_t Header[DS1307_NVLOG_ENTRIES];
+
+  Header[0] = DS1307_NVLOG_MAGIC;
+  Header[DS1307_NVLOG_HEAD] = 0;
+  Header[DS1307_NVLOG_BASE + 0] = (uint8_t)Base;
+  Header[DS1307_NVLOG_BASE + 1] = (uint8_t)(Base >> 8);
+  Header[DS1307_NVLOG_BASE + 2] = (uint8_t)(Base >> 16);
+  Header[DS1307_NVLOG_BASE + 3] = (uint8_t)(Base >> 24);
+
+  if (DS1307_WriteRAM(NvLog->Handler, NvLog->Address,
+                      Header, sizeof(Header)) != DS1307_OK)
+    return DS1307_FAIL;
+
+  NvLog->Head = 0;
+  NvLog->Base = Base;
+  return DS1307_OK;
+}
+
+/**
+ * @brief  Re-encode entries against a new base time that covers Unix
+ * @note   Entries are kept from the newest one back, including entries newer
+ *         than Unix (clock set back), as long as they and Unix fit in one
+ *         24-bit delta window. Older entries are dropped.
+ *         The head byte is cleared before the entries and the base are
+ *         rewritten and set again last, so a power loss during the rebase
+ *         leaves either the old log or an empty one, never entries decoded
+ *         against the wrong base.
+ */
+static DS1307_Result_t
+DS1307_NvLog_Rebase(DS1307_NvLog_t *NvLog, uint32_t Unix)
+{
+  uint8_t Region[DS1307_NVLOG_REGION_SIZE(DS1307_NVLOG_MAX_CAPACITY)];
+  uint8_t Count = DS1307_NvLog_Count(NvLog);
+  uint8_t Kept = 0;
+  uint8_t Head = 0;
+  uint8_t *Entry = NULL;
+  uint32_t Min = Unix;
+  uint32_t Max = Unix;
+  uint32_t Time = 0;
+  uint8_t i = 0;
+  DS1307_NvLogEvent_t Events[DS1307_NVLOG_MAX_CAPACITY];
+
+  if (DS1307_ReadRAM(NvLog->Handler, NvLog->Address, Region,
+                     DS1307_NVLOG_REGION_SIZE(NvLog->Capacity)) != DS1307_OK)
+    return DS1307_FAIL;
+
+  // collect events from the newest one while the window still fits
+  for (i = 0; i < Count; i++)
+  {
+    Entry = &Region[DS1307_NVLOG_ENTRIES +
+                    DS1307_NvLog_Slot(NvLog, i) * DS1307_NVLOG_ENTRY];
+    Time = NvLog->Base + DS1307_NvLog_Get24(&Entry[1]);
+    if ((Time > Max ? Time : Max) - (Time < Min ? Time : Min) >
+        DS1307_NVLOG_MAX_DELTA)
+      break;
+    if (Time < Min)
+      Min = Time;
+    if (Time > Max)
+      Max = Time;
+    Events[Kept].Code = Entry[0];
+    Events[Kept].Unix = Time;
+    Kept++;
+  }
+
+  // invalidate, the old entries are about to be overwritten
+  if (DS1307_WriteRAM(NvLog->Handler, NvLog->Address + DS1307_NVLOG_HEAD,
+                      &Head, 1) != DS1307_OK)
+    return DS1307_FAIL;
+  NvLog->Head = 0;
+
+  // base and entries are contiguous, the oldest kept event goes to slot 0
+  Region[DS1307_NVLOG_BASE + 0] = (uint8_t)Min;
+  Region[DS1307_NVLOG_BASE + 1] = (uint8_t)(Min >> 8);
+  Region[DS1307_NVLOG_BASE + 2] = (uint8_t)(Min >> 16);
+  Region[DS1307_NVLOG_BASE + 3] = (uint8_t)(Min >> 24);
+  for (i = 0; i < Kept; i++)
+  {
+    Entry = &Region[DS1307_NVLOG_ENTRIES + i * DS1307_NVLOG_ENTRY];
+    Entry[0] = Events[Kept - 1 - i].Code;
+    DS1307_NvLog_Put24(&Entry[1], Events[Kept - 1 - i].Unix - Min);
+  }
+
+  if (DS1307_WriteRAM(NvLog->Handler, NvLog->Address + DS1307_NVLOG_BASE,
+                      &Region[DS1307_NVLOG_BASE],
+                      DS1307_NVLOG_ENTRIES - DS1307_NVLOG_BASE +
+                      Kept * DS1307_NVLOG_ENTRY) != DS1307_OK)
+    return DS1307_FAIL;
+  NvLog->Base = Min;
+
+  // commit point, Kept < Capacity so slot Kept stays free
+  Head = Kept;
+  if (DS1307_WriteRAM(NvLog->Handler, NvLog->Address + DS1307_NVLOG_HEAD,
+                      &Head, 1) != DS1307_OK)
+    return DS1307_FAIL;
+
+  NvLog->Head = Head;
+  return DS1307_OK;
+}
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####                           
+ ==================================================================================
+ */
+
+/**
+ * @brief  Recover event log with one bulk read, or format it if not valid
+ * @param  NvLog: Pointer to log handler
+ * @param  Handler: Pointer to initialized DS1307 handler
+ * @param  Address: Address of region in NVRAM (0 to 55)
+ * @param  Capacity: Number of entry slots (2 to DS1307_NVLOG_MAX_CAPACITY),
+ *                   the log keeps up to Capacity-1 events
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_INVALID_PARAM: Region is out of NVRAM.
+ */
+DS1307_Result_t
+DS1307_NvLog_Init(DS1307_NvLog_t *NvLog, DS1307_Handler_t *Handler,
+                  uint8_t Address, uint8_t Capacity)
+{
+  uint8_t Header[DS1307_NVLOG_ENTRIES];
+  uint8_t Head = 0;
+
+  if (!NvLog || !Handler ||
+      Capacity < 2 || Capacity > DS1307_NVLOG_MAX_CAPACITY ||
+      Address + DS1307_NVLOG_REGION_SIZE(Capacity) > DS1307_RAM_SIZE)
+    return DS1307_INVALID_PARAM;
+
+  NvLog->Handler = Handler;
+  NvLog->Address = Address;
+  NvLog->Capacity = Capacity;
+
+  // entries are read on demand, the header is all recovery needs
+  if (DS1307_ReadRAM(Handler, Address, Header, sizeof(Header)) != DS1307_OK)
+    return DS1307_FAIL;
+
+  Head = Header[DS1307_NVLOG_HEAD];
+  if (Header[0] != DS1307_NVLOG_MAGIC ||
+      (Head & ~(DS1307_NVLOG_WRAPPED | DS1307_NVLOG_INDEX)) ||
+      (Head & DS1307_NVLOG_INDEX) >= Capacity)
+    return DS1307_NvLog_Format(NvLog, 0);
+
+  NvLog->Head = Head;
+  NvLog->Base = (uint32_t)Header[DS1307_NVLOG_BASE] |
+                ((uint32_t)Header[DS1307_NVLOG_BASE + 1] << 8) |
+                ((uint32_t)Header[DS1307_NVLOG_BASE + 2] << 16) |
+                ((uint32_t)Header[DS1307_NVLOG_BASE + 3] << 24);
+  return DS1307_OK;
+}
+
+
+/**
+ * @brief  Erase all events
+ * @param  NvLog: Pointer to log handler
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data.
+ */
+DS1307_Result_t
+DS1307_NvLog_Clear(DS1307_NvLog_t *NvLog)
+{
+  return DS1307_NvLog_Format(NvLog, 0);
+}
+
+
+/**
+ * @brief  Append an event stamped with the current RTC time
+ * @note   Writes the new entry and then the head byte. The whole log is
+ *         rewritten only when the delta overflows 24 bits (every ~194 days)
+ *         or the clock was set back before the base time.
+ * @param  NvLog: Pointer to log handler
+ * @param  Code: Application defined event code
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data.
+ */
+DS1307_Result_t
+DS1307_NvLog_Append(DS1307_NvLog_t *NvLog, uint8_t Code)
+{
+  DS1307_DateTime_t DateTime;
+  uint32_t Unix = 0;
+
+  if (DS1307_GetDateTime(NvLog->Handler, &DateTime) != DS1307_OK ||
+      DS1307_DateTimeToUnix(&DateTime, &Unix) != DS1307_OK)
+    return DS1307_FAIL;
+
+  return DS1307_NvLog_AppendAt(NvLog, Code, Unix);
+}
+
+
+/**
+ * @brief  Append an event with a given timestamp
+ * @param  NvLog: Pointer to log handler
+ * @param  Code: Application defined event code
+ * @param  Unix: Unix time of event
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data.
+ */
+DS1307_Result_t
+DS1307_NvLog_AppendAt(DS1307_NvLog_t *NvLog, uint8_t Code, uint32_t Unix)
+{
+  uint8_t Entry[DS1307_NVLOG_ENTRY];
+  uint8_t Next = NvLog->Head & DS1307_NVLOG_INDEX;
+  uint8_t Head = 0;
+
+  if (DS1307_NvLog_Count(NvLog) == 0 && NvLog->Base != Unix)
+  {
+    // empty log: start the delta window at this event
+    if (DS1307_NvLog_Format(NvLog, Unix) != DS1307_OK)
+      return DS1307_FAIL;
+  }
+  else if (Unix < NvLog->Base || Unix - NvLog->Base > DS1307_NVLOG_MAX_DELTA)
+  {
+    if (DS1307_NvLog_Rebase(NvLog, Unix) != DS1307_OK)
+      return DS1307_FAIL;
+  }
+  Next = NvLog->Head & DS1307_NVLOG_INDEX;
+
+  Entry[0] = Code;
+  DS1307_NvLog_Put24(&Entry[1], Unix - NvLog->Base);
+  if (DS1307_WriteRAM(NvLog->Handler,
+                      NvLog->Address + DS1307_NVLOG_ENTRIES + Next * DS1307_NVLOG_ENTRY,
+                      Entry, sizeof(Entry)) != DS1307_OK)
+    return DS1307_FAIL;
+
+  // commit point, in a full log the oldest entry becomes the free slot
+  Head = NvLog->Head & DS1307_NVLOG_WRAPPED;
+  if (++Next == NvLog->Capacity)
+  {
+    Next = 0;
+    Head = DS1307_NVLOG_WRAPPED;
+  }
+  Head |= Next;
+  if (DS1307_WriteRAM(NvLog->Handler, NvLog->Address + DS1307_NVLOG_HEAD,
+                      &Head, 1) != DS1307_OK)
+    return DS1307_FAIL;
+
+  NvLog->Head = Head;
+  return DS1307_OK;
+}
+
+
+/**
+ * @brief  Number of stored events
+ * @param  NvLog: Pointer to log handler
+ * @retval Number of events
+ */
+uint8_t
+DS1307_NvLog_Count(const DS1307_NvLog_t *NvLog)
+{
+  // the slot at the head index is never live
+  if (NvLog->Head & DS1307_NVLOG_WRAPPED)
+    return NvLog->Capacity - 1;
+  return NvLog->Head & DS1307_NVLOG_INDEX;
+}
+
+
+/**
+ * @brief  Read an event
+ * @param  NvLog: Pointer to log handler
+ * @param  Index: 0 for the newest event, Count-1 for the oldest one
+ * @param  Event: Pointer to event
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_INVALID_PARAM: Index is out of range.
+ */
+DS1307_Result_t
+DS1307_NvLog_Get(const DS1307_NvLog_t *NvLog, uint8_t Index,
+                 DS1307_NvLogEvent_t *Event)
+{
+  uint8_t Entry[DS1307_NVLOG_ENTRY];
+
+  if (!Event || Index >= DS1307_NvLog_Count(NvLog))
+    return DS1307_INVALID_PARAM;
+
+  if (DS1307_ReadRAM(NvLog->Handler,
+                     NvLog->Address + DS1307_NVLOG_ENTRIES +
+                     DS1307_NvLog_Slot(NvLog, Index) * DS1307_NVLOG_ENTRY,
+                     Entry, sizeof(Entry)) != DS1307_OK)
+    return DS1307_FAIL;
+
+  Event->Code = Entry[0];
+  Event->Unix = NvLog->Base + DS1307_NvLog_Get24(&Entry[1]);
+  return DS1307_OK;
+}
@@ -0,0 +1,171 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_nvschema.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  DS1307 bit-packed NVRAM schema
+ *         Functionalities of the this file:
+ *          + Declare packed NVRAM layouts with X-macros
+ *          + Generated pack/unpack accessors
+ *          + Field updates write only the changed bytes
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include "DS1307_nvschema.h"
+
+
+/* Private Constants ------------------------------------------------------------*/
+#define DS1307_FIELD_MAX_BYTES  5 // a 32-bit field may span 5 bytes
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####                           
+ ==================================================================================
+ */
+
+/**
+ * @brief  Get a field from packed image
+ * @param  Image: Pointer to packed image
+ * @param  BitOffset: Offset of field in bits
+ * @param  Bits: Width of field (1 to 32)
+ * @retval Value of field
+ */
+uint32_t
+DS1307_NvSchema_GetBits(const uint8_t *Image, uint16_t BitOffset, uint8_t Bits)
+{
+  uint32_t Value = 0;
+  uint8_t Done = 0;
+  uint8_t Shift = BitOffset & 0x07;
+  uint8_t Take = 0;
+
+  Image += BitOffset >> 3;
+  while (Done < Bits)
+  {
+    Take = 8 - Shift;
+    if (Take > Bits - Done)
+      Take = Bits - Done;
+
+    Value |= (uint32_t)((*Image++ >> Shift) & ((1U << Take) - 1)) << Done;
+    Done += Take;
+    Shift = 0;
+  }
+
+  return Value;
+}
+
+
+/**
+ * @brief  Put a field into packed image (no NVRAM access)
+ * @param  Image: Pointer to packed image
+ * @param  BitOffset: Offset of field in bits
+ * @param  Bits: Width of field (1 to 32)
+ * @param  Value: Value of field (extra high bits are dropped)
+ * @retval None
+ */
+void
+DS1307_NvSchema_PutBits(uint8_t *Image, uint16_t BitOffset, uint8_t Bits,
+                        uint32_t Value)
+{
+  uint8_t Shift = BitOffset & 0x07;
+  uint8_t Take = 0;
+  uint8_t Mask = 0;
+
+  Image += BitOffset >> 3;
+  while (Bits)
+  {
+    Take = 8 - Shift;
+    if (Take > Bits)
+      Take = Bits;
+
+    Mask = (uint8_t)(((1U << Take) - 1) << Shift);
+    *Image = (uint8_t)((*Image & ~Mask) | ((Value << Shift) & Mask));
+    Image++;
+
+    Value >>= Take;
+    Bits -= Take;
+    Shift = 0;
+  }
+}
+
+
+/**
+ * @brief  Update a field in packed image and NVRAM
+ * @note   Only the bytes of the field that actually changed are written. If
+ *         nothing changed, no transaction is made.
+ * @param  Handler: Pointer to handler
+ * @param  Address: NVRAM address of packed image (0 to 55)
+ * @param  Image: Pointer to packed image (loaded from NVRAM)
+ * @param  BitOffset: Offset of field in bits
+ * @param  Bits: Width of field (1 to 32)
+ * @param  Value: Value of field (extra high bits are dropped)
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_INVALID_PARAM: Field is out of NVRAM.
+ */
+DS1307_Result_t
+DS1307_NvSchema_SetBits(DS1307_Handler_t *Handler, uint8_t Address,
+                        uint8_t *Image, uint16_t BitOffset, uint8_t Bits,
+                        uint32_t Value)
+{
+  uint8_t Old[DS1307_FIELD_MAX_BYTES];
+  uint8_t FirstByte = BitOffset >> 3;
+  uint8_t LastByte = (BitOffset + Bits - 1) >> 3;
+  uint8_t First = 0xFF;
+  uint8_t Last = 0;
+  uint8_t i = 0;
+  DS1307_Result_t Result = DS1307_OK;
+
+  if (Bits == 0 || Bits > 32)
+    return DS1307_INVALID_PARAM;
+
+  for (i = FirstByte; i <= LastByte; i++)
+    Old[i - FirstByte] = Image[i];
+
+  DS1307_NvSchema_PutBits(Image, BitOffset, Bits, Value);
+
+  for (i = FirstByte; i <= LastByte; i++)
+  {
+    if (Image[i] != Old[i - FirstByte])
+    {
+      if (First == 0xFF)
+        First = i;
+      Last = i;
+    }
+  }
+
+  if (First == 0xFF)
+    return DS1307_OK; // nothing changed
+
+  Result = DS1307_WriteRAM(Handler, Address + First, &Image[First],
+                           Last - First + 1);
+  if (Result != DS1307_OK) // keep image in sync with NVRAM
+    for (i = FirstByte; i <= LastByte; i++)
+      Image[i] = Old[i - FirstByte];
+
+  return Result;
+}
@@ -0,0 +1,224 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_osccal.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  MCU oscillator calibration against DS1307 SQW/OUT
+ *         Functionalities of the this file:
+ *          + Measure MCU clock error in ppm
+ *          + Trim MCU oscillator
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include "DS1307_osccal.h"
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####                           
+ ==================================================================================
+ */
+
+static uint32_t
+DS1307_OscCal_Abs(int32_t Value)
+{
+  return (Value < 0) ? (uint32_t)-Value : (uint32_t)Value;
+}
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####                           
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize oscillator calibration and enable SQW/OUT.
+ * @note   The SQW/OUT pin of DS1307 must be connected to the input counted
+ *         by CountEdges.
+ * @param  OscCal: Pointer to calibration handler
+ * @param  Handler: Pointer to initialized DS1307 handler
+ * @param  OutWave: Frequency of SQW/OUT
+ *         - DS1307_OutWave_4KHz
+ *         - DS1307_OutWave_8KHz
+ *         - DS1307_OutWave_32KHz
+ * @param  CountEdges: Edge counter function
+ * @param  Trim: Oscillator trim function (NULL: measurement only)
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_OscCal_Init(DS1307_OscCal_t *OscCal, DS1307_Handler_t *Handler,
+                   DS1307_OutWave_t OutWave, DS1307_OscCalCount_t CountEdges,
+                   DS1307_OscCalTrim_t Trim)
+{
+  if (!OscCal || !Handler || !CountEdges)
+    return DS1307_INVALID_PARAM;
+
+  switch (OutWave)
+  {
+  case DS1307_OutWave_4KHz:
+    OscCal->Frequency = 4096;
+    break;
+
+  case DS1307_OutWave_8KHz:
+    OscCal->Frequency = 8192;
+    break;
+
+  case DS1307_OutWave_32KHz:
+    OscCal->Frequency = 32768;
+    break;
+
+  default:
+    return DS1307_INVALID_PARAM;
+  }
+
+  OscCal->Handler = Handler;
+  OscCal->CountEdges = CountEdges;
+  OscCal->Trim = Trim;
+  OscCal->GateUs = DS1307_OSCCAL_GATE_US;
+  OscCal->Edges = 0;
+  OscCal->ErrorPpm = 0;
+  OscCal->ResolutionPpm = 0;
+  OscCal->Steps = 0;
+
+  return DS1307_SetOutWave(Handler, OutWave);
+}
+
+
+/**
+ * @brief  Measure the MCU clock error against SQW/OUT.
+ * @note   The result is stored in OscCal->ErrorPpm (+- OscCal->ResolutionPpm).
+ *         No I2C access is made by this function.
+ * @param  OscCal: Pointer to calibration handler
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Edges could not be counted or no edge was seen.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_OscCal_Measure(DS1307_OscCal_t *OscCal)
+{
+  uint64_t Expected = 0; // edges expected in the gate, scaled by 1e6
+  uint32_t Edges = 0;
+
+  if (!OscCal || !OscCal->CountEdges || !OscCal->GateUs)
+    return DS1307_INVALID_PARAM;
+
+  if (OscCal->CountEdges(OscCal->GateUs, &Edges) < 0 || Edges == 0)
+    return DS1307_FAIL;
+
+  // a fast MCU ends the gate early and counts fewer edges:
+  // error = Expected / Edges - 1
+  Expected = (uint64_t)OscCal->Frequency * OscCal->GateUs;
+  OscCal->Edges = Edges;
+  OscCal->ErrorPpm =
+    (int32_t)(((int64_t)Expected - (int64_t)Edges * 1000000) / (int64_t)Edges);
+  OscCal->ResolutionPpm = (uint32_t)((1000000000000ULL + Expected - 1) / Expected);
+
+  return DS1307_OK;
+}
+
+
+/**
+ * @brief  Trim the MCU oscillator (e.g. OSCCAL on AVR) until its error is
+ *         within TolerancePpm.
+ * @note   Steps are applied one at a time and measured. The trimming stops
+ *         at the closest setting when the error no longer improves.
+ * @param  OscCal: Pointer to calibration handler
+ * @param  MaxSteps: Maximum number of trim steps
+ * @param  TolerancePpm: Accepted error
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Error is within TolerancePpm.
+ *         - DS1307_FAIL: Edges could not be counted or the error is still
+ *                        out of tolerance (ErrorPpm holds the best error).
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_OscCal_Trim(DS1307_OscCal_t *OscCal, uint16_t MaxSteps,
+                   uint32_t TolerancePpm)
+{
+  DS1307_Result_t Result = DS1307_OK;
+  uint32_t BestEdges = 0;
+  int32_t BestPpm = 0;
+  uint16_t i = 0;
+  int8_t Step = 0;
+
+  if (!OscCal || !OscCal->Trim)
+    return DS1307_INVALID_PARAM;
+
+  OscCal->Steps = 0;
+  Result = DS1307_OscCal_Measure(OscCal);
+  if (Result != DS1307_OK)
+    return Result;
+
+  for (i = 0; i < MaxSteps &&
+              DS1307_OscCal_Abs(OscCal->ErrorPpm) > TolerancePpm; i++)
+  {
+    Step = (OscCal->ErrorPpm > 0) ? -1 : 1;
+    if (OscCal->Trim(Step) < 0)
+      break;
+    OscCal->Steps += Step;
+
+    BestEdges = OscCal->Edges;
+    BestPpm = OscCal->ErrorPpm;
+    Result = DS1307_OscCal_Measure(OscCal);
+    if (Result != DS1307_OK)
+      return Result;
+
+    // overshoot: the previous setting was closer
+    if (DS1307_OscCal_Abs(OscCal->ErrorPpm) >= DS1307_OscCal_Abs(BestPpm))
+    {
+      OscCal->Trim(-Step);
+      OscCal->Steps -= Step;
+      OscCal->Edges = BestEdges;
+      OscCal->ErrorPpm = BestPpm;
+      break;
+    }
+  }
+
+  return (DS1307_OscCal_Abs(OscCal->ErrorPpm) <= TolerancePpm) ?
+         DS1307_OK : DS1307_FAIL;
+}
+
+
+/**
+ * @brief  Correct a nominal MCU frequency with the last measurement
+ * @note   Use it to compute baud rate and timer settings from the actual
+ *         frequency when the oscillator cannot be trimmed.
+ * @param  OscCal: Pointer to calibration handler
+ * @param  NominalHz: Nominal frequency (e.g. F_CPU)
+ * @retval Actual frequency in Hz
+ */
+uint32_t
+DS1307_OscCal_ActualHz(const DS1307_OscCal_t *OscCal, uint32_t NominalHz)
+{
+  return (uint32_t)((int64_t)NominalHz +
+                    (int64_t)NominalHz * OscCal->ErrorPpm / 1000000);
+}
@@ -0,0 +1,181 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_shared.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  DS1307 single-flight date and time reads
+ *         Functionalities of the this file:
+ *          + Share one in-flight date and time read between concurrent callers
+ *          + Reuse a completed read within a freshness window
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include "DS1307_shared.h"
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####                           
+ ==================================================================================
+ */
+
+static uint8_t
+DS1307_Shared_IsFresh(DS1307_Shared_t *Shared)
+{
+  DS1307_PlatformGetTime_t GetTimeUs = Shared->Handler->PlatformGetTimeUs;
+
+  if (!Shared->Valid || !Shared->FreshUs || !GetTimeUs)
+    return 0;
+
+  return ((uint32_t)(GetTimeUs() - Shared->Stamp) <= Shared->FreshUs) ? 1 : 0;
+}
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####                           
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize a shared handler
+ * @note   The freshness window needs PlatformGetTimeUs of handler.
+ * @param  Shared: Pointer to shared handler
+ * @param  Handler: Pointer to initialized DS1307 handler
+ * @param  Lock: Lock a mutex
+ * @param  Unlock: Unlock the mutex
+ * @param  LockContext: Pointer passed to Lock and Unlock (e.g. the mutex)
+ * @param  FreshUs: Age in microseconds up to which a completed read is reused
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_Shared_Init(DS1307_Shared_t *Shared, DS1307_Handler_t *Handler,
+                   DS1307_SharedLock_t Lock, DS1307_SharedLock_t Unlock,
+                   void *LockContext, uint32_t FreshUs)
+{
+  if (!Shared || !Handler || !Lock || !Unlock)
+    return DS1307_INVALID_PARAM;
+
+  Shared->Handler = Handler;
+  Shared->Lock = Lock;
+  Shared->Unlock = Unlock;
+  Shared->LockContext = LockContext;
+  Shared->FreshUs = FreshUs;
+  Shared->Generation = 0;
+  Shared->Valid = 0;
+  Shared->Stamp = 0;
+  Shared->Reads = 0;
+  Shared->Hits = 0;
+
+  return DS1307_OK;
+}
+
+
+/**
+ * @brief  Get date and time, sharing reads between concurrent callers
+ * @note   A caller that arrives while a read is in flight waits for it and
+ *         gets its result. A read completed less than FreshUs ago is reused.
+ * @param  Shared: Pointer to shared handler
+ * @param  DateTime: pointer to date and time value structure
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_Shared_GetDateTime(DS1307_Shared_t *Shared, DS1307_DateTime_t *DateTime)
+{
+  DS1307_Result_t Result = DS1307_OK;
+  uint8_t Ticket;
+
+  if (!DateTime)
+    return DS1307_INVALID_PARAM;
+
+  // a read holds the lock, so a read completed while we were waiting for it
+  // was in flight when we arrived
+  Ticket = Shared->Generation;
+  Shared->Lock(Shared->LockContext);
+
+  if (Shared->Valid &&
+      (Shared->Generation != Ticket || DS1307_Shared_IsFresh(Shared)))
+  {
+    Shared->Hits++;
+  }
+  else
+  {
+    Shared->Reads++;
+    Result = DS1307_GetDateTime(Shared->Handler, &Shared->DateTime);
+    Shared->Valid = (Result == DS1307_OK) ? 1 : 0;
+    if (Shared->Handler->PlatformGetTimeUs)
+      Shared->Stamp = Shared->Handler->PlatformGetTimeUs();
+    Shared->Generation++;
+  }
+
+  if (Shared->Valid)
+    *DateTime = Shared->DateTime;
+
+  Shared->Unlock(Shared->LockContext);
+  return Result;
+}
+
+
+/**
+ * @brief  Set date and time and drop the shared result
+ * @param  Shared: Pointer to shared handler
+ * @param  DateTime: pointer to date and time value structure
+ * @retval DS1307_Result_t (same as DS1307_SetDateTime)
+ */
+DS1307_Result_t
+DS1307_Shared_SetDateTime(DS1307_Shared_t *Shared, DS1307_DateTime_t *DateTime)
+{
+  DS1307_Result_t Result;
+
+  Shared->Lock(Shared->LockContext);
+  Result = DS1307_SetDateTime(Shared->Handler, DateTime);
+  Shared->Valid = 0;
+  Shared->Unlock(Shared->LockContext);
+
+  return Result;
+}
+
+
+/**
+ * @brief  Drop the shared result (e.g. after the clock was set directly)
+ * @param  Shared: Pointer to shared handler
+ * @retval None
+ */
+void
+DS1307_Shared_Invalidate(DS1307_Shared_t *Shared)
+{
+  Shared->Lock(Shared->LockContext);
+  Shared->Valid = 0;
+  Shared->Unlock(Shared->LockContext);
+}
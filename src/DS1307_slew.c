@@ -0,0 +1,245 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_slew.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  DS1307 slewed monotonic time
+ *         Functionalities of the this file:
+ *          + Absorb time corrections gradually at a bounded slew rate (like adjtime)
+ *          + Monotonic corrected timestamps without I2C access
+ *          + Fold the accumulated correction into DS1307 past a threshold
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stddef.h>
+#include "DS1307_slew.h"
+
+
+/* Private Constants ------------------------------------------------------------*/
+#define DS1307_SLEW_US_PER_S  1000000L
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####                           
+ ==================================================================================
+ */
+
+static void
+DS1307_Slew_Update(DS1307_Slew_t *Slew)
+{
+  uint64_t Raw = 0;
+  uint64_t Budget = 0;
+  int64_t Step = 0;
+
+  DS1307_Timestamp_GetUs(Slew->Timestamp, &Raw);
+
+  if (!Slew->Started)
+  {
+    Slew->LastRaw = Raw;
+    Slew->LastOut = Raw + Slew->Offset;
+    Slew->Started = 1;
+  }
+
+  if (Raw > Slew->LastRaw && Slew->Pending)
+  {
+    // budget = elapsed * MaxPpm / 10^6, the remainder keeps frequent callers
+    // from rounding the slew down to zero
+    Budget = (Raw - Slew->LastRaw) * Slew->MaxPpm + Slew->Remainder;
+    Slew->Remainder = (uint32_t)(Budget % DS1307_SLEW_US_PER_S);
+    Budget /= DS1307_SLEW_US_PER_S;
+
+    if (Slew->Pending > 0)
+      Step = ((uint64_t)Slew->Pending < Budget) ? Slew->Pending : (int64_t)Budget;
+    else
+      Step = ((uint64_t)-Slew->Pending < Budget) ? Slew->Pending : -(int64_t)Budget;
+
+    Slew->Offset += Step;
+    Slew->Pending -= Step;
+    if (!Slew->Pending)
+      Slew->Remainder = 0;
+  }
+
+  Slew->LastRaw = Raw;
+}
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####                           
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize slew handler
+ * @param  Slew: Pointer to slew handler
+ * @param  Timestamp: Pointer to initialized timestamp service
+ * @param  MaxPpm: Maximum slew rate in ppm (1 to 500000)
+ * @param  ThresholdUs: Correction in us that is written to the chip (0: never)
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_Slew_Init(DS1307_Slew_t *Slew, DS1307_Timestamp_t *Timestamp,
+                 uint32_t MaxPpm, uint32_t ThresholdUs)
+{
+  if (!Slew || !Timestamp || MaxPpm == 0 || MaxPpm > 500000)
+    return DS1307_INVALID_PARAM;
+
+  Slew->Timestamp = Timestamp;
+  Slew->MaxPpm = MaxPpm;
+  Slew->ThresholdUs = ThresholdUs;
+  Slew->Offset = 0;
+  Slew->Pending = 0;
+  Slew->Remainder = 0;
+  Slew->LastRaw = 0;
+  Slew->LastOut = 0;
+  Slew->Started = 0;
+
+  return DS1307_OK;
+}
+
+
+/**
+ * @brief  Request a gradual correction (like adjtime)
+ * @note   The request replaces any correction that is still pending.
+ * @param  Slew: Pointer to slew handler
+ * @param  DeltaUs: Correction in us (positive: clock is late)
+ * @param  RemainingUs: Pointer to the pending correction that was replaced
+ *                      (NULL if not needed)
+ * @retval None
+ */
+void
+DS1307_Slew_Adjust(DS1307_Slew_t *Slew, int64_t DeltaUs, int64_t *RemainingUs)
+{
+  // apply the old request up to now before it is replaced
+  DS1307_Slew_Update(Slew);
+
+  if (RemainingUs)
+    *RemainingUs = Slew->Pending;
+
+  Slew->Pending = DeltaUs;
+  Slew->Remainder = 0;
+}
+
+
+/**
+ * @brief  Request a gradual correction towards a reference time
+ * @param  Slew: Pointer to slew handler
+ * @param  TargetUs: Reference time in microseconds since 1970-01-01 00:00:00
+ * @retval None
+ */
+void
+DS1307_Slew_SetUs(DS1307_Slew_t *Slew, uint64_t TargetUs)
+{
+  DS1307_Slew_Update(Slew);
+  DS1307_Slew_Adjust(Slew,
+                     (int64_t)(TargetUs - (Slew->LastRaw + Slew->Offset)), NULL);
+}
+
+
+/**
+ * @brief  Get corrected time in microseconds since 1970-01-01 00:00:00
+ * @note   No I2C access is made by this function. Returned values never
+ *         decrease.
+ * @param  Slew: Pointer to slew handler
+ * @param  Micros: Pointer to timestamp
+ * @retval None
+ */
+void
+DS1307_Slew_GetUs(DS1307_Slew_t *Slew, uint64_t *Micros)
+{
+  uint64_t Out = 0;
+
+  DS1307_Slew_Update(Slew);
+
+  // a slower slew can not go backwards, but a re-synchronized timestamp
+  // service can; hold the output until the clock catches up
+  Out = Slew->LastRaw + Slew->Offset;
+  if (Out < Slew->LastOut)
+    Out = Slew->LastOut;
+
+  Slew->LastOut = Out;
+  *Micros = Out;
+}
+
+
+/**
+ * @brief  Write the applied correction to DS1307 if it passed the threshold
+ * @note   Whole seconds of Offset are moved into the chip and the timestamp
+ *         service is re-synchronized (up to 2 s). Call it from a background
+ *         task; corrected time stays monotonic across the rewrite.
+ * @param  Slew: Pointer to slew handler
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful (or nothing to do).
+ *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
+ */
+DS1307_Result_t
+DS1307_Slew_Commit(DS1307_Slew_t *Slew)
+{
+  DS1307_Handler_t *Handler = Slew->Timestamp->Handler;
+  DS1307_DateTime_t DateTime;
+  DS1307_Result_t Result = DS1307_OK;
+  uint32_t Unix = 0;
+  int32_t Shift = 0;
+
+  DS1307_Slew_Update(Slew);
+
+  if (!Slew->ThresholdUs ||
+      (uint64_t)(Slew->Offset < 0 ? -Slew->Offset : Slew->Offset) < Slew->ThresholdUs)
+    return DS1307_OK;
+
+  Shift = (int32_t)(Slew->Offset / DS1307_SLEW_US_PER_S);
+  if (!Shift)
+    return DS1307_OK;
+
+  // write right after a transition, so the reset of the countdown chain
+  // costs only the duration of this read-modify-write
+  if (Handler->PlatformGetTimeUs)
+    Result = DS1307_WaitSecondEdgeUs(Handler, DS1307_TIMESTAMP_SYNC_TIMEOUT_US);
+  else
+    Result = DS1307_WaitSecondEdge(Handler, DS1307_TIMESTAMP_SYNC_POLLS);
+  if (Result != DS1307_OK)
+    return Result;
+  if ((Result = DS1307_GetDateTime(Handler, &DateTime)) != DS1307_OK)
+    return Result;
+  if (DS1307_DateTimeToUnix(&DateTime, &Unix) != DS1307_OK ||
+      DS1307_UnixToDateTime((uint32_t)((int64_t)Unix + Shift), &DateTime) != DS1307_OK)
+    return DS1307_FAIL;
+  if ((Result = DS1307_SetDateTimeAligned(Handler, &DateTime)) != DS1307_OK)
+    return Result;
+
+  Slew->Offset -= (int64_t)Shift * DS1307_SLEW_US_PER_S;
+  Slew->LastRaw += (int64_t)Shift * DS1307_SLEW_US_PER_S;
+  Slew->Timestamp->UnixRef += Shift;
+
+  // the countdown chain restarted at the write, align edge counting with it
+  return DS1307_Timestamp_Sync(Slew->Timestamp);
+}
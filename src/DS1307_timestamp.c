@@ -0,0 +1,253 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_timestamp.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  DS1307 sub-second timestamp service
+ *         Functionalities of the this file:
+ *          + Count SQW/OUT edges of DS1307 (hardware counter or ISR)
+ *          + Combine edge count with RTC seconds into 64-bit timestamps
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include "DS1307_timestamp.h"
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####                           
+ ==================================================================================
+ */
+
+static uint32_t
+DS1307_Timestamp_ReadCounter(DS1307_Timestamp_t *Timestamp)
+{
+  uint32_t Count = 0;
+
+  if (Timestamp->GetCounter)
+    return Timestamp->GetCounter() & Timestamp->CounterMask;
+
+  // IsrCounter may not be read atomically on 8-bit MCUs
+  do
+  {
+    Count = Timestamp->IsrCounter;
+  } while (Count != Timestamp->IsrCounter);
+
+  return Count;
+}
+
+static DS1307_Result_t
+DS1307_Timestamp_WaitEdge(DS1307_Handler_t *Handler)
+{
+  if (Handler->PlatformGetTimeUs)
+    return DS1307_WaitSecondEdgeUs(Handler, DS1307_TIMESTAMP_SYNC_TIMEOUT_US);
+
+  return DS1307_WaitSecondEdge(Handler, DS1307_TIMESTAMP_SYNC_POLLS);
+}
+
+static void
+DS1307_Timestamp_Update(DS1307_Timestamp_t *Timestamp)
+{
+  uint32_t Count = DS1307_Timestamp_ReadCounter(Timestamp);
+
+  Timestamp->Elapsed += (Count - Timestamp->LastCount) & Timestamp->CounterMask;
+  Timestamp->LastCount = Count;
+}
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####                           
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize timestamp service
+ * @note   The SQW/OUT pin of DS1307 must be connected to the input of the
+ *         hardware counter (or to the interrupt pin that calls
+ *         DS1307_Timestamp_EdgeISR).
+ * @param  Timestamp: Pointer to timestamp handler
+ * @param  Handler: Pointer to initialized DS1307 handler
+ * @param  OutWave: Frequency of SQW/OUT
+ *         - DS1307_OutWave_4KHz
+ *         - DS1307_OutWave_8KHz
+ *         - DS1307_OutWave_32KHz
+ * @param  GetCounter: Hardware counter read function. NULL to use ISR counter.
+ * @param  CounterBits: Width of hardware counter in bits (1 to 32). It is
+ *                      ignored if GetCounter is NULL.
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_Timestamp_Init(DS1307_Timestamp_t *Timestamp, DS1307_Handler_t *Handler,
+                      DS1307_OutWave_t OutWave,
+                      DS1307_TimestampCounter_t GetCounter, uint8_t CounterBits)
+{
+  DS1307_Result_t Result = DS1307_OK;
+
+  if (!Timestamp || !Handler)
+    return DS1307_INVALID_PARAM;
+
+  switch (OutWave)
+  {
+  case DS1307_OutWave_4KHz:
+    Timestamp->Frequency = 4096;
+    break;
+
+  case DS1307_OutWave_8KHz:
+    Timestamp->Frequency = 8192;
+    break;
+
+  case DS1307_OutWave_32KHz:
+    Timestamp->Frequency = 32768;
+    break;
+
+  default:
+    return DS1307_INVALID_PARAM;
+  }
+
+  if (GetCounter)
+  {
+    if (CounterBits == 0 || CounterBits > 32)
+      return DS1307_INVALID_PARAM;
+    Timestamp->CounterMask = (CounterBits == 32) ?
+                             0xFFFFFFFFUL : ((1UL << CounterBits) - 1);
+  }
+  else
+  {
+    Timestamp->CounterMask = 0xFFFFFFFFUL;
+  }
+
+  Timestamp->Handler = Handler;
+  Timestamp->GetCounter = GetCounter;
+  Timestamp->IsrCounter = 0;
+  Timestamp->LastCount = 0;
+  Timestamp->Elapsed = 0;
+  Timestamp->UnixRef = 0;
+
+  Result = DS1307_SetOutWave(Handler, OutWave);
+  if (Result != DS1307_OK)
+    return Result;
+
+  return DS1307_Timestamp_Sync(Timestamp);
+}
+
+
+/**
+ * @brief  Align edge counter with the RTC seconds
+ * @note   This function waits for a second transition of DS1307 (up to 1 s).
+ *         Call it once after initialization and whenever edges may have been
+ *         lost (e.g. counter stopped in sleep mode).
+ * @param  Timestamp: Pointer to timestamp handler
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data or oscillator is halted.
+ */
+DS1307_Result_t
+DS1307_Timestamp_Sync(DS1307_Timestamp_t *Timestamp)
+{
+  DS1307_DateTime_t DateTime;
+  uint32_t Count = 0;
+  uint32_t Unix = 0;
+
+  if (DS1307_Timestamp_WaitEdge(Timestamp->Handler) != DS1307_OK)
+    return DS1307_FAIL;
+
+  // latch the counter as close as possible to the transition
+  Count = DS1307_Timestamp_ReadCounter(Timestamp);
+
+  if (DS1307_GetDateTime(Timestamp->Handler, &DateTime) != DS1307_OK)
+    return DS1307_FAIL;
+
+  if (DS1307_DateTimeToUnix(&DateTime, &Unix) != DS1307_OK)
+    return DS1307_FAIL;
+
+  Timestamp->LastCount = Count;
+  Timestamp->Elapsed = 0;
+  Timestamp->UnixRef = Unix;
+
+  return DS1307_OK;
+}
+
+
+/**
+ * @brief  Count one edge of SQW/OUT
+ * @note   Call this function from the edge interrupt when no hardware counter
+ *         is available.
+ * @param  Timestamp: Pointer to timestamp handler
+ * @retval None
+ */
+void
+DS1307_Timestamp_EdgeISR(DS1307_Timestamp_t *Timestamp)
+{
+  Timestamp->IsrCounter++;
+}
+
+
+/**
+ * @brief  Get timestamp in microseconds since 1970-01-01 00:00:00
+ * @note   No I2C access is made by this function.
+ * @note   This function must be called at least once per counter wrap period
+ *         (2^CounterBits / Frequency seconds).
+ * @param  Timestamp: Pointer to timestamp handler
+ * @param  Micros: Pointer to timestamp
+ * @retval None
+ */
+void
+DS1307_Timestamp_GetUs(DS1307_Timestamp_t *Timestamp, uint64_t *Micros)
+{
+  uint64_t Seconds = 0;
+  uint32_t Fraction = 0;
+
+  DS1307_Timestamp_Update(Timestamp);
+
+  // Frequency is a power of 2, so the split is cheap and overflow-free
+  Seconds = Timestamp->Elapsed / Timestamp->Frequency;
+  Fraction = (uint32_t)(Timestamp->Elapsed % Timestamp->Frequency);
+
+  *Micros = (Timestamp->UnixRef + Seconds) * 1000000ULL +
+            ((uint64_t)Fraction * 1000000UL) / Timestamp->Frequency;
+}
+
+
+/**
+ * @brief  Get timestamp in milliseconds since 1970-01-01 00:00:00
+ * @note   No I2C access is made by this function.
+ * @param  Timestamp: Pointer to timestamp handler
+ * @param  Millis: Pointer to timestamp
+ * @retval None
+ */
+void
+DS1307_Timestamp_GetMs(DS1307_Timestamp_t *Timestamp, uint64_t *Millis)
+{
+  uint64_t Micros = 0;
+
+  DS1307_Timestamp_GetUs(Timestamp, &Micros);
+  *Millis = Micros / 1000;
+}
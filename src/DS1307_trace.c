@@ -0,0 +1,430 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_trace.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  DS1307 bus trace record/replay
+ *         Functionalities of the this file:
+ *          + Record every platform transaction to a compact binary trace
+ *          + Replay a trace through the driver without hardware
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include <string.h>
+#include "DS1307_trace.h"
+
+
+/* Private Variables ------------------------------------------------------------*/
+static DS1307_PlatformInitDeinit_t OrigInit;
+static DS1307_PlatformInitDeinit_t OrigDeInit;
+static DS1307_PlatformInitDeinit_t OrigRecover;
+static DS1307_PlatformSendReceive_t OrigSend;
+static DS1307_PlatformSendReceive_t OrigReceive;
+static DS1307_PlatformWriteRead_t OrigWriteRead;
+static DS1307_PlatformSelect_t OrigSelect;
+static DS1307_PlatformDelay_t OrigDelay;
+static DS1307_PlatformGetTime_t OrigGetTimeUs;
+static DS1307_TraceWrite_t TraceWrite;
+static DS1307_TraceRead_t TraceRead;
+static DS1307_TraceTime_t TraceTime;
+static uint32_t Mismatches;
+static uint8_t Active;
+
+// replay reads one record ahead, its timestamp is the replayed time
+static DS1307_TraceRecord_t NextRecord;
+static uint8_t NextPayload[255];
+static uint8_t NextValid;
+static uint32_t ReplayTime;
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####                           
+ ==================================================================================
+ */
+
+static void
+DS1307_Trace_Record(uint8_t Flags, uint8_t Address, int8_t Result,
+                    const uint8_t *Data, uint8_t Len, uint32_t Timestamp)
+{
+  uint8_t Header[DS1307_TRACE_HEADER_SIZE];
+
+  Header[0] = Flags;
+  Header[1] = Address;
+  Header[2] = (uint8_t)Result;
+  Header[3] = Len;
+  Header[4] = (uint8_t)Timestamp;
+  Header[5] = (uint8_t)(Timestamp >> 8);
+  Header[6] = (uint8_t)(Timestamp >> 16);
+  Header[7] = (uint8_t)(Timestamp >> 24);
+
+  // a failing sink must not disturb the bus traffic being recorded
+  if (TraceWrite(Header, sizeof(Header)) == 0 && Len)
+    TraceWrite(Data, Len);
+}
+
+static int8_t
+DS1307_Trace_RecordSend(uint8_t Address, uint8_t *Data, uint8_t Len)
+{
+  uint32_t Timestamp = TraceTime ? TraceTime() : 0;
+  int8_t Result = OrigSend(Address, Data, Len);
+
+  DS1307_Trace_Record(0, Address, Result, Data, Len, Timestamp);
+  return Result;
+}
+
+static int8_t
+DS1307_Trace_RecordReceive(uint8_t Address, uint8_t *Data, uint8_t Len)
+{
+  uint32_t Timestamp = TraceTime ? TraceTime() : 0;
+  int8_t Result = OrigReceive(Address, Data, Len);
+
+  DS1307_Trace_Record(DS1307_TRACE_RECEIVE, Address, Result, Data, Len, Timestamp);
+  return Result;
+}
+
+static int8_t
+DS1307_Trace_RecordWriteRead(uint8_t Address, uint8_t *TxData, uint8_t TxLen,
+                             uint8_t *RxData, uint8_t RxLen)
+{
+  uint8_t Payload[255];
+  uint32_t Timestamp = TraceTime ? TraceTime() : 0;
+  int8_t Result = OrigWriteRead(Address, TxData, TxLen, RxData, RxLen);
+
+  // payload is [TxLen][TxData][RxData], the driver never gets near 255 bytes
+  if (1 + TxLen + RxLen > (int)sizeof(Payload))
+    RxLen = (uint8_t)(sizeof(Payload) - 1 - TxLen);
+  Payload[0] = TxLen;
+  memcpy(&Payload[1], TxData, TxLen);
+  memcpy(&Payload[1 + TxLen], RxData, RxLen);
+
+  DS1307_Trace_Record(DS1307_TRACE_WRITEREAD, Address, Result,
+                      Payload, (uint8_t)(1 + TxLen + RxLen), Timestamp);
+  return Result;
+}
+
+static int8_t
+DS1307_Trace_RecordSelect(void *Context)
+{
+  uint32_t Timestamp = TraceTime ? TraceTime() : 0;
+  int8_t Result = OrigSelect(Context);
+
+  DS1307_Trace_Record(DS1307_TRACE_SELECT, 0, Result, NULL, 0, Timestamp);
+  return Result;
+}
+
+static int8_t
+DS1307_Trace_ReplayInitDeInit(void)
+{
+  return 0;
+}
+
+static void
+DS1307_Trace_ReplayDelay(uint32_t Us)
+{
+  (void)Us;
+}
+
+static uint32_t
+DS1307_Trace_ReplayGetTimeUs(void)
+{
+  // the next transfer starts at its recorded time, after the end: last one
+  return NextValid ? NextRecord.Timestamp : ReplayTime;
+}
+
+static void
+DS1307_Trace_ReplayAdvance(void)
+{
+  NextValid = (DS1307_Trace_ReadRecord(TraceRead, &NextRecord,
+                                       NextPayload) == DS1307_OK);
+}
+
+static DS1307_Result_t
+DS1307_Trace_ReplayRead(DS1307_TraceRecord_t *Record, uint8_t *Payload)
+{
+  if (!NextValid)
+    return DS1307_FAIL;
+
+  *Record = NextRecord;
+  memcpy(Payload, NextPayload, NextRecord.Len);
+  ReplayTime = NextRecord.Timestamp;
+  DS1307_Trace_ReplayAdvance();
+  return DS1307_OK;
+}
+
+static int8_t
+DS1307_Trace_ReplaySend(uint8_t Address, uint8_t *Data, uint8_t Len)
+{
+  DS1307_TraceRecord_t Record;
+  uint8_t Payload[255];
+
+  if (DS1307_Trace_ReplayRead(&Record, Payload) != DS1307_OK)
+    return -1;
+
+  if (Record.Flags != 0 ||
+      Record.Address != Address || Record.Len != Len ||
+      memcmp(Payload, Data, Len) != 0)
+    Mismatches++;
+
+  return Record.Result;
+}
+
+static int8_t
+DS1307_Trace_ReplayReceive(uint8_t Address, uint8_t *Data, uint8_t Len)
+{
+  DS1307_TraceRecord_t Record;
+  uint8_t Payload[255];
+
+  if (DS1307_Trace_ReplayRead(&Record, Payload) != DS1307_OK)
+    return -1;
+
+  if (Record.Flags != DS1307_TRACE_RECEIVE ||
+      Record.Address != Address || Record.Len != Len)
+    Mismatches++;
+
+  memcpy(Data, Payload, (Record.Len < Len) ? Record.Len : Len);
+  return Record.Result;
+}
+
+static int8_t
+DS1307_Trace_ReplayWriteRead(uint8_t Address, uint8_t *TxData, uint8_t TxLen,
+                             uint8_t *RxData, uint8_t RxLen)
+{
+  DS1307_TraceRecord_t Record;
+  uint8_t Payload[255];
+
+  if (DS1307_Trace_ReplayRead(&Record, Payload) != DS1307_OK)
+    return -1;
+
+  if (Record.Flags != DS1307_TRACE_WRITEREAD ||
+      Record.Address != Address || Record.Len != 1 + TxLen + RxLen ||
+      Payload[0] != TxLen || memcmp(&Payload[1], TxData, TxLen) != 0)
+  {
+    Mismatches++;
+    return Record.Result;
+  }
+
+  memcpy(RxData, &Payload[1 + TxLen], RxLen);
+  return Record.Result;
+}
+
+static int8_t
+DS1307_Trace_ReplaySelect(void *Context)
+{
+  DS1307_TraceRecord_t Record;
+  uint8_t Payload[255];
+
+  (void)Context;
+  if (DS1307_Trace_ReplayRead(&Record, Payload) != DS1307_OK)
+    return -1;
+
+  if (Record.Flags != DS1307_TRACE_SELECT)
+    Mismatches++;
+
+  return Record.Result;
+}
+
+static void
+DS1307_Trace_Save(DS1307_Handler_t *Handler)
+{
+  OrigInit = Handler->PlatformInit;
+  OrigDeInit = Handler->PlatformDeInit;
+  OrigRecover = Handler->PlatformRecover;
+  OrigSend = Handler->PlatformSend;
+  OrigReceive = Handler->PlatformReceive;
+  OrigWriteRead = Handler->PlatformWriteRead;
+  OrigSelect = Handler->PlatformSelect;
+  OrigDelay = Handler->PlatformDelay;
+  OrigGetTimeUs = Handler->PlatformGetTimeUs;
+  Mismatches = 0;
+  Active = 1;
+}
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####                           
+ ==================================================================================
+ */
+
+/**
+ * @brief  Start recording transactions of a handler
+ * @note   Only one trace session can be active at a time. Call it after the
+ *         platform-dependent part of handler is initialized (and after
+ *         DS1307_Mux_Attach, if used). Send, Receive, WriteRead and Select
+ *         calls are recorded.
+ * @param  Handler: Pointer to handler
+ * @param  Write: Trace sink
+ * @param  GetTimeUs: Timestamp source (NULL to record zeros)
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to write trace header or a session is active.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_Trace_StartRecord(DS1307_Handler_t *Handler, DS1307_TraceWrite_t Write,
+                         DS1307_TraceTime_t GetTimeUs)
+{
+  const uint8_t Magic[4] = {'D', '1', 'T', DS1307_TRACE_VERSION};
+
+  if (!Handler || !Write || !Handler->PlatformSend || !Handler->PlatformReceive)
+    return DS1307_INVALID_PARAM;
+
+  if (Active || Write(Magic, sizeof(Magic)) < 0)
+    return DS1307_FAIL;
+
+  DS1307_Trace_Save(Handler);
+  TraceWrite = Write;
+  TraceTime = GetTimeUs;
+  Handler->PlatformSend = DS1307_Trace_RecordSend;
+  Handler->PlatformReceive = DS1307_Trace_RecordReceive;
+  if (Handler->PlatformWriteRead)
+    Handler->PlatformWriteRead = DS1307_Trace_RecordWriteRead;
+  if (Handler->PlatformSelect)
+    Handler->PlatformSelect = DS1307_Trace_RecordSelect;
+
+  return DS1307_OK;
+}
+
+
+/**
+ * @brief  Replace the platform of a handler with a recorded trace
+ * @note   Sent data is compared with the trace; differences are counted by
+ *         DS1307_Trace_Mismatches. Recorded results are returned as is.
+ *         PlatformWriteRead and PlatformSelect are replayed only if the
+ *         handler has them, so it must be set up like the recorded one.
+ *         PlatformGetTimeUs (if set) returns the recorded time of the next
+ *         transfer and PlatformDelay (if set) returns at once, so timeouts
+ *         and retry budgets see the recorded timing.
+ *         Version 1 traces (no WriteRead and Select records) are accepted.
+ * @param  Handler: Pointer to handler
+ * @param  Read: Trace source
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Invalid trace header or a session is active.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_Trace_StartReplay(DS1307_Handler_t *Handler, DS1307_TraceRead_t Read)
+{
+  uint8_t Magic[4];
+
+  if (!Handler || !Read)
+    return DS1307_INVALID_PARAM;
+
+  if (Active || Read(Magic, sizeof(Magic)) < 0 ||
+      memcmp(Magic, DS1307_TRACE_MAGIC, 3) != 0 ||
+      Magic[3] == 0 || Magic[3] > DS1307_TRACE_VERSION)
+    return DS1307_FAIL;
+
+  DS1307_Trace_Save(Handler);
+  TraceRead = Read;
+  ReplayTime = 0;
+  DS1307_Trace_ReplayAdvance();
+  Handler->PlatformInit = DS1307_Trace_ReplayInitDeInit;
+  Handler->PlatformDeInit = DS1307_Trace_ReplayInitDeInit;
+  Handler->PlatformRecover = Handler->PlatformRecover ? DS1307_Trace_ReplayInitDeInit : NULL;
+  Handler->PlatformSend = DS1307_Trace_ReplaySend;
+  Handler->PlatformReceive = DS1307_Trace_ReplayReceive;
+  if (Handler->PlatformWriteRead)
+    Handler->PlatformWriteRead = DS1307_Trace_ReplayWriteRead;
+  if (Handler->PlatformSelect)
+    Handler->PlatformSelect = DS1307_Trace_ReplaySelect;
+  if (Handler->PlatformDelay)
+    Handler->PlatformDelay = DS1307_Trace_ReplayDelay;
+  if (Handler->PlatformGetTimeUs)
+    Handler->PlatformGetTimeUs = DS1307_Trace_ReplayGetTimeUs;
+
+  return DS1307_OK;
+}
+
+
+/**
+ * @brief  Stop trace session and restore original platform functions
+ * @param  Handler: Pointer to handler
+ * @retval None
+ */
+void
+DS1307_Trace_Stop(DS1307_Handler_t *Handler)
+{
+  if (!Active)
+    return;
+
+  Handler->PlatformInit = OrigInit;
+  Handler->PlatformDeInit = OrigDeInit;
+  Handler->PlatformRecover = OrigRecover;
+  Handler->PlatformSend = OrigSend;
+  Handler->PlatformReceive = OrigReceive;
+  Handler->PlatformWriteRead = OrigWriteRead;
+  Handler->PlatformSelect = OrigSelect;
+  Handler->PlatformDelay = OrigDelay;
+  Handler->PlatformGetTimeUs = OrigGetTimeUs;
+  Active = 0;
+}
+
+
+/**
+ * @brief  Number of replayed transactions that differ from the trace
+ * @retval Number of mismatches
+ */
+uint32_t
+DS1307_Trace_Mismatches(void)
+{
+  return Mismatches;
+}
+
+
+/**
+ * @brief  Read next record of a trace (for trace analysis tools)
+ * @param  Read: Trace source (positioned after the trace magic)
+ * @param  Record: Pointer to record header
+ * @param  Payload: Buffer of 255 bytes for payload
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: End of trace.
+ */
+DS1307_Result_t
+DS1307_Trace_ReadRecord(DS1307_TraceRead_t Read, DS1307_TraceRecord_t *Record,
+                        uint8_t *Payload)
+{
+  uint8_t Header[DS1307_TRACE_HEADER_SIZE];
+
+  if (Read(Header, sizeof(Header)) < 0)
+    return DS1307_FAIL;
+
+  Record->Flags = Header[0];
+  Record->Address = Header[1];
+  Record->Result = (int8_t)Header[2];
+  Record->Len = Header[3];
+  Record->Timestamp = (uint32_t)Header[4] | ((uint32_t)Header[5] << 8) |
+                      ((uint32_t)Header[6] << 16) | ((uint32_t)Header[7] << 24);
+
+  if (Record->Len && Read(Payload, Record->Len) < 0)
+    return DS1307_FAIL;
+
+  return DS1307_OK;
+}
@@ -7,6 +7,7 @@
  *          + Get and Set date and time
  *          + Read and Write non-volatile embedded RAM of DS1307 chip
  *          + Control squarewave output signal
+ *          + Convert date and time to/from Unix time
  **********************************************************************************
  *
  * Copyright (c) 2021 Hossein.M (MIT License)
@@ -45,6 +46,14 @@ extern "C" {
 #include <stdint.h>
 
 
+/* Exported Constants -----------------------------------------------------------*/
+
+/**
+ * @brief  Size of the Non-volatile RAM in bytes
+ */
+#define DS1307_RAM_SIZE   56
+
+
 /* Exported Data Types ----------------------------------------------------------*/
 
 /**
@@ -55,6 +64,8 @@ typedef enum DS1307_Result_e
   DS1307_OK             = 0,
   DS1307_FAIL           = 1,
   DS1307_INVALID_PARAM  = 2,
+  DS1307_BUS_BUSY       = 3,
+  DS1307_NACK           = 4,
 } DS1307_Result_t;
 
 /**
@@ -79,9 +90,64 @@ typedef int8_t (*DS1307_PlatformInitDeinit_t)(void);
 typedef int8_t (*DS1307_PlatformSendReceive_t)(uint8_t Address,
                                                 uint8_t *Data, uint8_t Len);
 
+/**
+ * @brief  Function type for writing then reading the slave in one transfer
+ *         (repeated START between the two parts, no STOP).
+ * @param  Address: Address of slave (0 <= Address <= 127)
+ * @param  TxData: Pointer to data to write
+ * @param  TxLen: write len in Bytes
+ * @param  RxData: Pointer to read data
+ * @param  RxLen: read len in Bytes
+ * @retval Same as DS1307_PlatformSendReceive_t.
+ */
+typedef int8_t (*DS1307_PlatformWriteRead_t)(uint8_t Address,
+                                              uint8_t *TxData, uint8_t TxLen,
+                                              uint8_t *RxData, uint8_t RxLen);
+
+/**
+ * @brief  Function type for delay in microseconds.
+ * @param  Us: Delay in microseconds
+ */
+typedef void (*DS1307_PlatformDelay_t)(uint32_t Us);
+
+/**
+ * @brief  Function type for getting a free running time in microseconds.
+ */
+typedef uint32_t (*DS1307_PlatformGetTime_t)(void);
+
+/**
+ * @brief  Function type for selecting the DS1307 before a transfer (e.g. I2C
+ *         mux channel).
+ * @param  Context: PlatformContext of handler
+ * @retval 
+ *         -  0: The operation was successful.
+ *         - <0: Same as DS1307_PlatformSendReceive_t.
+ */
+typedef int8_t (*DS1307_PlatformSelect_t)(void *Context);
+
+/**
+ * @brief  Retry policy of bus transfers
+ * @note   All zero disables retries. Backoff delays need PlatformDelay and the
+ *         deadline needs PlatformGetTimeUs.
+ * @note   The deadline is checked between attempts, it does not cut a
+ *         transfer short. A call can take DeadlineUs plus one transfer
+ *         timeout of the port (DS1307_TIMEOUT: 1000 ms on ESP32-IDF, 100 ms
+ *         on STM32-HAL), so set that below the deadline when it matters.
+ */
+typedef struct DS1307_Retry_s
+{
+  uint8_t   MaxRetries;   // Retries after a failed transfer
+  uint16_t  BackoffUs;    // Delay before the first retry, doubled on each retry
+  uint16_t  BackoffMaxUs; // Upper bound of backoff delay (0: no bound)
+  uint32_t  DeadlineUs;   // Time budget of a transfer including retries (0: none)
+} DS1307_Retry_t;
+
 /**
  * @brief  Handler
  * @note   This handler must be initialize before using library functions
+ * @note   Reset the handler with DS1307_Handler_Init (DS1307_Platform_Init of
+ *         the ports does it) or zero-initialize it. Optional fields are used
+ *         when not NULL.
  */
 typedef struct DS1307_Handler_s
 {
@@ -93,6 +159,37 @@ typedef struct DS1307_Handler_s
   DS1307_PlatformSendReceive_t PlatformSend;
   // Receive Data from the DS1307
   DS1307_PlatformSendReceive_t PlatformReceive;
+  // Register read as one repeated START transfer (optional, used instead of
+  // PlatformSend and PlatformReceive for reads)
+  DS1307_PlatformWriteRead_t PlatformWriteRead;
+  // Delay in microseconds (optional, used for retry backoff)
+  DS1307_PlatformDelay_t PlatformDelay;
+  // Free running time in microseconds (optional, used for retry deadline)
+  DS1307_PlatformGetTime_t PlatformGetTimeUs;
+  // Release a stuck bus and re-initialize the peripheral (optional)
+  DS1307_PlatformInitDeinit_t PlatformRecover;
+  // Select the DS1307 before each transfer (optional)
+  DS1307_PlatformSelect_t PlatformSelect;
+  // Context of PlatformSelect
+  void *PlatformContext;
+
+  // I2C address of the DS1307 (0: 0x68)
+  uint8_t Address;
+
+  // Non-volatile RAM range read together with date and time
+  uint8_t HotAddress;
+  uint8_t HotSize;
+
+  // Retry policy of bus transfers
+  DS1307_Retry_t Retry;
+
+  // Register shadow (managed by library functions)
+  uint8_t ShadowValid;
+  uint8_t ShadowControl;
+  uint8_t ShadowSecond;
+
+  // Consecutive failed transfers (managed by library functions)
+  uint8_t FailCount;
 } DS1307_Handler_t;
 
 /**
@@ -109,6 +206,23 @@ typedef struct DS1307_DateTime_s
   uint8_t   Year;
 } DS1307_DateTime_t;
 
+/**
+ * @brief  Date and time fields (for DS1307_GetFields)
+ */
+typedef enum DS1307_Field_e
+{
+  DS1307_Field_Second   = 0x01,
+  DS1307_Field_Minute   = 0x02,
+  DS1307_Field_Hour     = 0x04,
+  DS1307_Field_WeekDay  = 0x08,
+  DS1307_Field_Day      = 0x10,
+  DS1307_Field_Month    = 0x20,
+  DS1307_Field_Year     = 0x40,
+  DS1307_Field_Time     = 0x07, // hh:mm:ss
+  DS1307_Field_Date     = 0x70, // day, month and year
+  DS1307_Field_All      = 0x7F
+} DS1307_Field_t;
+
 /**
  * @brief  Run/Halt options of oscillator
  */
@@ -131,6 +245,32 @@ typedef enum DS1307_OutWave_e
   DS1307_OutWave_32KHz  = 5   // Output wave frequency = 32.768KHz
 } DS1307_OutWave_t;
 
+/**
+ * @brief  Result of DS1307_Probe
+ */
+typedef struct DS1307_Probe_s
+{
+  uint8_t           Present;      // DS1307 answered on the bus
+  uint8_t           Halted;       // CH bit is set (oscillator is stopped)
+  uint8_t           Invalid;      // DS1307_Field_t mask of fields with bad BCD or range
+  uint8_t           Control;      // raw CONTROL register
+  uint8_t           TimeRegs[7];  // raw SECOND to YEAR registers
+  uint8_t           ControlValid; // reserved bits of CONTROL are zero
+  DS1307_OutWave_t  OutWave;      // decoded CONTROL register
+  DS1307_DateTime_t DateTime;     // decoded date and time
+} DS1307_Probe_t;
+
+/**
+ * @brief  Result of DS1307_FindSecondEdge
+ */
+typedef struct DS1307_SecondEdge_s
+{
+  uint32_t          TimeUs;       // PlatformGetTimeUs at the middle of the window
+  uint32_t          WindowUs;     // the transition is within TimeUs +- WindowUs/2
+  uint16_t          Reads;        // bus reads consumed
+  DS1307_DateTime_t DateTime;     // date and time that started at the transition
+} DS1307_SecondEdge_t;
+
 
 /* Functionality Options --------------------------------------------------------*/
 /**
@@ -139,7 +279,54 @@ typedef enum DS1307_OutWave_e
  * @note   The DS1307_SEND_BUFFER_SIZE must be set larger than 1 (9 or more is
  *         suggested)
  */   
+#ifndef DS1307_SEND_BUFFER_SIZE
 #define DS1307_SEND_BUFFER_SIZE   9
+#endif
+
+/**
+ * @brief  Write elision
+ *         - 0: Every set function writes its registers unconditionally.
+ *         - 1: CONTROL register and CH bit are shadowed in the handler and
+ *              writes that would not change them are skipped. No extra bus
+ *              transfer is needed for that. The shadow goes stale when
+ *              anything else writes the chip (another handler or master, a
+ *              power loss without battery), call DS1307_InvalidateCache then.
+ */
+#ifndef DS1307_WRITE_ELISION
+#define DS1307_WRITE_ELISION      0
+#endif
+
+/**
+ * @brief  Date and time write elision
+ *         - 0: DS1307_SetDateTime writes all time registers, so SECOND is
+ *              always written and the countdown chain restarts.
+ *         - 1: DS1307_SetDateTime reads the time registers first and writes
+ *              only the contiguous range that differs (e.g. only HOUR for a
+ *              DST shift). This keeps the sub-second phase of the oscillator
+ *              but costs a 7-byte read on every call, and SECOND is not
+ *              written when it already holds the requested value.
+ */
+#ifndef DS1307_TIME_ELISION
+#define DS1307_TIME_ELISION       0
+#endif
+
+/**
+ * @brief  Bus recovery
+ *         Number of consecutive failed transfers after which PlatformRecover
+ *         is called automatically (0: never)
+ */
+#ifndef DS1307_RECOVER_AFTER
+#define DS1307_RECOVER_AFTER      3
+#endif
+
+/**
+ * @brief  Second edge search
+ *         Back-to-back reads of DS1307_FindSecondEdge start this many
+ *         microseconds before the transition predicted by the coarse search
+ */
+#ifndef DS1307_EDGE_GUARD_US
+#define DS1307_EDGE_GUARD_US      2000
+#endif
 
 
 
@@ -149,6 +336,19 @@ typedef enum DS1307_OutWave_e
  ==================================================================================
  */
 
+/**
+ * @brief  Reset all fields of handler to their defaults
+ * @note   Platform functions become NULL, Address 0 (DS1307_ADDRESS), no hot
+ *         RAM range, no retries and no register shadow. Use it instead of
+ *         zero initialization, then set the platform functions and options.
+ *         DS1307_Platform_Init of the ports calls it.
+ * @param  Handler: Pointer to handler
+ * @retval None
+ */
+void
+DS1307_Handler_Init(DS1307_Handler_t *Handler);
+
+
 /**
  * @brief  Initialize DS1307 
  * @param  Handler: Pointer to handler
@@ -161,6 +361,41 @@ DS1307_Result_t
 DS1307_Init(DS1307_Handler_t *Handler);
 
 
+/**
+ * @brief  Initialize DS1307 and probe its state in one transaction
+ * @note   Same as DS1307_Init followed by DS1307_Probe. Applications can check
+ *         Probe->Halted and Probe->Invalid instead of separate reads to find
+ *         out whether the clock lost power.
+ * @param  Handler: Pointer to handler
+ * @param  Probe: Pointer to probe result
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer (not present).
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_InitProbe(DS1307_Handler_t *Handler, DS1307_Probe_t *Probe);
+
+
+/**
+ * @brief  Read the whole state of DS1307 in one transaction
+ * @note   Registers 0x00 to 0x07 are read in one 8-byte burst. The CONTROL
+ *         and CH shadows of handler are seeded from the result.
+ * @param  Handler: Pointer to handler
+ * @param  Probe: Pointer to probe result
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer (not present).
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_Probe(DS1307_Handler_t *Handler, DS1307_Probe_t *Probe);
+
+
 /**
  * @brief  Uninitialize DS1307 
  * @param  Handler: Pointer to handler
@@ -172,6 +407,31 @@ DS1307_Result_t
 DS1307_DeInit(DS1307_Handler_t *Handler);
 
 
+/**
+ * @brief  Release a stuck bus (e.g. SDA held low by DS1307 after a reset in
+ *         the middle of a transfer) using PlatformRecover
+ * @param  Handler: Pointer to handler
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to release the bus.
+ *         - DS1307_INVALID_PARAM: Platform has no recovery function.
+ */
+DS1307_Result_t
+DS1307_RecoverBus(DS1307_Handler_t *Handler);
+
+
+/**
+ * @brief  Forget the register shadow of the handler
+ * @note   The next set functions write their registers unconditionally and
+ *         refresh the shadow. Needed with DS1307_WRITE_ELISION when the chip
+ *         may have been written through another path.
+ * @param  Handler: Pointer to handler
+ * @retval None
+ */
+void
+DS1307_InvalidateCache(DS1307_Handler_t *Handler);
+
+
 
 /**
  ==================================================================================
@@ -182,6 +442,7 @@ DS1307_DeInit(DS1307_Handler_t *Handler);
 /**
  * @brief  Set date and time on DS1307 real time chip and Run/Halt option of
  *         oscillator
+ * @note   Time registers are written as described for DS1307_SetDateTime.
  * 
  * @param  Handler: Pointer to handler
  * @param  DateTime: Pointer to date and time value structure. If NULL, the 
@@ -190,6 +451,8 @@ DS1307_DeInit(DS1307_Handler_t *Handler);
  * @retval DS1307_Result_t
  *         - DS1307_OK: Operation was successful.
  *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
  *         - DS1307_INVALID_PARAM: One of parameters is invalid.
  */
 DS1307_Result_t
@@ -199,17 +462,45 @@ DS1307_SetDateTimeRunHalt(DS1307_Handler_t *Handler, DS1307_DateTime_t *DateTime
 /**
  * @brief  Set date and time on DS1307 real time chip
  * @note   This function sets the oscillator to run state.
+ * @note   With DS1307_TIME_ELISION 0 (default) all time registers are written
+ *         in one transfer. Writing SECOND restarts the countdown chain, so
+ *         the next seconds transition comes 1 s after this call. With
+ *         DS1307_TIME_ELISION 1 only the registers that differ from the chip
+ *         are written and the chain is restarted only if SECOND changes; use
+ *         DS1307_SetDateTimeAligned when the restart is needed.
  * @param  Handler: Pointer to handler
  * @param  DateTime: Pointer to date and time value structure
  * @retval DS1307_Result_t
  *         - DS1307_OK: Operation was successful.
  *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
  *         - DS1307_INVALID_PARAM: One of parameters is invalid.
  */
 DS1307_Result_t
 DS1307_SetDateTime(DS1307_Handler_t *Handler, DS1307_DateTime_t *DateTime);
 
 
+/**
+ * @brief  Write date and time in a single transfer, even if unchanged
+ * @note   Writing SECOND restarts the countdown chain, so the next seconds
+ *         transition comes 1 s after this transfer. Call it at a whole second
+ *         of the reference clock to align the DS1307 with it. The oscillator
+ *         is set to run state. Same as DS1307_SetDateTime when
+ *         DS1307_TIME_ELISION is 0.
+ * @param  Handler: Pointer to handler
+ * @param  DateTime: Pointer to date and time value structure
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_SetDateTimeAligned(DS1307_Handler_t *Handler, DS1307_DateTime_t *DateTime);
+
+
 /**
  * @brief  Get date and time from DS1307 real time chip
  * @param  Handler: Pointer to handler
@@ -217,11 +508,33 @@ DS1307_SetDateTime(DS1307_Handler_t *Handler, DS1307_DateTime_t *DateTime);
  * @retval DS1307_Result_t
  *         - DS1307_OK: Operation was successful.
  *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
  */
 DS1307_Result_t
 DS1307_GetDateTime(DS1307_Handler_t *Handler, DS1307_DateTime_t *DateTime);
 
 
+/**
+ * @brief  Get some fields of date and time from DS1307 real time chip
+ * @note   Only the contiguous register window that covers the requested fields
+ *         is read (e.g. 1 byte for DS1307_Field_Second) and only requested
+ *         fields are decoded. Other fields of DateTime are left untouched.
+ * @param  Handler: Pointer to handler
+ * @param  Fields: Bitwise OR of DS1307_Field_t values
+ * @param  DateTime: pointer to date and time value structure
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_GetFields(DS1307_Handler_t *Handler, uint8_t Fields,
+                 DS1307_DateTime_t *DateTime);
+
+
 /**
  * @brief  Get Run/Halt status of DS1307 oscillator
  * @param  Handler: Pointer to handler
@@ -229,12 +542,78 @@ DS1307_GetDateTime(DS1307_Handler_t *Handler, DS1307_DateTime_t *DateTime);
  * @retval DS1307_Result_t
  *         - DS1307_OK: Operation was successful.
  *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
  *         - DS1307_INVALID_PARAM: One of parameters is invalid.
  */
 DS1307_Result_t
 DS1307_GetRunHalt(DS1307_Handler_t *Handler, DS1307_RunHalt_t *RunHalt);
 
 
+/**
+ * @brief  Wait for the next seconds transition of DS1307
+ * @note   Only the SECOND register is polled (1 byte per poll), so this function
+ *         returns as soon as possible after the transition.
+ * @param  Handler: Pointer to handler
+ * @param  MaxPolls: Maximum number of polls before giving up (0 = no limit)
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data, the oscillator is
+ *                        halted or no transition was seen in MaxPolls polls.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
+ */
+DS1307_Result_t
+DS1307_WaitSecondEdge(DS1307_Handler_t *Handler, uint16_t MaxPolls);
+
+
+/**
+ * @brief  Wait for the next seconds transition of DS1307 with a time limit
+ * @note   Same as DS1307_WaitSecondEdge, but the limit does not depend on the
+ *         bus speed. PlatformGetTimeUs is required.
+ * @param  Handler: Pointer to handler
+ * @param  TimeoutUs: Time limit in microseconds (more than 1 s to see an edge
+ *                    in all cases)
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data, the oscillator is
+ *                        halted or no transition was seen in TimeoutUs.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
+ *         - DS1307_INVALID_PARAM: PlatformGetTimeUs is not set or TimeoutUs
+ *                                 is 0.
+ */
+DS1307_Result_t
+DS1307_WaitSecondEdgeUs(DS1307_Handler_t *Handler, uint32_t TimeoutUs);
+
+
+/**
+ * @brief  Find the next seconds transition and timestamp it
+ * @note   SECOND is polled with 1-byte reads (a single repeated START transfer
+ *         when PlatformWriteRead is set). The transition lies between the
+ *         start of the last read that saw the old second and the end of the
+ *         first read that saw the new one; Edge->TimeUs is the middle of this
+ *         window. With PollUs != 0 the coarse edge found at that cadence is
+ *         refined one second later by back-to-back reads started
+ *         DS1307_EDGE_GUARD_US before the predicted transition.
+ * @param  Handler: Pointer to handler (PlatformGetTimeUs is required,
+ *                  PlatformDelay too if PollUs != 0)
+ * @param  PollUs: Delay between reads of the coarse search (0 = back-to-back)
+ * @param  MaxReads: Maximum number of reads before giving up (0 = no limit)
+ * @param  Edge: Pointer to result
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data, the oscillator is
+ *                        halted or no transition was seen in MaxReads reads.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_FindSecondEdge(DS1307_Handler_t *Handler, uint32_t PollUs,
+                      uint16_t MaxReads, DS1307_SecondEdge_t *Edge);
+
+
 /**
  ==================================================================================
                            ##### Memory Functions #####                            
@@ -246,10 +625,12 @@ DS1307_GetRunHalt(DS1307_Handler_t *Handler, DS1307_RunHalt_t *RunHalt);
  * @param  Handler: Pointer to handler
  * @param  Address: address of block beginning (0 to 55)
  * @param  Data: pointer to data array
- * @param  Size: data size (1 to 56)
+ * @param  Size: data size (0 to 56, 0 does nothing)
  * @retval DS1307_Result_t
  *         - DS1307_OK: Operation was successful.
  *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
  *         - DS1307_INVALID_PARAM: Requested area is out of range.
  */
 DS1307_Result_t
@@ -262,10 +643,12 @@ DS1307_WriteRAM(DS1307_Handler_t *Handler,
  * @param  Handler: Pointer to handler
  * @param  Address: address of block beginning (0 to 55)
  * @param  Data: pointer to data array
- * @param  Size: data size (1 to 56)
+ * @param  Size: data size (0 to 56, 0 does nothing)
  * @retval DS1307_Result_t
  *         - DS1307_OK: Operation was successful.
  *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
  *         - DS1307_INVALID_PARAM: Requested area is out of range.
  */
 DS1307_Result_t
@@ -273,6 +656,79 @@ DS1307_ReadRAM(DS1307_Handler_t *Handler,
                uint8_t Address, uint8_t *Data, uint8_t Size);
 
 
+/**
+ * @brief  Set the hot Non-volatile RAM range of handler
+ * @note   The hot range is fetched in the same burst as date and time by
+ *         DS1307_GetDateTimeAndRAM. The burst also carries CONTROL and the
+ *         RAM bytes before Address, so hot ranges near 0 are cheapest.
+ * @param  Handler: Pointer to handler
+ * @param  Address: address of range beginning (0 to 55)
+ * @param  Size: range size (0 to 56, 0 disables the hot range)
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_INVALID_PARAM: Requested area is out of range.
+ */
+DS1307_Result_t
+DS1307_SetHotRAM(DS1307_Handler_t *Handler, uint8_t Address, uint8_t Size);
+
+
+/**
+ * @brief  Get date and time and the hot Non-volatile RAM range in one transaction
+ * @param  Handler: Pointer to handler
+ * @param  DateTime: pointer to date and time value structure
+ * @param  Data: pointer to data array of HotSize bytes (may be NULL if HotSize is 0)
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid or the hot
+ *                                 range of handler is out of RAM.
+ */
+DS1307_Result_t
+DS1307_GetDateTimeAndRAM(DS1307_Handler_t *Handler,
+                         DS1307_DateTime_t *DateTime, uint8_t *Data);
+
+
+/**
+ * @brief  Write date and time, output wave and the whole Non-volatile RAM
+ *         (the 64-byte register image) in a single burst
+ * @note   One transfer needs DS1307_SEND_BUFFER_SIZE >= 65, smaller buffers
+ *         split the image. The oscillator is set to run state and the
+ *         countdown chain restarts as with DS1307_SetDateTimeAligned.
+ * @param  Handler: Pointer to handler
+ * @param  DateTime: Pointer to date and time value structure
+ * @param  OutWave: Output wave state
+ * @param  Ram: Pointer to the 56 bytes of Non-volatile RAM
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_WriteImage(DS1307_Handler_t *Handler, DS1307_DateTime_t *DateTime,
+                  DS1307_OutWave_t OutWave, const uint8_t *Ram);
+
+
+/**
+ * @brief  Read the 64-byte register image in a single burst
+ * @note   Date, time and CONTROL are decoded as by DS1307_Probe.
+ * @param  Handler: Pointer to handler
+ * @param  Probe: Pointer to decoded date, time and CONTROL
+ * @param  Ram: Pointer to the 56 bytes of Non-volatile RAM
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_ReadImage(DS1307_Handler_t *Handler, DS1307_Probe_t *Probe, uint8_t *Ram);
+
+
 
 /**
  ==================================================================================
@@ -294,6 +750,8 @@ DS1307_ReadRAM(DS1307_Handler_t *Handler,
  * @retval DS1307_Result_t
  *         - DS1307_OK: Operation was successful.
  *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
  *         - DS1307_INVALID_PARAM: One of parameters is invalid.
  */
 DS1307_Result_t
@@ -301,6 +759,39 @@ DS1307_SetOutWave(DS1307_Handler_t *Handler, DS1307_OutWave_t OutWave);
 
 
 
+/**
+ ==================================================================================
+                         ##### Conversion Functions #####                          
+ ==================================================================================
+ */
+
+/**
+ * @brief  Convert date and time to Unix time
+ * @note   Year 0 to 99 of DS1307 is interpreted as 2000 to 2099.
+ * @param  DateTime: Pointer to date and time value structure
+ * @param  Unix: Pointer to Unix time (seconds since 1970-01-01 00:00:00)
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_DateTimeToUnix(const DS1307_DateTime_t *DateTime, uint32_t *Unix);
+
+
+/**
+ * @brief  Convert Unix time to date and time
+ * @note   WeekDay is filled as 1 = Monday ... 7 = Sunday.
+ * @param  Unix: Unix time (2000-01-01 00:00:00 to 2099-12-31 23:59:59)
+ * @param  DateTime: Pointer to date and time value structure
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_UnixToDateTime(uint32_t Unix, DS1307_DateTime_t *DateTime);
+
+
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,356 @@
+/**
+ **********************************************************************************
+ * @file   DS1307.hpp
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  DS1307 chip driver (header-only C++17 interface)
+ *         Functionalities of the this file:
+ *          + Get and Set date and time
+ *          + Read and Write non-volatile embedded RAM of DS1307 chip
+ *          + Control squarewave output signal
+ *          + Bus operations resolved at compile time through a BusPolicy
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _DS1307_HPP_
+#define _DS1307_HPP_
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "DS1307.h"
+
+#if __cplusplus >= 202002L && defined(__has_include)
+#if __has_include(<span>)
+#include <span>
+#define DS1307_HAS_STD_SPAN 1
+#endif
+#endif
+
+
+namespace ds1307
+{
+
+/* Exported Data Types ----------------------------------------------------------*/
+
+#if defined(DS1307_HAS_STD_SPAN)
+template <class T>
+using span = std::span<T>;
+#else
+/**
+ * @brief  Minimal replacement of std::span for C++17
+ */
+template <class T>
+class span
+{
+public:
+  constexpr span() noexcept : Data_(nullptr), Size_(0) {}
+  constexpr span(T *Data, std::size_t Size) noexcept : Data_(Data), Size_(Size) {}
+  template <std::size_t N>
+  constexpr span(T (&Array)[N]) noexcept : Data_(Array), Size_(N) {}
+  template <class U>
+  constexpr span(const span<U> &Other) noexcept
+    : Data_(Other.data()), Size_(Other.size()) {}
+
+  constexpr T *data() const noexcept { return Data_; }
+  constexpr std::size_t size() const noexcept { return Size_; }
+  constexpr T &operator[](std::size_t Index) const noexcept { return Data_[Index]; }
+
+private:
+  T *Data_;
+  std::size_t Size_;
+};
+#endif
+
+/**
+ * @brief  BusPolicy requirements
+ *         A BusPolicy is a (preferably empty) class with these members:
+ *         - int8_t send(uint8_t Address, const uint8_t *Data, uint8_t Len)
+ *         - int8_t receive(uint8_t Address, uint8_t *Data, uint8_t Len)
+ *         Return values follow DS1307_PlatformSendReceive_t and are mapped
+ *         to DS1307_BUS_BUSY, DS1307_NACK or DS1307_FAIL like in the C API.
+ *         Calls are resolved at compile time, so the transport can be inlined.
+ */
+
+
+/* Private Constants ------------------------------------------------------------*/
+namespace detail
+{
+constexpr uint8_t Address   = 0x68; // the DS1307 address on I2C bus
+constexpr uint8_t Second    = 0x00; // the address of SECOND register
+constexpr uint8_t Control   = 0x07; // the address of CONTROL register
+constexpr uint8_t Ram       = 0x08; // the address of first byte of NVRAM
+constexpr uint8_t RamSize   = 56;   // size of NVRAM
+constexpr uint8_t RegsSize  = 0x40; // size of whole register file
+
+/**
+ * @brief  Result of a platform transfer (see DS1307_PlatformSendReceive_t)
+ */
+constexpr DS1307_Result_t
+BusResult(int8_t Err) noexcept
+{
+  return (Err >= 0) ? DS1307_OK :
+         (Err == -2) ? DS1307_BUS_BUSY :
+         (Err == -3) ? DS1307_NACK : DS1307_FAIL;
+}
+} // namespace detail
+
+
+
+/**
+ ==================================================================================
+                         ##### Conversion Functions #####                          
+ ==================================================================================
+ */
+
+constexpr uint8_t
+DECtoBCD(uint8_t DEC) noexcept
+{
+  return static_cast<uint8_t>((((DEC / 10) % 10) << 4) | (DEC % 10));
+}
+
+constexpr uint8_t
+BCDtoDEC(uint8_t BCD) noexcept
+{
+  return static_cast<uint8_t>((BCD >> 4) * 10 + (BCD & 0x0f));
+}
+
+constexpr bool
+IsValid(const DS1307_DateTime_t &DateTime) noexcept
+{
+  return DateTime.Second <= 59 &&
+         DateTime.Minute <= 59 &&
+         DateTime.Hour <= 23 &&
+         DateTime.WeekDay >= 1 && DateTime.WeekDay <= 7 &&
+         DateTime.Day >= 1 && DateTime.Day <= 31 &&
+         DateTime.Month >= 1 && DateTime.Month <= 12 &&
+         DateTime.Year <= 99;
+}
+
+/**
+ * @brief  CONTROL register value of OutWave, or -1 if OutWave is invalid
+ */
+constexpr int16_t
+ControlReg(DS1307_OutWave_t OutWave) noexcept
+{
+  switch (OutWave)
+  {
+  case DS1307_OutWave_Low:   return 0x00;
+  case DS1307_OutWave_High:  return 0x80;
+  case DS1307_OutWave_1Hz:   return 0x10;
+  case DS1307_OutWave_4KHz:  return 0x11;
+  case DS1307_OutWave_8KHz:  return 0x12;
+  case DS1307_OutWave_32KHz: return 0x13;
+  default:                   return -1;
+  }
+}
+
+static_assert(DECtoBCD(59) == 0x59 && BCDtoDEC(0x59) == 59, "BCD conversion");
+
+
+
+/**
+ ==================================================================================
+                                ##### Driver #####                                 
+ ==================================================================================
+ */
+
+template <class BusPolicy>
+class Driver : private BusPolicy
+{
+public:
+  constexpr Driver() = default;
+  constexpr explicit Driver(const BusPolicy &Bus) : BusPolicy(Bus) {}
+
+  /**
+   * @brief  Set date and time and Run/Halt option of oscillator
+   * @see    DS1307_SetDateTimeRunHalt
+   */
+  DS1307_Result_t
+  SetDateTime(const DS1307_DateTime_t &DateTime,
+              DS1307_RunHalt_t RunHalt = DS1307_RunHalt_Run)
+  {
+    if (!IsValid(DateTime))
+      return DS1307_INVALID_PARAM;
+
+    const uint8_t Buffer[8] = {
+      detail::Second,
+      static_cast<uint8_t>(DECtoBCD(DateTime.Second) |
+                           (RunHalt == DS1307_RunHalt_Halt ? 0x80 : 0x00)),
+      DECtoBCD(DateTime.Minute),
+      DECtoBCD(DateTime.Hour),
+      DECtoBCD(DateTime.WeekDay),
+      DECtoBCD(DateTime.Day),
+      DECtoBCD(DateTime.Month),
+      DECtoBCD(DateTime.Year),
+    };
+
+    return Send(Buffer, sizeof(Buffer));
+  }
+
+  /**
+   * @brief  Set Run/Halt option of oscillator only
+   */
+  DS1307_Result_t
+  SetRunHalt(DS1307_RunHalt_t RunHalt)
+  {
+    uint8_t Buffer[2] = {detail::Second, 0};
+    DS1307_Result_t Result = ReadRegs(detail::Second, &Buffer[1], 1);
+
+    if (Result != DS1307_OK)
+      return Result;
+
+    if (RunHalt == DS1307_RunHalt_Halt)
+      Buffer[1] |= 0x80;
+    else
+      Buffer[1] &= 0x7F;
+
+    return Send(Buffer, sizeof(Buffer));
+  }
+
+  /**
+   * @brief  Get date and time
+   * @see    DS1307_GetDateTime
+   */
+  DS1307_Result_t
+  GetDateTime(DS1307_DateTime_t &DateTime)
+  {
+    uint8_t Buffer[7];
+    DS1307_Result_t Result = ReadRegs(detail::Second, Buffer, sizeof(Buffer));
+
+    if (Result != DS1307_OK)
+      return Result;
+
+    DateTime.Second  = BCDtoDEC(Buffer[0] & 0x7F);
+    DateTime.Minute  = BCDtoDEC(Buffer[1]);
+    DateTime.Hour    = BCDtoDEC(Buffer[2]);
+    DateTime.WeekDay = BCDtoDEC(Buffer[3]);
+    DateTime.Day     = BCDtoDEC(Buffer[4]);
+    DateTime.Month   = BCDtoDEC(Buffer[5]);
+    DateTime.Year    = BCDtoDEC(Buffer[6]);
+    return DS1307_OK;
+  }
+
+  /**
+   * @brief  Get Run/Halt status of oscillator
+   * @see    DS1307_GetRunHalt
+   */
+  DS1307_Result_t
+  GetRunHalt(DS1307_RunHalt_t &RunHalt)
+  {
+    uint8_t Seconds = 0;
+    DS1307_Result_t Result = ReadRegs(detail::Second, &Seconds, 1);
+
+    if (Result != DS1307_OK)
+      return Result;
+
+    RunHalt = (Seconds & 0x80) ? DS1307_RunHalt_Halt : DS1307_RunHalt_Run;
+    return DS1307_OK;
+  }
+
+  /**
+   * @brief  Write data on Non-volatile RAM
+   * @note   The whole block is sent in one transaction.
+   * @see    DS1307_WriteRAM
+   */
+  DS1307_Result_t
+  WriteRAM(uint8_t Address, span<const uint8_t> Data)
+  {
+    uint8_t Buffer[detail::RamSize + 1];
+
+    if (!Data.size())
+      return DS1307_OK;
+    if (!RamRangeValid(Address, Data.size()))
+      return DS1307_INVALID_PARAM;
+
+    Buffer[0] = static_cast<uint8_t>(detail::Ram + Address);
+    std::memcpy(Buffer + 1, Data.data(), Data.size());
+    return Send(Buffer, static_cast<uint8_t>(Data.size() + 1));
+  }
+
+  /**
+   * @brief  Read data from Non-volatile RAM
+   * @see    DS1307_ReadRAM
+   */
+  DS1307_Result_t
+  ReadRAM(uint8_t Address, span<uint8_t> Data)
+  {
+    if (!Data.size())
+      return DS1307_OK;
+    if (!RamRangeValid(Address, Data.size()))
+      return DS1307_INVALID_PARAM;
+
+    return ReadRegs(static_cast<uint8_t>(detail::Ram + Address),
+                    Data.data(), static_cast<uint8_t>(Data.size()));
+  }
+
+  /**
+   * @brief  Set output Wave on SQW/Out pin
+   * @see    DS1307_SetOutWave
+   */
+  DS1307_Result_t
+  SetOutWave(DS1307_OutWave_t OutWave)
+  {
+    const int16_t Control = ControlReg(OutWave);
+
+    if (Control < 0)
+      return DS1307_INVALID_PARAM;
+
+    const uint8_t Buffer[2] = {detail::Control, static_cast<uint8_t>(Control)};
+    return Send(Buffer, sizeof(Buffer));
+  }
+
+private:
+  static constexpr bool
+  RamRangeValid(uint8_t Address, std::size_t Size) noexcept
+  {
+    return Size != 0 && Address < detail::RamSize &&
+           Size <= static_cast<std::size_t>(detail::RamSize - Address);
+  }
+
+  DS1307_Result_t
+  Send(const uint8_t *Data, uint8_t Len)
+  {
+    return detail::BusResult(BusPolicy::send(detail::Address, Data, Len));
+  }
+
+  DS1307_Result_t
+  ReadRegs(uint8_t StartReg, uint8_t *Data, uint8_t Len)
+  {
+    int8_t Err = BusPolicy::send(detail::Address, &StartReg, 1);
+
+    if (Err >= 0)
+      Err = BusPolicy::receive(detail::Address, Data, Len);
+
+    return detail::BusResult(Err);
+  }
+};
+
+} // namespace ds1307
+
+
+#endif //! _DS1307_HPP_
@@ -0,0 +1,227 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_chrono.hpp
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  std::chrono clock adapter for DS1307
+ *         Functionalities of the this file:
+ *          + Clock (named requirement) backed by DS1307 Unix time
+ *          + Cached reading extrapolated with std::chrono::steady_clock
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _DS1307_CHRONO_HPP_
+#define _DS1307_CHRONO_HPP_
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <chrono>
+#include <ctime>
+#include <mutex>
+#include "DS1307.h"
+
+
+namespace ds1307
+{
+
+/**
+ * @brief  Clock backed by DS1307
+ * @note   now() reads the chip only once per refresh period. In between, the
+ *         last reading is extrapolated with std::chrono::steady_clock.
+ * @note   time_point counts from 1970-01-01 00:00:00 (same as system_clock).
+ */
+class rtc_clock
+{
+public:
+  using duration   = std::chrono::microseconds;
+  using rep        = duration::rep;
+  using period     = duration::period;
+  using time_point = std::chrono::time_point<rtc_clock>;
+
+  static constexpr bool is_steady = false;
+
+  /**
+   * @brief  Attach clock to an initialized DS1307 handler
+   * @param  Handler: Pointer to handler
+   * @param  Refresh: Maximum age of cached reading
+   */
+  static void
+  attach(DS1307_Handler_t *Handler,
+         std::chrono::steady_clock::duration Refresh = std::chrono::seconds(60))
+  {
+    std::lock_guard<std::mutex> Lock(State().Mutex);
+    State().Handler = Handler;
+    State().Refresh = Refresh;
+    State().Valid = false;
+  }
+
+  /**
+   * @brief  Align cached reading with a second transition of DS1307
+   * @note   Blocks up to 1 s. Without it, the sub-second part of now() is only
+   *         as good as the time of the first reading.
+   * @retval DS1307_Result_t
+   */
+  static DS1307_Result_t
+  sync()
+  {
+    std::lock_guard<std::mutex> Lock(State().Mutex);
+
+    if (!State().Handler)
+      return DS1307_INVALID_PARAM;
+
+    if (DS1307_WaitSecondEdge(State().Handler, 0xFFFF) != DS1307_OK)
+      return DS1307_FAIL;
+
+    const auto Steady = std::chrono::steady_clock::now();
+    duration Rtc;
+    if (!ReadRtc(Rtc))
+      return DS1307_FAIL;
+
+    Rebase(Rtc, Steady);
+    return DS1307_OK;
+  }
+
+  /**
+   * @brief  Drop cached reading, next now() reads the chip
+   */
+  static void
+  invalidate()
+  {
+    std::lock_guard<std::mutex> Lock(State().Mutex);
+    State().Valid = false;
+  }
+
+  /**
+   * @brief  Current DS1307 time
+   * @note   If the chip can't be read, the last reading keeps being
+   *         extrapolated (or the epoch is returned if there is none).
+   */
+  static time_point
+  now()
+  {
+    std::lock_guard<std::mutex> Lock(State().Mutex);
+    const auto Steady = std::chrono::steady_clock::now();
+    duration Rtc;
+
+    if (State().Valid && Steady - State().SteadyBase < State().Refresh)
+      return Extrapolate(Steady);
+
+    if (!State().Handler || !ReadRtc(Rtc))
+      return State().Valid ? Extrapolate(Steady) : time_point();
+
+    // keep the sub-second part while the reading agrees with the extrapolation
+    if (State().Valid)
+    {
+      const auto Current = Extrapolate(Steady).time_since_epoch();
+      if (Current >= Rtc && Current < Rtc + std::chrono::seconds(1))
+      {
+        State().SteadyBase = Steady;
+        State().Base = Current;
+        return time_point(Current);
+      }
+    }
+
+    Rebase(Rtc, Steady);
+    return time_point(Rtc);
+  }
+
+  static std::time_t
+  to_time_t(const time_point &Time) noexcept
+  {
+    return static_cast<std::time_t>(
+      std::chrono::duration_cast<std::chrono::seconds>(Time.time_since_epoch()).count());
+  }
+
+  static time_point
+  from_time_t(std::time_t Time) noexcept
+  {
+    return time_point(std::chrono::seconds(Time));
+  }
+
+  static std::chrono::system_clock::time_point
+  to_sys(const time_point &Time) noexcept
+  {
+    return std::chrono::system_clock::time_point(
+      std::chrono::duration_cast<std::chrono::system_clock::duration>(Time.time_since_epoch()));
+  }
+
+  static time_point
+  from_sys(const std::chrono::system_clock::time_point &Time) noexcept
+  {
+    return time_point(std::chrono::duration_cast<duration>(Time.time_since_epoch()));
+  }
+
+private:
+  struct state
+  {
+    std::mutex Mutex;
+    DS1307_Handler_t *Handler = nullptr;
+    std::chrono::steady_clock::duration Refresh = std::chrono::seconds(60);
+    std::chrono::steady_clock::time_point SteadyBase;
+    duration Base{0};
+    bool Valid = false;
+  };
+
+  static state &
+  State()
+  {
+    static state Instance;
+    return Instance;
+  }
+
+  static bool
+  ReadRtc(duration &Rtc)
+  {
+    DS1307_DateTime_t DateTime;
+    uint32_t Unix = 0;
+
+    if (DS1307_GetDateTime(State().Handler, &DateTime) != DS1307_OK ||
+        DS1307_DateTimeToUnix(&DateTime, &Unix) != DS1307_OK)
+      return false;
+
+    Rtc = std::chrono::seconds(Unix);
+    return true;
+  }
+
+  static void
+  Rebase(duration Rtc, std::chrono::steady_clock::time_point Steady)
+  {
+    State().Base = Rtc;
+    State().SteadyBase = Steady;
+    State().Valid = true;
+  }
+
+  static time_point
+  Extrapolate(std::chrono::steady_clock::time_point Steady)
+  {
+    return time_point(State().Base +
+                      std::chrono::duration_cast<duration>(Steady - State().SteadyBase));
+  }
+};
+
+} // namespace ds1307
+
+
+#endif //! _DS1307_CHRONO_HPP_
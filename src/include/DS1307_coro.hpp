@@ -0,0 +1,748 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_coro.hpp
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  DS1307 C++20 coroutine interface
+ *         Functionalities of the this file:
+ *          + Single-threaded executor (FreeRTOS task or epoll loop)
+ *          + Awaitable RTC operations over a non-blocking transport
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _DS1307_CORO_HPP_
+#define _DS1307_CORO_HPP_
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <chrono>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include "DS1307.hpp"
+
+
+namespace ds1307::coro
+{
+
+/**
+ ==================================================================================
+                               ##### Executor #####                                
+ ==================================================================================
+ */
+
+/**
+ * @brief  Single-threaded executor
+ * @note   run_once() must be called from one task/thread only. post() may be
+ *         called from any task/thread; Notify is then called so the owner can
+ *         wake up, e.g.:
+ *         - FreeRTOS: Notify = [Task] { xTaskNotifyGive(Task); } and the task
+ *           loops on ulTaskNotifyTake() + run_once().
+ *         - Linux: Notify writes to an eventfd registered in the epoll set and
+ *           the loop calls run_once() when it becomes readable.
+ *         Timers (sleep_for) belong to the owner: the loop waits at most
+ *         next_timeout() before calling run_once() again.
+ */
+class executor
+{
+public:
+  using clock = std::chrono::steady_clock;
+
+  explicit executor(std::function<void()> Notify = {}) : Notify_(std::move(Notify)) {}
+
+  executor(const executor &) = delete;
+  executor &operator=(const executor &) = delete;
+
+  /**
+   * @brief  Queue a coroutine to be resumed by run_once()
+   */
+  void
+  post(std::coroutine_handle<> Handle)
+  {
+    {
+      std::lock_guard<std::mutex> Lock(Mutex_);
+      Ready_.push_back(Handle);
+    }
+    if (Notify_)
+      Notify_();
+  }
+
+  /**
+   * @brief  Resume all queued coroutines
+   * @retval Number of resumed coroutines
+   */
+  std::size_t
+  run_once()
+  {
+    std::deque<std::coroutine_handle<>> Batch;
+    {
+      std::lock_guard<std::mutex> Lock(Mutex_);
+      Batch.swap(Ready_);
+    }
+
+    const auto Now = clock::now();
+    while (!Timers_.empty() && Timers_.begin()->first <= Now)
+    {
+      Batch.push_back(Timers_.begin()->second);
+      Timers_.erase(Timers_.begin());
+    }
+
+    for (auto Handle : Batch)
+      Handle.resume();
+    return Batch.size();
+  }
+
+  /**
+   * @brief  Time the owner may wait before calling run_once()
+   * @retval Zero if coroutines are queued, time to the first timer, or a
+   *         negative value if there is neither (wait for Notify only)
+   */
+  std::chrono::microseconds
+  next_timeout()
+  {
+    {
+      std::lock_guard<std::mutex> Lock(Mutex_);
+      if (!Ready_.empty())
+        return std::chrono::microseconds(0);
+    }
+
+    if (Timers_.empty())
+      return std::chrono::microseconds(-1);
+
+    const auto Left = Timers_.begin()->first - clock::now();
+    return Left.count() > 0 ?
+           std::chrono::ceil<std::chrono::microseconds>(Left) :
+           std::chrono::microseconds(0);
+  }
+
+  /**
+   * @brief  Resume coroutines until no coroutine is queued or sleeping
+   * @note   The thread sleeps until the next timer. Use it with transports
+   *         that complete before start_xxx returns (blocking_transport); an
+   *         event loop waits on Notify and next_timeout() instead.
+   */
+  void
+  run()
+  {
+    for (;;)
+    {
+      if (run_once())
+        continue;
+
+      const auto Timeout = next_timeout();
+      if (Timeout.count() < 0)
+        return;
+      std::this_thread::sleep_for(Timeout);
+    }
+  }
+
+  /**
+   * @brief  Awaitable that reschedules the current coroutine (yield)
+   */
+  auto
+  schedule()
+  {
+    struct awaiter
+    {
+      executor &Exec;
+      bool await_ready() const noexcept { return false; }
+      void await_suspend(std::coroutine_handle<> Handle) { Exec.post(Handle); }
+      void await_resume() const noexcept {}
+    };
+    return awaiter{*this};
+  }
+
+  /**
+   * @brief  Awaitable that resumes the current coroutine after Time
+   * @note   Only for coroutines running on this executor.
+   */
+  auto
+  sleep_for(std::chrono::microseconds Time)
+  {
+    struct awaiter
+    {
+      executor &Exec;
+      clock::time_point Deadline;
+      bool await_ready() const noexcept { return false; }
+      void await_suspend(std::coroutine_handle<> Handle) { Exec.Timers_.emplace(Deadline, Handle); }
+      void await_resume() const noexcept {}
+    };
+    return awaiter{*this, clock::now() + Time};
+  }
+
+private:
+  std::function<void()> Notify_;
+  std::mutex Mutex_;
+  std::deque<std::coroutine_handle<>> Ready_;
+  std::multimap<clock::time_point, std::coroutine_handle<>> Timers_;
+};
+
+
+
+/**
+ * @brief  Mutex for coroutines of one executor
+ * @note   lock() suspends the caller instead of blocking the thread. The lock
+ *         is handed to the next waiter in FIFO order through the executor.
+ *         It must only be used from the thread that runs the executor.
+ */
+class async_mutex
+{
+public:
+  explicit async_mutex(executor &Exec) : Exec_(Exec) {}
+
+  async_mutex(const async_mutex &) = delete;
+  async_mutex &operator=(const async_mutex &) = delete;
+
+  /**
+   * @brief  Unlocks the mutex when it goes out of scope
+   */
+  class guard
+  {
+  public:
+    explicit guard(async_mutex &Mutex) noexcept : Mutex_(&Mutex) {}
+    guard(guard &&Other) noexcept : Mutex_(std::exchange(Other.Mutex_, nullptr)) {}
+    guard(const guard &) = delete;
+    guard &operator=(const guard &) = delete;
+    ~guard()
+    {
+      if (Mutex_)
+        Mutex_->unlock();
+    }
+
+  private:
+    async_mutex *Mutex_;
+  };
+
+  /**
+   * @brief  Awaitable that completes with a guard once the mutex is owned
+   */
+  auto
+  lock()
+  {
+    struct awaiter
+    {
+      async_mutex &Mutex;
+
+      bool
+      await_ready() noexcept
+      {
+        if (Mutex.Locked_)
+          return false;
+        Mutex.Locked_ = true;
+        return true;
+      }
+
+      void await_suspend(std::coroutine_handle<> Handle) { Mutex.Waiters_.push_back(Handle); }
+      guard await_resume() noexcept { return guard(Mutex); }
+    };
+    return awaiter{*this};
+  }
+
+private:
+  void
+  unlock()
+  {
+    if (Waiters_.empty())
+    {
+      Locked_ = false;
+      return;
+    }
+
+    // ownership passes to the next waiter, the mutex stays locked
+    auto Next = Waiters_.front();
+    Waiters_.pop_front();
+    Exec_.post(Next);
+  }
+
+  executor &Exec_;
+  bool Locked_ = false;
+  std::deque<std::coroutine_handle<>> Waiters_;
+};
+
+
+
+/**
+ ==================================================================================
+                                 ##### Task #####                                  
+ ==================================================================================
+ */
+
+template <class T>
+class task;
+
+namespace detail
+{
+struct final_awaiter
+{
+  bool await_ready() noexcept { return false; }
+
+  template <class Promise>
+  std::coroutine_handle<>
+  await_suspend(std::coroutine_handle<Promise> Handle) noexcept
+  {
+    auto Next = Handle.promise().Continuation;
+    return Next ? Next : std::noop_coroutine();
+  }
+
+  void await_resume() noexcept {}
+};
+
+template <class T>
+struct promise_base
+{
+  std::coroutine_handle<> Continuation;
+
+  std::suspend_always initial_suspend() noexcept { return {}; }
+  final_awaiter final_suspend() noexcept { return {}; }
+  void unhandled_exception() noexcept { std::terminate(); }
+};
+
+template <class T>
+struct promise : promise_base<T>
+{
+  T Value{};
+
+  task<T> get_return_object() noexcept;
+  void return_value(T Result) { Value = std::move(Result); }
+  T take() { return std::move(Value); }
+};
+
+template <>
+struct promise<void> : promise_base<void>
+{
+  task<void> get_return_object() noexcept;
+  void return_void() noexcept {}
+  void take() noexcept {}
+};
+} // namespace detail
+
+/**
+ * @brief  Lazily started coroutine, resumed by the coroutine awaiting it
+ */
+template <class T = void>
+class task
+{
+public:
+  using promise_type = detail::promise<T>;
+  using handle_type = std::coroutine_handle<promise_type>;
+
+  explicit task(handle_type Handle) noexcept : Handle_(Handle) {}
+  task(task &&Other) noexcept : Handle_(std::exchange(Other.Handle_, {})) {}
+  task(const task &) = delete;
+  task &operator=(const task &) = delete;
+  ~task()
+  {
+    if (Handle_)
+      Handle_.destroy();
+  }
+
+  bool await_ready() const noexcept { return false; }
+
+  std::coroutine_handle<>
+  await_suspend(std::coroutine_handle<> Awaiting) noexcept
+  {
+    // the awaiting coroutine is resumed when this task finishes
+    Handle_.promise().Continuation = Awaiting;
+    return Handle_;
+  }
+
+  T await_resume() { return Handle_.promise().take(); }
+
+private:
+  handle_type Handle_;
+};
+
+template <class T>
+task<T>
+detail::promise<T>::get_return_object() noexcept
+{
+  return task<T>(std::coroutine_handle<promise<T>>::from_promise(*this));
+}
+
+inline task<void>
+detail::promise<void>::get_return_object() noexcept
+{
+  return task<void>(std::coroutine_handle<promise<void>>::from_promise(*this));
+}
+
+namespace detail
+{
+struct detached
+{
+  struct promise_type
+  {
+    detached get_return_object() noexcept { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }
+  };
+};
+
+inline detached
+run_detached(executor &Exec, task<void> Task)
+{
+  co_await Exec.schedule();
+  co_await std::move(Task);
+}
+} // namespace detail
+
+/**
+ * @brief  Start a task on the executor without awaiting it
+ */
+inline void
+spawn(executor &Exec, task<void> Task)
+{
+  detail::run_detached(Exec, std::move(Task));
+}
+
+
+
+/**
+ ==================================================================================
+                              ##### Transport #####                                
+ ==================================================================================
+ */
+
+/**
+ * @brief  Completion callback of non-blocking transfers
+ * @note   Result follows DS1307_PlatformSendReceive_t. Device operations map
+ *         it to DS1307_BUS_BUSY, DS1307_NACK or DS1307_FAIL.
+ */
+struct completion
+{
+  void (*Function)(void *Context, int8_t Result);
+  void *Context;
+
+  void operator()(int8_t Result) const { Function(Context, Result); }
+};
+
+/**
+ * @brief  Transport requirements
+ *         A Transport is a class with these members:
+ *         - void start_send(uint8_t Address, const uint8_t *Data, uint8_t Len,
+ *                           completion Done)
+ *         - void start_receive(uint8_t Address, uint8_t *Data, uint8_t Len,
+ *                              completion Done)
+ *         Done must be called exactly once, from any context that may call
+ *         executor::post(), possibly before start_xxx returns.
+ *         i2cdev_transport (port/Linux-i2cdev/DS1307_coro_i2cdev.hpp) is a
+ *         non-blocking one for Linux.
+ */
+
+/**
+ * @brief  Transport adapter for blocking DS1307_Handler_t callbacks
+ * @note   Transfers complete before start_xxx returns. It lets the coroutine
+ *         API run on existing ports until a non-blocking port is available.
+ *         Like the C API, transfers go to Handler->Address (if set) and
+ *         PlatformSelect is called before each of them, so a DS1307 behind
+ *         a mux (DS1307_mux.h) is selected first.
+ */
+class blocking_transport
+{
+public:
+  explicit blocking_transport(DS1307_Handler_t *Handler) : Handler_(Handler) {}
+
+  void
+  start_send(uint8_t Address, const uint8_t *Data, uint8_t Len, completion Done)
+  {
+    int8_t Result = Select();
+
+    if (Result >= 0)
+      Result = Handler_->PlatformSend(Target(Address), const_cast<uint8_t *>(Data), Len);
+    Done(Result);
+  }
+
+  void
+  start_receive(uint8_t Address, uint8_t *Data, uint8_t Len, completion Done)
+  {
+    int8_t Result = Select();
+
+    if (Result >= 0)
+      Result = Handler_->PlatformReceive(Target(Address), Data, Len);
+    Done(Result);
+  }
+
+private:
+  DS1307_Handler_t *Handler_;
+
+  int8_t
+  Select()
+  {
+    return Handler_->PlatformSelect ?
+           Handler_->PlatformSelect(Handler_->PlatformContext) : 0;
+  }
+
+  uint8_t
+  Target(uint8_t Address) const noexcept
+  {
+    return Handler_->Address ? Handler_->Address : Address;
+  }
+};
+
+
+
+/**
+ ==================================================================================
+                                ##### Device #####                                 
+ ==================================================================================
+ */
+
+/**
+ * @brief  DS1307 with awaitable operations
+ * @note   Operations on one device are serialized: an operation owns the
+ *         device from its register pointer write to its last transfer, so
+ *         it always reads the registers it addressed. Transfers are resumed
+ *         through the executor, so coroutines using other devices keep
+ *         running meanwhile.
+ */
+template <class Transport>
+class device
+{
+public:
+  device(executor &Exec, Transport &Bus) : Exec_(Exec), Bus_(Bus), Lock_(Exec) {}
+
+  /**
+   * @brief  Read date and time
+   */
+  task<DS1307_Result_t>
+  read_time(DS1307_DateTime_t &DateTime)
+  {
+    uint8_t Buffer[7];
+    auto Guard = co_await Lock_.lock();
+    const int8_t Err = co_await ReadRegs(ds1307::detail::Second, Buffer, sizeof(Buffer));
+
+    if (Err < 0)
+      co_return ds1307::detail::BusResult(Err);
+
+    DateTime.Second  = BCDtoDEC(Buffer[0] & 0x7F);
+    DateTime.Minute  = BCDtoDEC(Buffer[1]);
+    DateTime.Hour    = BCDtoDEC(Buffer[2]);
+    DateTime.WeekDay = BCDtoDEC(Buffer[3]);
+    DateTime.Day     = BCDtoDEC(Buffer[4]);
+    DateTime.Month   = BCDtoDEC(Buffer[5]);
+    DateTime.Year    = BCDtoDEC(Buffer[6]);
+    co_return DS1307_OK;
+  }
+
+  /**
+   * @brief  Write date and time and start the oscillator
+   */
+  task<DS1307_Result_t>
+  write_time(DS1307_DateTime_t DateTime)
+  {
+    if (!IsValid(DateTime))
+      co_return DS1307_INVALID_PARAM;
+
+    auto Guard = co_await Lock_.lock();
+    uint8_t Buffer[8] = {
+      ds1307::detail::Second,
+      DECtoBCD(DateTime.Second),
+      DECtoBCD(DateTime.Minute),
+      DECtoBCD(DateTime.Hour),
+      DECtoBCD(DateTime.WeekDay),
+      DECtoBCD(DateTime.Day),
+      DECtoBCD(DateTime.Month),
+      DECtoBCD(DateTime.Year),
+    };
+
+    co_return ds1307::detail::BusResult(co_await Send(Buffer, sizeof(Buffer)));
+  }
+
+  /**
+   * @brief  Read data from Non-volatile RAM
+   * @param  Offset: address of block beginning (0 to 55)
+   */
+  task<DS1307_Result_t>
+  read_ram(uint8_t Offset, span<uint8_t> Data)
+  {
+    if (!Data.size())
+      co_return DS1307_OK;
+    if (!RamRangeValid(Offset, Data.size()))
+      co_return DS1307_INVALID_PARAM;
+
+    auto Guard = co_await Lock_.lock();
+    co_return ds1307::detail::BusResult(
+        co_await ReadRegs(static_cast<uint8_t>(ds1307::detail::Ram + Offset),
+                          Data.data(), static_cast<uint8_t>(Data.size())));
+  }
+
+  /**
+   * @brief  Write data on Non-volatile RAM in one transfer
+   * @param  Offset: address of block beginning (0 to 55)
+   */
+  task<DS1307_Result_t>
+  write_ram(uint8_t Offset, span<const uint8_t> Data)
+  {
+    uint8_t Buffer[ds1307::detail::RamSize + 1];
+
+    if (!Data.size())
+      co_return DS1307_OK;
+    if (!RamRangeValid(Offset, Data.size()))
+      co_return DS1307_INVALID_PARAM;
+
+    Buffer[0] = static_cast<uint8_t>(ds1307::detail::Ram + Offset);
+    std::memcpy(Buffer + 1, Data.data(), Data.size());
+    auto Guard = co_await Lock_.lock();
+    co_return ds1307::detail::BusResult(
+        co_await Send(Buffer, static_cast<uint8_t>(Data.size() + 1)));
+  }
+
+  /**
+   * @brief  Set output Wave on SQW/Out pin
+   */
+  task<DS1307_Result_t>
+  set_out_wave(DS1307_OutWave_t OutWave)
+  {
+    const int16_t Control = ControlReg(OutWave);
+
+    if (Control < 0)
+      co_return DS1307_INVALID_PARAM;
+
+    uint8_t Buffer[2] = {ds1307::detail::Control, static_cast<uint8_t>(Control)};
+    auto Guard = co_await Lock_.lock();
+    co_return ds1307::detail::BusResult(co_await Send(Buffer, sizeof(Buffer)));
+  }
+
+  /**
+   * @brief  Complete at the next second transition
+   * @note   The SECOND register is polled with 1-byte reads, Interval apart.
+   *         The coroutine sleeps on the executor between polls and releases
+   *         the device, so other operations on it can run during the wait.
+   *         The edge is seen up to Interval (plus one read) late. The default
+   *         limit covers more than one second, so it only ends the wait on a
+   *         clock that does not tick.
+   * @param  Interval: Time between polls
+   * @param  MaxPolls: Maximum number of polls before giving up (0 = no limit)
+   */
+  task<DS1307_Result_t>
+  next_second_edge(std::chrono::microseconds Interval = std::chrono::milliseconds(1),
+                   uint16_t MaxPolls = 1100)
+  {
+    uint8_t First = 0;
+    uint8_t Second = 0;
+    int8_t Err = co_await LockedReadRegs(ds1307::detail::Second, &First, 1);
+
+    if (Err < 0)
+      co_return ds1307::detail::BusResult(Err);
+
+    if (First & 0x80)
+      co_return DS1307_FAIL; // oscillator is halted
+
+    do
+    {
+      co_await Exec_.sleep_for(Interval);
+      if ((Err = co_await LockedReadRegs(ds1307::detail::Second, &Second, 1)) < 0)
+        co_return ds1307::detail::BusResult(Err);
+      if (Second != First)
+        co_return DS1307_OK;
+    } while (!MaxPolls || --MaxPolls);
+
+    co_return DS1307_FAIL;
+  }
+
+private:
+  executor &Exec_;
+  Transport &Bus_;
+  async_mutex Lock_;
+
+  struct transfer
+  {
+    device &Device;
+    bool IsSend;
+    uint8_t *Data;
+    uint8_t Len;
+    std::coroutine_handle<> Handle;
+    int8_t Result = 0;
+
+    bool await_ready() const noexcept { return false; }
+
+    void
+    await_suspend(std::coroutine_handle<> Awaiting)
+    {
+      Handle = Awaiting;
+      completion Done{&transfer::Complete, this};
+      if (IsSend)
+        Device.Bus_.start_send(ds1307::detail::Address, Data, Len, Done);
+      else
+        Device.Bus_.start_receive(ds1307::detail::Address, Data, Len, Done);
+    }
+
+    int8_t await_resume() const noexcept { return Result; }
+
+    static void
+    Complete(void *Context, int8_t Result)
+    {
+      auto *Self = static_cast<transfer *>(Context);
+      Self->Result = Result;
+      Self->Device.Exec_.post(Self->Handle);
+    }
+  };
+
+  transfer
+  Send(uint8_t *Data, uint8_t Len)
+  {
+    return transfer{*this, true, Data, Len, {}};
+  }
+
+  transfer
+  Receive(uint8_t *Data, uint8_t Len)
+  {
+    return transfer{*this, false, Data, Len, {}};
+  }
+
+  task<int8_t>
+  ReadRegs(uint8_t StartReg, uint8_t *Data, uint8_t Len)
+  {
+    int8_t Result = co_await Send(&StartReg, 1);
+    if (Result < 0)
+      co_return Result;
+    co_return co_await Receive(Data, Len);
+  }
+
+  task<int8_t>
+  LockedReadRegs(uint8_t StartReg, uint8_t *Data, uint8_t Len)
+  {
+    auto Guard = co_await Lock_.lock();
+    co_return co_await ReadRegs(StartReg, Data, Len);
+  }
+
+  static constexpr bool
+  RamRangeValid(uint8_t Offset, std::size_t Size) noexcept
+  {
+    return Size != 0 && Offset < ds1307::detail::RamSize &&
+           Size <= static_cast<std::size_t>(ds1307::detail::RamSize - Offset);
+  }
+};
+
+} // namespace ds1307::coro
+
+
+#endif //! _DS1307_CORO_HPP_
@@ -0,0 +1,142 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_mux.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  DS1307 behind TCA9548A-style I2C multiplexers
+ *         Functionalities of the this file:
+ *          + Select the mux channel of a handler before each transfer
+ *          + Track the open channel per bus and skip redundant channel selects
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _DS1307_MUX_H_
+#define _DS1307_MUX_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include "DS1307.h"
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+
+/**
+ * @brief  I2C bus with one or more muxes
+ * @note   One instance per physical bus, shared by all handlers on that bus.
+ *         Muxes are assumed to power up with all channels closed.
+ */
+typedef struct DS1307_MuxBus_s
+{
+  // Send data on the bus (the same function as the handlers use)
+  DS1307_PlatformSendReceive_t Send;
+
+  uint8_t   MuxAddress;   // mux that may have an open channel (0: none)
+  uint8_t   Channel;      // open channel of MuxAddress
+  uint8_t   Known;        // MuxAddress and Channel reflect the hardware
+
+  uint32_t  Selects;      // channel select writes sent
+  uint32_t  Skips;        // channel selects skipped
+} DS1307_MuxBus_t;
+
+/**
+ * @brief  Position of a DS1307 behind a mux (PlatformContext of its handler)
+ */
+typedef struct DS1307_MuxPort_s
+{
+  DS1307_MuxBus_t *Bus;
+  uint8_t   MuxAddress;   // 7-bit address of mux (TCA9548A: 0x70 to 0x77)
+  uint8_t   Channel;      // 0 to 7
+} DS1307_MuxPort_t;
+
+
+
+/**
+ ==================================================================================
+                             ##### Functions #####                                 
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize a mux bus
+ * @param  Bus: Pointer to bus
+ * @param  Send: Function to send data on the bus
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_MuxBus_Init(DS1307_MuxBus_t *Bus, DS1307_PlatformSendReceive_t Send);
+
+
+/**
+ * @brief  Forget the channel state of a bus (e.g. after a mux reset); the
+ *         next transfer selects its channel again
+ * @param  Bus: Pointer to bus
+ * @retval None
+ */
+void
+DS1307_MuxBus_Invalidate(DS1307_MuxBus_t *Bus);
+
+
+/**
+ * @brief  Close the open channel of a bus
+ * @param  Bus: Pointer to bus
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send data.
+ */
+DS1307_Result_t
+DS1307_MuxBus_Release(DS1307_MuxBus_t *Bus);
+
+
+/**
+ * @brief  Place a handler behind a mux channel
+ * @note   Sets PlatformSelect and PlatformContext of handler. Port must stay
+ *         valid while the handler is used.
+ * @param  Handler: Pointer to handler
+ * @param  Port: Pointer to port storage of this handler
+ * @param  Bus: Pointer to bus of the mux
+ * @param  MuxAddress: 7-bit address of mux
+ * @param  Channel: Channel of mux (0 to 7)
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_Mux_Attach(DS1307_Handler_t *Handler, DS1307_MuxPort_t *Port,
+                  DS1307_MuxBus_t *Bus, uint8_t MuxAddress, uint8_t Channel);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif //! _DS1307_MUX_H_
@@ -0,0 +1,132 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_nvatomic.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  DS1307 power-fail-atomic NVRAM records
+ *         Functionalities of the this file:
+ *          + A/B slots with sequence number and CRC-8
+ *          + Commit completed by a single-byte slot selector write
+ *          + Recovery with one bulk read
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _DS1307_NVATOMIC_H_
+#define _DS1307_NVATOMIC_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include "DS1307.h"
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+
+/**
+ * @brief  Atomic record handler
+ * @note   Region layout (from Address):
+ *         [Selector][Seq A][Data A][CRC A][Seq B][Data B][CRC B]
+ *         A commit writes the inactive slot first and then flips the selector
+ *         byte. A single-byte write can't be torn, so after a power loss the
+ *         selector points either to the old or to the new record.
+ */
+typedef struct DS1307_NvAtomic_s
+{
+  DS1307_Handler_t *Handler;
+  // Address of region in NVRAM (0 to 55)
+  uint8_t Address;
+  // Size of record in bytes
+  uint8_t Size;
+  // Active slot (0: A, 1: B)
+  uint8_t Active;
+  // Sequence number of active slot
+  uint8_t Sequence;
+  // 1 if the active slot holds a valid record
+  uint8_t Valid;
+} DS1307_NvAtomic_t;
+
+
+/* Exported Macro ---------------------------------------------------------------*/
+/**
+ * @brief  NVRAM bytes used by a record of Size bytes
+ */
+#define DS1307_NVATOMIC_REGION_SIZE(Size)   (1 + 2 * ((Size) + 2))
+
+/**
+ * @brief  Largest record that fits in DS1307 NVRAM
+ */
+#define DS1307_NVATOMIC_MAX_SIZE            25
+
+
+
+/**
+ ==================================================================================
+                             ##### Functions #####                                 
+ ==================================================================================
+ */
+
+/**
+ * @brief  Recover the last committed record with one bulk read
+ * @note   If no valid record exists (e.g. first power-up), NvAtomic->Valid is
+ *         cleared and Data is left untouched; commit the defaults then.
+ * @param  NvAtomic: Pointer to record handler
+ * @param  Handler: Pointer to initialized DS1307 handler
+ * @param  Address: Address of region in NVRAM (0 to 55)
+ * @param  Size: Size of record (1 to DS1307_NVATOMIC_MAX_SIZE)
+ * @param  Data: Pointer to record buffer (Size bytes)
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_INVALID_PARAM: Region is out of NVRAM.
+ */
+DS1307_Result_t
+DS1307_NvAtomic_Load(DS1307_NvAtomic_t *NvAtomic, DS1307_Handler_t *Handler,
+                     uint8_t Address, uint8_t Size, uint8_t *Data);
+
+
+/**
+ * @brief  Commit a new record
+ * @note   The inactive slot is written first, then the selector byte.
+ * @param  NvAtomic: Pointer to record handler (loaded by DS1307_NvAtomic_Load)
+ * @param  Data: Pointer to record (NvAtomic->Size bytes)
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data. The previous record
+ *                        remains valid.
+ */
+DS1307_Result_t
+DS1307_NvAtomic_Commit(DS1307_NvAtomic_t *NvAtomic, const uint8_t *Data);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif //! _DS1307_NVATOMIC_H_
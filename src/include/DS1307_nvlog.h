@@ -0,0 +1,192 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_nvlog.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  DS1307 timestamped event log in NVRAM
+ *         Functionalities of the this file:
+ *          + Ring buffer of events with delta-encoded RTC timestamps
+ *          + O(1) append: new entry plus 1-byte head update
+ *          + Recovery with one bulk read
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _DS1307_NVLOG_H_
+#define _DS1307_NVLOG_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include "DS1307.h"
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+
+/**
+ * @brief  Event log handler
+ * @note   Region layout (from Address):
+ *         [Magic][Head][Base (4 bytes)][Entry 0]...[Entry Capacity-1]
+ *         Entry = [Code][Delta (3 bytes)], Delta = seconds since Base.
+ *         Head holds the index of the next entry (bits 0-3) and a wrapped
+ *         flag (bit 7). The slot at the head index is always free, so a log
+ *         keeps at most Capacity-1 events and an append never overwrites a
+ *         live entry. The entry is committed by the head update, which also
+ *         drops the oldest event of a full log, so a power loss during append
+ *         just drops the new entry. A rebase clears the head
+ *         before rewriting base and entries, so a power loss during it leaves
+ *         an empty log rather than wrong timestamps.
+ */
+typedef struct DS1307_NvLog_s
+{
+  DS1307_Handler_t *Handler;
+  // Address of region in NVRAM (0 to 55)
+  uint8_t Address;
+  // Number of entry slots (2 to DS1307_NVLOG_MAX_CAPACITY), one is kept free
+  uint8_t Capacity;
+  // Head byte as stored in NVRAM
+  uint8_t Head;
+  // Unix time of delta 0
+  uint32_t Base;
+} DS1307_NvLog_t;
+
+/**
+ * @brief  Event
+ */
+typedef struct DS1307_NvLogEvent_s
+{
+  uint8_t   Code;
+  uint32_t  Unix;
+} DS1307_NvLogEvent_t;
+
+
+/* Exported Macro ---------------------------------------------------------------*/
+/**
+ * @brief  NVRAM bytes used by a log of Capacity entries
+ */
+#define DS1307_NVLOG_REGION_SIZE(Capacity)  (6 + 4 * (Capacity))
+
+/**
+ * @brief  Largest number of entry slots that fits in DS1307 NVRAM
+ */
+#define DS1307_NVLOG_MAX_CAPACITY           12
+
+
+
+/**
+ ==================================================================================
+                             ##### Functions #####                                 
+ ==================================================================================
+ */
+
+/**
+ * @brief  Recover event log with one bulk read, or format it if not valid
+ * @param  NvLog: Pointer to log handler
+ * @param  Handler: Pointer to initialized DS1307 handler
+ * @param  Address: Address of region in NVRAM (0 to 55)
+ * @param  Capacity: Number of entry slots (2 to DS1307_NVLOG_MAX_CAPACITY),
+ *                   the log keeps up to Capacity-1 events
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_INVALID_PARAM: Region is out of NVRAM.
+ */
+DS1307_Result_t
+DS1307_NvLog_Init(DS1307_NvLog_t *NvLog, DS1307_Handler_t *Handler,
+                  uint8_t Address, uint8_t Capacity);
+
+
+/**
+ * @brief  Erase all events
+ * @param  NvLog: Pointer to log handler
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data.
+ */
+DS1307_Result_t
+DS1307_NvLog_Clear(DS1307_NvLog_t *NvLog);
+
+
+/**
+ * @brief  Append an event stamped with the current RTC time
+ * @note   Writes the new entry and then the head byte. The whole log is
+ *         rewritten only when the delta overflows 24 bits (every ~194 days)
+ *         or the clock was set back before the base time.
+ * @param  NvLog: Pointer to log handler
+ * @param  Code: Application defined event code
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data.
+ */
+DS1307_Result_t
+DS1307_NvLog_Append(DS1307_NvLog_t *NvLog, uint8_t Code);
+
+
+/**
+ * @brief  Append an event with a given timestamp
+ * @param  NvLog: Pointer to log handler
+ * @param  Code: Application defined event code
+ * @param  Unix: Unix time of event
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data.
+ */
+DS1307_Result_t
+DS1307_NvLog_AppendAt(DS1307_NvLog_t *NvLog, uint8_t Code, uint32_t Unix);
+
+
+/**
+ * @brief  Number of stored events
+ * @param  NvLog: Pointer to log handler
+ * @retval Number of events
+ */
+uint8_t
+DS1307_NvLog_Count(const DS1307_NvLog_t *NvLog);
+
+
+/**
+ * @brief  Read an event
+ * @param  NvLog: Pointer to log handler
+ * @param  Index: 0 for the newest event, Count-1 for the oldest one
+ * @param  Event: Pointer to event
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_INVALID_PARAM: Index is out of range.
+ */
+DS1307_Result_t
+DS1307_NvLog_Get(const DS1307_NvLog_t *NvLog, uint8_t Index,
+                 DS1307_NvLogEvent_t *Event);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif //! _DS1307_NVLOG_H_
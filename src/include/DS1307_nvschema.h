@@ -0,0 +1,185 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_nvschema.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  DS1307 bit-packed NVRAM schema
+ *         Functionalities of the this file:
+ *          + Declare packed NVRAM layouts with X-macros
+ *          + Generated pack/unpack accessors
+ *          + Field updates write only the changed bytes
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _DS1307_NVSCHEMA_H_
+#define _DS1307_NVSCHEMA_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+#include "DS1307.h"
+
+
+/**
+ ==================================================================================
+                           ##### Schema Declaration #####                          
+ ==================================================================================
+ */
+
+/**
+ * @brief  Declare a packed NVRAM layout
+ * @note   Fields is an X-macro list of (Context, Field, Bits) entries, where
+ *         Bits is 1 to 32. Fields are packed LSB first without padding:
+ *
+ *         #define APP_FIELDS(X, C) \
+ *           X(C, BootCount, 16)    \
+ *           X(C, Mode,      3)     \
+ *           X(C, Calib,     12)
+ *
+ *         DS1307_NVSCHEMA_DEFINE(App, APP_FIELDS, 0)
+ *
+ *         generates (for NVRAM address 0):
+ *         - App_BYTES: Size of packed image in bytes
+ *         - App_t: Unpacked structure (one uint32_t per field)
+ *         - App_Load(Handler, Image): Read packed image with one bulk read
+ *         - App_Unpack(Image, &App) / App_Pack(&App, Image)
+ *         - App_Get_<Field>(Image)
+ *         - App_Set_<Field>(Handler, Image, Value): Update Image and write only
+ *           the changed bytes of the field to NVRAM
+ *
+ *         The layout is checked at compile time to fit in NVRAM.
+ */
+#define DS1307_NVSCHEMA_DEFINE(Name, Fields, Address)                           \
+  struct Name##_Bits_s { Fields(DS1307_NVSCHEMA_BITS_, Name) };                 \
+  enum { Name##_ADDRESS = (Address),                                            \
+         Name##_BYTES = (sizeof(struct Name##_Bits_s) + 7) / 8 };               \
+  typedef char Name##_FitsInNVRAM[                                              \
+      ((Address) + Name##_BYTES <= DS1307_RAM_SIZE) ? 1 : -1];                  \
+  typedef struct Name##_s { Fields(DS1307_NVSCHEMA_MEMBER_, Name) } Name##_t;   \
+  Fields(DS1307_NVSCHEMA_ACCESSORS_, Name)                                      \
+  static inline DS1307_Result_t                                                 \
+  Name##_Load(DS1307_Handler_t *Handler, uint8_t *Image)                        \
+  {                                                                             \
+    return DS1307_ReadRAM(Handler, Name##_ADDRESS, Image, Name##_BYTES);        \
+  }                                                                             \
+  static inline void                                                            \
+  Name##_Unpack(const uint8_t *Image, Name##_t *Value)                          \
+  {                                                                             \
+    Fields(DS1307_NVSCHEMA_UNPACK_, Name)                                       \
+  }                                                                             \
+  static inline void                                                            \
+  Name##_Pack(const Name##_t *Value, uint8_t *Image)                            \
+  {                                                                             \
+    Fields(DS1307_NVSCHEMA_PACK_, Name)                                         \
+  }
+
+// Internal expansions of DS1307_NVSCHEMA_DEFINE
+#define DS1307_NVSCHEMA_BITS_(Name, Field, Bits)    char Field[Bits];
+#define DS1307_NVSCHEMA_MEMBER_(Name, Field, Bits)  uint32_t Field;
+#define DS1307_NVSCHEMA_OFFSET_(Name, Field)        offsetof(struct Name##_Bits_s, Field)
+#define DS1307_NVSCHEMA_ACCESSORS_(Name, Field, Bits)                           \
+  static inline uint32_t                                                        \
+  Name##_Get_##Field(const uint8_t *Image)                                      \
+  {                                                                             \
+    return DS1307_NvSchema_GetBits(Image,                                       \
+                                   DS1307_NVSCHEMA_OFFSET_(Name, Field), Bits); \
+  }                                                                             \
+  static inline DS1307_Result_t                                                 \
+  Name##_Set_##Field(DS1307_Handler_t *Handler, uint8_t *Image, uint32_t Value) \
+  {                                                                             \
+    return DS1307_NvSchema_SetBits(Handler, Name##_ADDRESS, Image,              \
+                                   DS1307_NVSCHEMA_OFFSET_(Name, Field), Bits,  \
+                                   Value);                                      \
+  }
+#define DS1307_NVSCHEMA_UNPACK_(Name, Field, Bits)                              \
+  Value->Field = Name##_Get_##Field(Image);
+#define DS1307_NVSCHEMA_PACK_(Name, Field, Bits)                                \
+  DS1307_NvSchema_PutBits(Image, DS1307_NVSCHEMA_OFFSET_(Name, Field), Bits,    \
+                          Value->Field);
+
+
+
+/**
+ ==================================================================================
+                             ##### Functions #####                                 
+ ==================================================================================
+ */
+
+/**
+ * @brief  Get a field from packed image
+ * @param  Image: Pointer to packed image
+ * @param  BitOffset: Offset of field in bits
+ * @param  Bits: Width of field (1 to 32)
+ * @retval Value of field
+ */
+uint32_t
+DS1307_NvSchema_GetBits(const uint8_t *Image, uint16_t BitOffset, uint8_t Bits);
+
+
+/**
+ * @brief  Put a field into packed image (no NVRAM access)
+ * @param  Image: Pointer to packed image
+ * @param  BitOffset: Offset of field in bits
+ * @param  Bits: Width of field (1 to 32)
+ * @param  Value: Value of field (extra high bits are dropped)
+ * @retval None
+ */
+void
+DS1307_NvSchema_PutBits(uint8_t *Image, uint16_t BitOffset, uint8_t Bits,
+                        uint32_t Value);
+
+
+/**
+ * @brief  Update a field in packed image and NVRAM
+ * @note   Only the bytes of the field that actually changed are written. If
+ *         nothing changed, no transaction is made.
+ * @param  Handler: Pointer to handler
+ * @param  Address: NVRAM address of packed image (0 to 55)
+ * @param  Image: Pointer to packed image (loaded from NVRAM)
+ * @param  BitOffset: Offset of field in bits
+ * @param  Bits: Width of field (1 to 32)
+ * @param  Value: Value of field (extra high bits are dropped)
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_INVALID_PARAM: Field is out of NVRAM.
+ */
+DS1307_Result_t
+DS1307_NvSchema_SetBits(DS1307_Handler_t *Handler, uint8_t Address,
+                        uint8_t *Image, uint16_t BitOffset, uint8_t Bits,
+                        uint32_t Value);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif //! _DS1307_NVSCHEMA_H_
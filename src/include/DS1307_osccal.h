@@ -0,0 +1,185 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_osccal.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  MCU oscillator calibration against DS1307 SQW/OUT
+ *         Functionalities of the this file:
+ *          + Measure MCU clock error in ppm
+ *          + Trim MCU oscillator
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _DS1307_OSCCAL_H_
+#define _DS1307_OSCCAL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include "DS1307.h"
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+
+/**
+ * @brief  Function type for counting rising edges of the SQW/OUT pin of
+ *         DS1307 over a gate timed by the MCU clock.
+ * @param  GateUs: Gate time in microseconds of the (uncalibrated) MCU clock
+ * @param  Edges: Pointer to number of edges
+ * @retval 
+ *         -  0: The operation was successful.
+ *         - -1: The operation failed.
+ */
+typedef int8_t (*DS1307_OscCalCount_t)(uint32_t GateUs, uint32_t *Edges);
+
+/**
+ * @brief  Function type for trimming the MCU oscillator by one step.
+ * @param  Step: +1 to speed up, -1 to slow down
+ * @retval 
+ *         -  0: The operation was successful.
+ *         - -1: End of the trim range.
+ */
+typedef int8_t (*DS1307_OscCalTrim_t)(int8_t Step);
+
+/**
+ * @brief  Oscillator calibration handler
+ */
+typedef struct DS1307_OscCal_s
+{
+  DS1307_Handler_t *Handler;
+  // Counts SQW/OUT edges over a gate
+  DS1307_OscCalCount_t CountEdges;
+  // Trims the MCU oscillator (NULL: measurement only)
+  DS1307_OscCalTrim_t Trim;
+  // Frequency of SQW/OUT in Hz
+  uint32_t Frequency;
+  // Gate time in microseconds (DS1307_OSCCAL_GATE_US after init)
+  uint32_t GateUs;
+
+  // Results of the last measurement (managed by library functions)
+  uint32_t Edges;
+  int32_t  ErrorPpm;        // MCU clock error, positive: MCU is fast
+  uint32_t ResolutionPpm;   // error of one edge
+  int16_t  Steps;           // trim steps applied by DS1307_OscCal_Trim
+} DS1307_OscCal_t;
+
+
+/* Functionality Options --------------------------------------------------------*/
+/**
+ * @brief  Default gate time in microseconds
+ * @note   One edge is 1e6 / (Frequency * Gate) of error: about 30 ppm with
+ *         32.768 kHz and 1 s, 240 ppm with 4.096 kHz and 1 s.
+ */
+#ifndef DS1307_OSCCAL_GATE_US
+#define DS1307_OSCCAL_GATE_US   100000
+#endif
+
+
+
+/**
+ ==================================================================================
+                             ##### Functions #####                                 
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize oscillator calibration and enable SQW/OUT.
+ * @note   The SQW/OUT pin of DS1307 must be connected to the input counted
+ *         by CountEdges.
+ * @param  OscCal: Pointer to calibration handler
+ * @param  Handler: Pointer to initialized DS1307 handler
+ * @param  OutWave: Frequency of SQW/OUT
+ *         - DS1307_OutWave_4KHz
+ *         - DS1307_OutWave_8KHz
+ *         - DS1307_OutWave_32KHz
+ * @param  CountEdges: Edge counter function
+ * @param  Trim: Oscillator trim function (NULL: measurement only)
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_OscCal_Init(DS1307_OscCal_t *OscCal, DS1307_Handler_t *Handler,
+                   DS1307_OutWave_t OutWave, DS1307_OscCalCount_t CountEdges,
+                   DS1307_OscCalTrim_t Trim);
+
+
+/**
+ * @brief  Measure the MCU clock error against SQW/OUT.
+ * @note   The result is stored in OscCal->ErrorPpm (+- OscCal->ResolutionPpm).
+ *         No I2C access is made by this function.
+ * @param  OscCal: Pointer to calibration handler
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Edges could not be counted or no edge was seen.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_OscCal_Measure(DS1307_OscCal_t *OscCal);
+
+
+/**
+ * @brief  Trim the MCU oscillator (e.g. OSCCAL on AVR) until its error is
+ *         within TolerancePpm.
+ * @note   Steps are applied one at a time and measured. The trimming stops
+ *         at the closest setting when the error no longer improves.
+ * @param  OscCal: Pointer to calibration handler
+ * @param  MaxSteps: Maximum number of trim steps
+ * @param  TolerancePpm: Accepted error
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Error is within TolerancePpm.
+ *         - DS1307_FAIL: Edges could not be counted or the error is still
+ *                        out of tolerance (ErrorPpm holds the best error).
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_OscCal_Trim(DS1307_OscCal_t *OscCal, uint16_t MaxSteps,
+                   uint32_t TolerancePpm);
+
+
+/**
+ * @brief  Correct a nominal MCU frequency with the last measurement
+ * @note   Use it to compute baud rate and timer settings from the actual
+ *         frequency when the oscillator cannot be trimmed.
+ * @param  OscCal: Pointer to calibration handler
+ * @param  NominalHz: Nominal frequency (e.g. F_CPU)
+ * @retval Actual frequency in Hz
+ */
+uint32_t
+DS1307_OscCal_ActualHz(const DS1307_OscCal_t *OscCal, uint32_t NominalHz);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif //! _DS1307_OSCCAL_H_
@@ -0,0 +1,146 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_shared.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  DS1307 single-flight date and time reads
+ *         Functionalities of the this file:
+ *          + Share one in-flight date and time read between concurrent callers
+ *          + Reuse a completed read within a freshness window
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _DS1307_SHARED_H_
+#define _DS1307_SHARED_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include "DS1307.h"
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+
+/**
+ * @brief  Function type for lock/unlock of a mutex (RTOS mutex, pthread, ...)
+ * @param  Context: LockContext of shared handler
+ */
+typedef void (*DS1307_SharedLock_t)(void *Context);
+
+/**
+ * @brief  Shared handler
+ * @note   All tasks must access the DS1307 handler through the shared
+ *         functions (or under the same lock).
+ */
+typedef struct DS1307_Shared_s
+{
+  DS1307_Handler_t *Handler;
+  DS1307_SharedLock_t Lock;
+  DS1307_SharedLock_t Unlock;
+  void *LockContext;
+  uint32_t FreshUs;           // reuse window of a completed read (0: none)
+
+  volatile uint8_t Generation; // completed reads (wraps)
+  uint8_t Valid;
+  uint32_t Stamp;             // completion time of last read
+  DS1307_DateTime_t DateTime; // result of last read
+
+  uint32_t Reads;             // reads issued on the bus
+  uint32_t Hits;              // calls served without a bus read
+} DS1307_Shared_t;
+
+
+
+/**
+ ==================================================================================
+                             ##### Functions #####                                 
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize a shared handler
+ * @note   The freshness window needs PlatformGetTimeUs of handler.
+ * @param  Shared: Pointer to shared handler
+ * @param  Handler: Pointer to initialized DS1307 handler
+ * @param  Lock: Lock a mutex
+ * @param  Unlock: Unlock the mutex
+ * @param  LockContext: Pointer passed to Lock and Unlock (e.g. the mutex)
+ * @param  FreshUs: Age in microseconds up to which a completed read is reused
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_Shared_Init(DS1307_Shared_t *Shared, DS1307_Handler_t *Handler,
+                   DS1307_SharedLock_t Lock, DS1307_SharedLock_t Unlock,
+                   void *LockContext, uint32_t FreshUs);
+
+
+/**
+ * @brief  Get date and time, sharing reads between concurrent callers
+ * @note   A caller that arrives while a read is in flight waits for it and
+ *         gets its result. A read completed less than FreshUs ago is reused.
+ * @param  Shared: Pointer to shared handler
+ * @param  DateTime: pointer to date and time value structure
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_Shared_GetDateTime(DS1307_Shared_t *Shared, DS1307_DateTime_t *DateTime);
+
+
+/**
+ * @brief  Set date and time and drop the shared result
+ * @param  Shared: Pointer to shared handler
+ * @param  DateTime: pointer to date and time value structure
+ * @retval DS1307_Result_t (same as DS1307_SetDateTime)
+ */
+DS1307_Result_t
+DS1307_Shared_SetDateTime(DS1307_Shared_t *Shared, DS1307_DateTime_t *DateTime);
+
+
+/**
+ * @brief  Drop the shared result (e.g. after the clock was set directly)
+ * @param  Shared: Pointer to shared handler
+ * @retval None
+ */
+void
+DS1307_Shared_Invalidate(DS1307_Shared_t *Shared);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif //! _DS1307_SHARED_H_
@@ -0,0 +1,150 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_slew.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  DS1307 slewed monotonic time
+ *         Functionalities of the this file:
+ *          + Absorb time corrections gradually at a bounded slew rate (like adjtime)
+ *          + Monotonic corrected timestamps without I2C access
+ *          + Fold the accumulated correction into DS1307 past a threshold
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _DS1307_SLEW_H_
+#define _DS1307_SLEW_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include "DS1307.h"
+#include "DS1307_timestamp.h"
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+
+/**
+ * @brief  Slew handler
+ * @note   Corrected time = time of timestamp service + Offset. Offset moves
+ *         towards Offset + Pending by at most MaxPpm of elapsed time.
+ */
+typedef struct DS1307_Slew_s
+{
+  DS1307_Timestamp_t *Timestamp;
+  uint32_t  MaxPpm;       // bound of slew rate in ppm (adjtime uses 500)
+  uint32_t  ThresholdUs;  // |Offset| that makes DS1307_Slew_Commit rewrite the chip
+
+  int64_t   Offset;       // applied correction in us
+  int64_t   Pending;      // correction left to apply in us
+  uint32_t  Remainder;    // fraction of slew budget carried between updates
+  uint64_t  LastRaw;      // time of timestamp service at last update
+  uint64_t  LastOut;      // last returned time
+  uint8_t   Started;
+} DS1307_Slew_t;
+
+
+
+/**
+ ==================================================================================
+                             ##### Functions #####                                 
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize slew handler
+ * @param  Slew: Pointer to slew handler
+ * @param  Timestamp: Pointer to initialized timestamp service
+ * @param  MaxPpm: Maximum slew rate in ppm (1 to 500000)
+ * @param  ThresholdUs: Correction in us that is written to the chip (0: never)
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_Slew_Init(DS1307_Slew_t *Slew, DS1307_Timestamp_t *Timestamp,
+                 uint32_t MaxPpm, uint32_t ThresholdUs);
+
+
+/**
+ * @brief  Request a gradual correction (like adjtime)
+ * @note   The request replaces any correction that is still pending.
+ * @param  Slew: Pointer to slew handler
+ * @param  DeltaUs: Correction in us (positive: clock is late)
+ * @param  RemainingUs: Pointer to the pending correction that was replaced
+ *                      (NULL if not needed)
+ * @retval None
+ */
+void
+DS1307_Slew_Adjust(DS1307_Slew_t *Slew, int64_t DeltaUs, int64_t *RemainingUs);
+
+
+/**
+ * @brief  Request a gradual correction towards a reference time
+ * @param  Slew: Pointer to slew handler
+ * @param  TargetUs: Reference time in microseconds since 1970-01-01 00:00:00
+ * @retval None
+ */
+void
+DS1307_Slew_SetUs(DS1307_Slew_t *Slew, uint64_t TargetUs);
+
+
+/**
+ * @brief  Get corrected time in microseconds since 1970-01-01 00:00:00
+ * @note   No I2C access is made by this function. Returned values never
+ *         decrease.
+ * @param  Slew: Pointer to slew handler
+ * @param  Micros: Pointer to timestamp
+ * @retval None
+ */
+void
+DS1307_Slew_GetUs(DS1307_Slew_t *Slew, uint64_t *Micros);
+
+
+/**
+ * @brief  Write the applied correction to DS1307 if it passed the threshold
+ * @note   Whole seconds of Offset are moved into the chip and the timestamp
+ *         service is re-synchronized (up to 2 s). Call it from a background
+ *         task; corrected time stays monotonic across the rewrite.
+ * @param  Slew: Pointer to slew handler
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful (or nothing to do).
+ *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
+ */
+DS1307_Result_t
+DS1307_Slew_Commit(DS1307_Slew_t *Slew);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif //! _DS1307_SLEW_H_
@@ -0,0 +1,187 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_timestamp.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  DS1307 sub-second timestamp service
+ *         Functionalities of the this file:
+ *          + Count SQW/OUT edges of DS1307 (hardware counter or ISR)
+ *          + Combine edge count with RTC seconds into 64-bit timestamps
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _DS1307_TIMESTAMP_H_
+#define _DS1307_TIMESTAMP_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include "DS1307.h"
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+
+/**
+ * @brief  Function type for reading a free-running hardware counter that is
+ *         clocked by the SQW/OUT pin of DS1307.
+ * @retval Current counter value
+ */
+typedef uint32_t (*DS1307_TimestampCounter_t)(void);
+
+/**
+ * @brief  Timestamp service handler
+ * @note   All fields are managed by library functions.
+ */
+typedef struct DS1307_Timestamp_s
+{
+  DS1307_Handler_t *Handler;
+  // Reads the hardware counter. If NULL, DS1307_Timestamp_EdgeISR is used.
+  DS1307_TimestampCounter_t GetCounter;
+  // Mask of valid bits of the counter (e.g. 0xFFFF for a 16-bit timer)
+  uint32_t CounterMask;
+  // Frequency of SQW/OUT in Hz
+  uint32_t Frequency;
+  // Edge counter of ISR fallback
+  volatile uint32_t IsrCounter;
+  // Counter value of the last update
+  uint32_t LastCount;
+  // Number of edges since the reference second transition
+  uint64_t Elapsed;
+  // Unix time of the reference second transition
+  uint32_t UnixRef;
+} DS1307_Timestamp_t;
+
+
+/* Functionality Options --------------------------------------------------------*/
+/**
+ * @brief  Time limit of the wait for a second transition in
+ *         DS1307_Timestamp_Sync (used when PlatformGetTimeUs is set).
+ */
+#ifndef DS1307_TIMESTAMP_SYNC_TIMEOUT_US
+#define DS1307_TIMESTAMP_SYNC_TIMEOUT_US  1100000
+#endif
+
+/**
+ * @brief  Maximum number of polls of SECOND register while waiting for a second
+ *         transition in DS1307_Timestamp_Sync (used without PlatformGetTimeUs).
+ * @note   A poll takes about 0.4 ms at 100 kHz, the default covers 1.2 s.
+ */
+#ifndef DS1307_TIMESTAMP_SYNC_POLLS
+#define DS1307_TIMESTAMP_SYNC_POLLS   3000
+#endif
+
+
+
+/**
+ ==================================================================================
+                             ##### Functions #####                                 
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize timestamp service
+ * @note   The SQW/OUT pin of DS1307 must be connected to the input of the
+ *         hardware counter (or to the interrupt pin that calls
+ *         DS1307_Timestamp_EdgeISR).
+ * @param  Timestamp: Pointer to timestamp handler
+ * @param  Handler: Pointer to initialized DS1307 handler
+ * @param  OutWave: Frequency of SQW/OUT
+ *         - DS1307_OutWave_4KHz
+ *         - DS1307_OutWave_8KHz
+ *         - DS1307_OutWave_32KHz
+ * @param  GetCounter: Hardware counter read function. NULL to use ISR counter.
+ * @param  CounterBits: Width of hardware counter in bits (1 to 32). It is
+ *                      ignored if GetCounter is NULL.
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_Timestamp_Init(DS1307_Timestamp_t *Timestamp, DS1307_Handler_t *Handler,
+                      DS1307_OutWave_t OutWave,
+                      DS1307_TimestampCounter_t GetCounter, uint8_t CounterBits);
+
+
+/**
+ * @brief  Align edge counter with the RTC seconds
+ * @note   This function waits for a second transition of DS1307 (up to 1 s).
+ *         Call it once after initialization and whenever edges may have been
+ *         lost (e.g. counter stopped in sleep mode).
+ * @param  Timestamp: Pointer to timestamp handler
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data or oscillator is halted.
+ */
+DS1307_Result_t
+DS1307_Timestamp_Sync(DS1307_Timestamp_t *Timestamp);
+
+
+/**
+ * @brief  Count one edge of SQW/OUT
+ * @note   Call this function from the edge interrupt when no hardware counter
+ *         is available.
+ * @param  Timestamp: Pointer to timestamp handler
+ * @retval None
+ */
+void
+DS1307_Timestamp_EdgeISR(DS1307_Timestamp_t *Timestamp);
+
+
+/**
+ * @brief  Get timestamp in microseconds since 1970-01-01 00:00:00
+ * @note   No I2C access is made by this function.
+ * @note   This function must be called at least once per counter wrap period
+ *         (2^CounterBits / Frequency seconds).
+ * @param  Timestamp: Pointer to timestamp handler
+ * @param  Micros: Pointer to timestamp
+ * @retval None
+ */
+void
+DS1307_Timestamp_GetUs(DS1307_Timestamp_t *Timestamp, uint64_t *Micros);
+
+
+/**
+ * @brief  Get timestamp in milliseconds since 1970-01-01 00:00:00
+ * @note   No I2C access is made by this function.
+ * @param  Timestamp: Pointer to timestamp handler
+ * @param  Millis: Pointer to timestamp
+ * @retval None
+ */
+void
+DS1307_Timestamp_GetMs(DS1307_Timestamp_t *Timestamp, uint64_t *Millis);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif //! _DS1307_TIMESTAMP_H_
@@ -0,0 +1,179 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_trace.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  DS1307 bus trace record/replay
+ *         Functionalities of the this file:
+ *          + Record every platform transaction to a compact binary trace
+ *          + Replay a trace through the driver without hardware
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _DS1307_TRACE_H_
+#define _DS1307_TRACE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include "DS1307.h"
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+
+/**
+ * @brief  Function type for writing trace bytes (file, UART, flash, ...)
+ * @retval 0 on success, negative on failure
+ */
+typedef int8_t (*DS1307_TraceWrite_t)(const uint8_t *Data, uint16_t Len);
+
+/**
+ * @brief  Function type for reading trace bytes
+ * @retval 0 on success, negative on failure or end of trace
+ */
+typedef int8_t (*DS1307_TraceRead_t)(uint8_t *Data, uint16_t Len);
+
+/**
+ * @brief  Function type for getting a timestamp in microseconds
+ */
+typedef uint32_t (*DS1307_TraceTime_t)(void);
+
+/**
+ * @brief  Trace record header
+ * @note   Trace = "D1T" + version byte, followed by records. Each record is
+ *         DS1307_TRACE_HEADER_SIZE bytes of header, little endian:
+ *         [Flags][Address][Result][Len][Timestamp (4 bytes)]
+ *         followed by Len bytes of payload (data sent or received).
+ *         A DS1307_TRACE_WRITEREAD record has [TxLen][TxData][RxData] as
+ *         payload. A DS1307_TRACE_SELECT record (PlatformSelect, e.g. mux
+ *         channel select) has no payload and Address 0.
+ */
+typedef struct DS1307_TraceRecord_s
+{
+  uint8_t   Flags;      // record type, 0 for send
+  uint8_t   Address;
+  int8_t    Result;     // return value of platform function
+  uint8_t   Len;
+  uint32_t  Timestamp;  // microseconds, start of transaction
+} DS1307_TraceRecord_t;
+
+
+/* Exported Constants -----------------------------------------------------------*/
+#define DS1307_TRACE_MAGIC        "D1T"
+#define DS1307_TRACE_VERSION      2
+#define DS1307_TRACE_HEADER_SIZE  8
+#define DS1307_TRACE_RECEIVE      0x01
+#define DS1307_TRACE_WRITEREAD    0x02
+#define DS1307_TRACE_SELECT       0x04
+
+
+
+/**
+ ==================================================================================
+                             ##### Functions #####                                 
+ ==================================================================================
+ */
+
+/**
+ * @brief  Start recording transactions of a handler
+ * @note   Only one trace session can be active at a time. Call it after the
+ *         platform-dependent part of handler is initialized (and after
+ *         DS1307_Mux_Attach, if used). Send, Receive, WriteRead and Select
+ *         calls are recorded.
+ * @param  Handler: Pointer to handler
+ * @param  Write: Trace sink
+ * @param  GetTimeUs: Timestamp source (NULL to record zeros)
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to write trace header or a session is active.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_Trace_StartRecord(DS1307_Handler_t *Handler, DS1307_TraceWrite_t Write,
+                         DS1307_TraceTime_t GetTimeUs);
+
+
+/**
+ * @brief  Replace the platform of a handler with a recorded trace
+ * @note   Sent data is compared with the trace; differences are counted by
+ *         DS1307_Trace_Mismatches. Recorded results are returned as is.
+ *         PlatformWriteRead and PlatformSelect are replayed only if the
+ *         handler has them, so it must be set up like the recorded one.
+ *         PlatformGetTimeUs (if set) returns the recorded time of the next
+ *         transfer and PlatformDelay (if set) returns at once, so timeouts
+ *         and retry budgets see the recorded timing.
+ *         Version 1 traces (no WriteRead and Select records) are accepted.
+ * @param  Handler: Pointer to handler
+ * @param  Read: Trace source
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Invalid trace header or a session is active.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_Trace_StartReplay(DS1307_Handler_t *Handler, DS1307_TraceRead_t Read);
+
+
+/**
+ * @brief  Stop trace session and restore original platform functions
+ * @param  Handler: Pointer to handler
+ * @retval None
+ */
+void
+DS1307_Trace_Stop(DS1307_Handler_t *Handler);
+
+
+/**
+ * @brief  Number of replayed transactions that differ from the trace
+ * @retval Number of mismatches
+ */
+uint32_t
+DS1307_Trace_Mismatches(void);
+
+
+/**
+ * @brief  Read next record of a trace (for trace analysis tools)
+ * @param  Read: Trace source (positioned after the trace magic)
+ * @param  Record: Pointer to record header
+ * @param  Payload: Buffer of 255 bytes for payload
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: End of trace.
+ */
+DS1307_Result_t
+DS1307_Trace_ReadRecord(DS1307_TraceRead_t Read, DS1307_TraceRecord_t *Record,
+                        uint8_t *Payload);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif //! _DS1307_TRACE_H_
@@ -0,0 +1,494 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_bbsim.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Pin-level simulator of a DS1307 on a bit-banged I2C bus
+ *         Functionalities of the this file:
+ *          + GPIO callbacks for port/BitBang running in virtual time
+ *          + DS1307 slave decoding SCL/SDA edges
+ *          + Standard mode timing checks
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include "DS1307_bbsim.h"
+#include "DS1307_sim.h"
+#include <stddef.h>
+#include <string.h>
+
+
+/* Private Constants ------------------------------------------------------------*/
+#define BBSIM_ADDRESS   0x68
+
+
+/* Private Typedef --------------------------------------------------------------*/
+typedef enum BBSim_State_e
+{
+  BBSim_State_Idle = 0,   // no transfer or not addressed
+  BBSim_State_Address,    // receiving the address byte
+  BBSim_State_Write,      // receiving register pointer and data
+  BBSim_State_Read        // sending registers
+} BBSim_State_t;
+
+
+/* Private Variables ------------------------------------------------------------*/
+static const char *const CheckNames[DS1307_BBSimCheck_Count] =
+{
+  "period", "tLOW", "tHIGH", "tHD;STA", "tSU;STA", "tSU;STO", "tBUF", "tSU;DAT"
+};
+
+static const uint32_t CheckLimits[DS1307_BBSimCheck_Count] =
+{
+  10000, 4700, 4000, 4000, 4700, 4000, 4700, 250
+};
+
+static DS1307_BBSimOptions_t Options = {100, 0};
+static DS1307_BBSimStats_t Stats;
+static uint64_t Now = 0;      // virtual time in ns
+static uint32_t SyncedUs = 0; // virtual time given to the DS1307 model
+
+// lines: 1 released, 0 driven low
+static uint8_t MasterScl = 1, MasterSda = 1;
+static uint8_t SlaveSda = 1;
+static uint8_t SlaveHold = 0; // slave stretches SCL until HoldUntil
+static uint64_t HoldUntil = 0;
+static uint8_t BusScl = 1, BusSda = 1;
+
+// timing of the last events
+static uint64_t SclRise = 0, SclFall = 0, SdaChange = 0, Start = 0, Stop = 0;
+static uint8_t RiseValid = 0, FallValid = 0, StopValid = 0, StartPending = 0;
+
+// slave protocol
+static BBSim_State_t State = BBSim_State_Idle;
+static uint8_t Receiving = 0;
+static uint8_t Bit = 0;
+static uint8_t Shift = 0;
+static uint8_t First = 0;
+static uint8_t ReadMode = 0;
+static uint8_t Pointer = 0;
+static uint8_t MasterAck = 0;
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####                           
+ ==================================================================================
+ */
+
+static void
+BBSim_Check(DS1307_BBSimCheck_t Check, uint64_t Ns)
+{
+  if (Ns < Stats.WorstNs[Check])
+    Stats.WorstNs[Check] = (uint32_t)Ns;
+  if (Ns < CheckLimits[Check])
+    Stats.Violations[Check]++;
+}
+
+
+static void
+BBSim_Stretch(uint64_t At)
+{
+  if (!Options.StretchUs)
+    return;
+
+  SlaveHold = 1;
+  HoldUntil = At + (uint64_t)Options.StretchUs * 1000;
+}
+
+
+static void
+BBSim_LoadByte(void)
+{
+  Shift = DS1307_Sim_Registers()[Pointer];
+  Pointer = (Pointer + 1) & 0x3F;
+  SlaveSda = (Shift >> 7) & 1;
+}
+
+
+static void
+BBSim_ByteReceived(void)
+{
+  uint8_t *Regs = DS1307_Sim_Registers();
+
+  if (State == BBSim_State_Address)
+  {
+    if ((Shift >> 1) != BBSIM_ADDRESS)
+    {
+      State = BBSim_State_Idle;
+      return;
+    }
+    ReadMode = Shift & 1;
+    First = 1;
+  }
+  else if (First)
+  {
+    Pointer = Shift & 0x3F;
+    First = 0;
+    Stats.Bytes++;
+  }
+  else
+  {
+    Regs[Pointer] = Shift;
+    Pointer = (Pointer + 1) & 0x3F;
+    Stats.Bytes++;
+  }
+
+  SlaveSda = 0; // ACK
+}
+
+
+static void
+BBSim_SclRise(uint64_t At)
+{
+  if (FallValid)
+  {
+    BBSim_Check(DS1307_BBSimCheck_Low, At - SclFall);
+    if (SdaChange > SclFall)
+      BBSim_Check(DS1307_BBSimCheck_SetupData, At - SdaChange);
+    Stats.ClockNs += At - SclFall;
+  }
+  if (RiseValid)
+    BBSim_Check(DS1307_BBSimCheck_Period, At - SclRise);
+
+  SclRise = At;
+  RiseValid = FallValid;
+
+  if (State == BBSim_State_Idle || StartPending)
+    return;
+
+  if (Bit < 8 && Receiving)
+    Shift = (uint8_t)((Shift << 1) | BusSda);
+  else if (Bit == 8 && !Receiving)
+    MasterAck = !BusSda;
+}
+
+
+static void
+BBSim_SclFall(uint64_t At)
+{
+  if (StartPending)
+  {
+    BBSim_Check(DS1307_BBSimCheck_HoldStart, At - Start);
+    StartPending = 0;
+  }
+  else
+  {
+    BBSim_Check(DS1307_BBSimCheck_High, At - SclRise);
+    Stats.ClockNs += At - SclRise;
+    Stats.Clocks++;
+  }
+  SclFall = At;
+  FallValid = 1;
+
+  if (State == BBSim_State_Idle || !RiseValid)
+    return; // first fall after START
+
+  if (Bit < 7)
+  {
+    Bit++;
+    if (!Receiving)
+      SlaveSda = (Shift >> (7 - Bit)) & 1;
+  }
+  else if (Bit == 7)
+  {
+    Bit = 8;
+    if (Receiving)
+    {
+      BBSim_ByteReceived();
+    }
+    else
+    {
+      SlaveSda = 1; // master drives ACK
+      Stats.Bytes++;
+    }
+  }
+  else
+  {
+    Bit = 0;
+    SlaveSda = 1;
+    BBSim_Stretch(At);
+
+    if (State == BBSim_State_Address)
+    {
+      State = ReadMode ? BBSim_State_Read : BBSim_State_Write;
+      Receiving = !ReadMode;
+      Shift = 0;
+      if (ReadMode)
+        BBSim_LoadByte();
+    }
+    else if (State == BBSim_State_Read)
+    {
+      if (MasterAck)
+        BBSim_LoadByte();
+      else
+        State = BBSim_State_Idle;
+    }
+    else
+    {
+      Shift = 0;
+    }
+  }
+}
+
+
+static void
+BBSim_SdaEdge(uint64_t At)
+{
+  if (!BusScl)
+  {
+    SdaChange = At;
+    return;
+  }
+
+  if (!BusSda)
+  {
+    // START or repeated START
+    if (State != BBSim_State_Idle || RiseValid)
+      BBSim_Check(DS1307_BBSimCheck_SetupStart, At - SclRise);
+    else if (StopValid)
+      BBSim_Check(DS1307_BBSimCheck_Free, At - Stop);
+
+    Stats.Starts++;
+    Start = At;
+    StartPending = 1;
+    RiseValid = 0;
+    FallValid = 0;
+    State = BBSim_State_Address;
+    Receiving = 1;
+    Bit = 0;
+    Shift = 0;
+    SlaveSda = 1;
+  }
+  else
+  {
+    // STOP
+    BBSim_Check(DS1307_BBSimCheck_SetupStop, At - SclRise);
+    Stats.Stops++;
+    Stop = At;
+    StopValid = 1;
+    RiseValid = 0;
+    FallValid = 0;
+    State = BBSim_State_Idle;
+    SlaveSda = 1;
+  }
+}
+
+
+/**
+ * @brief  Detect edges of the wired-AND lines at time At
+ */
+static void
+BBSim_Lines(uint64_t At)
+{
+  uint8_t Scl = MasterScl && !SlaveHold;
+
+  if (Scl != BusScl)
+  {
+    BusScl = Scl;
+    if (Scl)
+      BBSim_SclRise(At);
+    else
+      BBSim_SclFall(At);
+  }
+
+  // the slave changes SDA only while SCL is low
+  if ((MasterSda && SlaveSda) != BusSda)
+  {
+    BusSda = MasterSda && SlaveSda;
+    BBSim_SdaEdge(At);
+  }
+}
+
+
+static void
+BBSim_Advance(uint64_t Ns)
+{
+  uint32_t Us;
+
+  Now += Ns;
+  if (SlaveHold && Now >= HoldUntil)
+  {
+    SlaveHold = 0;
+    BBSim_Lines(HoldUntil);
+  }
+
+  Us = (uint32_t)(Now / 1000);
+  if (Us != SyncedUs)
+  {
+    DS1307_Sim_Advance(Us - SyncedUs);
+    SyncedUs = Us;
+  }
+}
+
+
+static void
+Pin_SclWrite(uint8_t Level)
+{
+  BBSim_Advance(Options.CallNs);
+  MasterScl = (Level != 0);
+  BBSim_Lines(Now);
+}
+
+
+static void
+Pin_SdaWrite(uint8_t Level)
+{
+  BBSim_Advance(Options.CallNs);
+  MasterSda = (Level != 0);
+  BBSim_Lines(Now);
+}
+
+
+static uint8_t
+Pin_SclRead(void)
+{
+  BBSim_Advance(Options.CallNs);
+  return BusScl;
+}
+
+
+static uint8_t
+Pin_SdaRead(void)
+{
+  BBSim_Advance(Options.CallNs);
+  return BusSda;
+}
+
+
+static void
+Pin_DelayUs(uint32_t Us)
+{
+  BBSim_Advance((uint64_t)Us * 1000);
+}
+
+
+static uint32_t
+Pin_GetTimeUs(void)
+{
+  BBSim_Advance(Options.CallNs);
+  return (uint32_t)(Now / 1000);
+}
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####                           
+ ==================================================================================
+ */
+
+/**
+ * @brief  Reset the simulated bus and DS1307 (oscillator running) and get
+ *         the pin callbacks to pass to DS1307_Platform_SetPins.
+ * @param  Opt: Pointer to options (NULL: 100 ns per callback)
+ * @param  Pins: Pointer to callbacks to fill
+ * @retval None
+ */
+void
+DS1307_BBSim_Init(const DS1307_BBSimOptions_t *Opt,
+                  DS1307_PlatformPins_t *Pins)
+{
+  DS1307_Handler_t Model = {0};
+
+  Options.CallNs = 100;
+  Options.StretchUs = 0;
+  if (Opt)
+    Options = *Opt;
+
+  // the register file and oscillator of the virtual-time simulator
+  DS1307_Sim_Init(&Model);
+  DS1307_Sim_Registers()[0] &= 0x7F;
+  SyncedUs = 0;
+  Now = 0;
+
+  MasterScl = MasterSda = SlaveSda = 1;
+  BusScl = BusSda = 1;
+  SlaveHold = 0;
+  RiseValid = FallValid = StopValid = StartPending = 0;
+  State = BBSim_State_Idle;
+  DS1307_BBSim_GetStats(NULL);
+
+  Pins->SclWrite = Pin_SclWrite;
+  Pins->SdaWrite = Pin_SdaWrite;
+  Pins->SdaRead = Pin_SdaRead;
+  Pins->SclRead = Pin_SclRead;
+  Pins->DelayUs = Pin_DelayUs;
+  Pins->GetTimeUs = Pin_GetTimeUs;
+}
+
+
+/**
+ * @brief  Get and reset statistics
+ * @param  Out: Pointer to statistics (NULL: reset only)
+ * @retval None
+ */
+void
+DS1307_BBSim_GetStats(DS1307_BBSimStats_t *Out)
+{
+  uint8_t i;
+
+  if (Out)
+    *Out = Stats;
+
+  memset(&Stats, 0, sizeof(Stats));
+  for (i = 0; i < DS1307_BBSimCheck_Count; i++)
+    Stats.WorstNs[i] = UINT32_MAX;
+}
+
+
+/**
+ * @brief  Get virtual time
+ * @retval Virtual time in nanoseconds
+ */
+uint64_t
+DS1307_BBSim_GetTimeNs(void)
+{
+  return Now;
+}
+
+
+/**
+ * @brief  Name of a timing check
+ * @param  Check: Timing check
+ * @retval Name (e.g. "tLOW")
+ */
+const char *
+DS1307_BBSim_CheckName(DS1307_BBSimCheck_t Check)
+{
+  return Check < DS1307_BBSimCheck_Count ? CheckNames[Check] : "?";
+}
+
+
+/**
+ * @brief  Minimum of a timing check
+ * @param  Check: Timing check
+ * @retval Minimum time in nanoseconds
+ */
+uint32_t
+DS1307_BBSim_CheckLimitNs(DS1307_BBSimCheck_t Check)
+{
+  return Check < DS1307_BBSimCheck_Count ? CheckLimits[Check] : 0;
+}
@@ -0,0 +1,151 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_bbsim.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Pin-level simulator of a DS1307 on a bit-banged I2C bus
+ *         Functionalities of the this file:
+ *          + GPIO callbacks for port/BitBang running in virtual time
+ *          + DS1307 slave decoding SCL/SDA edges
+ *          + Standard mode timing checks
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _DS1307_BBSIM_H_
+#define _DS1307_BBSIM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include "DS1307.h"
+#include "DS1307_platform.h"
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+
+/**
+ * @brief  Timing checks (I2C standard mode limits of the DS1307 datasheet)
+ */
+typedef enum DS1307_BBSimCheck_e
+{
+  DS1307_BBSimCheck_Period = 0, // SCL period         >= 10 us (fSCL <= 100 kHz)
+  DS1307_BBSimCheck_Low,        // tLOW               >= 4.7 us
+  DS1307_BBSimCheck_High,       // tHIGH              >= 4.0 us
+  DS1307_BBSimCheck_HoldStart,  // tHD;STA            >= 4.0 us
+  DS1307_BBSimCheck_SetupStart, // tSU;STA (repeated) >= 4.7 us
+  DS1307_BBSimCheck_SetupStop,  // tSU;STO            >= 4.0 us
+  DS1307_BBSimCheck_Free,       // tBUF               >= 4.7 us
+  DS1307_BBSimCheck_SetupData,  // tSU;DAT            >= 250 ns
+  DS1307_BBSimCheck_Count
+} DS1307_BBSimCheck_t;
+
+/**
+ * @brief  Simulator options
+ */
+typedef struct DS1307_BBSimOptions_s
+{
+  uint32_t  CallNs;     // time spent in each pin callback (CPU and GPIO cost)
+  uint32_t  StretchUs;  // SCL held low by the slave after each ACK (0: none)
+} DS1307_BBSimOptions_t;
+
+/**
+ * @brief  Simulator statistics
+ */
+typedef struct DS1307_BBSimStats_s
+{
+  uint32_t  Starts;     // START and repeated START conditions
+  uint32_t  Stops;      // STOP conditions
+  uint32_t  Bytes;      // bytes acknowledged or read by the master
+  uint32_t  Clocks;     // SCL pulses
+  uint64_t  ClockNs;    // SCL high and low time of all pulses
+  uint32_t  Violations[DS1307_BBSimCheck_Count];
+  uint32_t  WorstNs[DS1307_BBSimCheck_Count]; // shortest time measured
+} DS1307_BBSimStats_t;
+
+
+
+/**
+ ==================================================================================
+                             ##### Functions #####                                 
+ ==================================================================================
+ */
+
+/**
+ * @brief  Reset the simulated bus and DS1307 (oscillator running) and get
+ *         the pin callbacks to pass to DS1307_Platform_SetPins.
+ * @param  Opt: Pointer to options (NULL: 100 ns per callback)
+ * @param  Pins: Pointer to callbacks to fill
+ * @retval None
+ */
+void
+DS1307_BBSim_Init(const DS1307_BBSimOptions_t *Opt,
+                  DS1307_PlatformPins_t *Pins);
+
+
+/**
+ * @brief  Get and reset statistics
+ * @param  Out: Pointer to statistics (NULL: reset only)
+ * @retval None
+ */
+void
+DS1307_BBSim_GetStats(DS1307_BBSimStats_t *Out);
+
+
+/**
+ * @brief  Get virtual time
+ * @retval Virtual time in nanoseconds
+ */
+uint64_t
+DS1307_BBSim_GetTimeNs(void);
+
+
+/**
+ * @brief  Name of a timing check
+ * @param  Check: Timing check
+ * @retval Name (e.g. "tLOW")
+ */
+const char *
+DS1307_BBSim_CheckName(DS1307_BBSimCheck_t Check);
+
+
+/**
+ * @brief  Minimum of a timing check
+ * @param  Check: Timing check
+ * @retval Minimum time in nanoseconds
+ */
+uint32_t
+DS1307_BBSim_CheckLimitNs(DS1307_BBSimCheck_t Check);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif //! _DS1307_BBSIM_H_
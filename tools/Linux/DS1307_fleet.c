@@ -0,0 +1,340 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_fleet.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  DS1307 parallel fleet provisioning (Linux)
+ *         Functionalities of the this file:
+ *          + Write date and time, output wave and RAM to many boards at once
+ *          + Align the seconds write of all boards to the same whole second
+ *          + Verify every board with a single read-back
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include "DS1307_fleet.h"
+#include <errno.h>
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+
+
+/* Private Constants ------------------------------------------------------------*/
+#define NS_PER_S    1000000000LL
+#define NS_PER_US   1000LL
+
+
+/* Private Data Types -----------------------------------------------------------*/
+typedef struct DS1307_Fleet_s
+{
+  DS1307_FleetBoard_t       *Boards;
+  uint16_t                  Count;
+  const DS1307_FleetImage_t *Image;
+  uint8_t                   Workers;
+  uint16_t                  Waves;
+  DS1307_FleetOpen_t        Open;
+  DS1307_FleetClose_t       Close;
+  pthread_barrier_t         Barrier;
+  pthread_mutex_t           Gate;       // held while the pool is created
+  uint8_t                   Abort;
+  int64_t                   TargetNs;   // whole second of the current wave
+} DS1307_Fleet_t;
+
+typedef struct DS1307_FleetWorker_s
+{
+  DS1307_Fleet_t  *Fleet;
+  uint8_t         Index;
+  pthread_t       Thread;
+} DS1307_FleetWorker_t;
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####                           
+ ==================================================================================
+ */
+
+static int64_t
+DS1307_Fleet_RealNs(void)
+{
+  struct timespec Time;
+
+  clock_gettime(CLOCK_REALTIME, &Time);
+  return (int64_t)Time.tv_sec * NS_PER_S + Time.tv_nsec;
+}
+
+static void
+DS1307_Fleet_SleepUntil(int64_t RealNs)
+{
+  struct timespec Time = {(time_t)(RealNs / NS_PER_S), (long)(RealNs % NS_PER_S)};
+
+  while (clock_nanosleep(CLOCK_REALTIME, TIMER_ABSTIME, &Time, NULL) == EINTR)
+    continue;
+}
+
+static int8_t
+DS1307_Fleet_OpenDevice(DS1307_FleetBoard_t *Board)
+{
+  return DS1307_Platform_OpenDevice(&Board->Handler, &Board->Device, Board->Path);
+}
+
+static void
+DS1307_Fleet_CloseDevice(DS1307_FleetBoard_t *Board)
+{
+  DS1307_Platform_CloseDevice(&Board->Device);
+}
+
+// open and probe the board, returns the lead of the SECOND write in us
+static uint32_t
+DS1307_Fleet_Prepare(DS1307_Fleet_t *Fleet, DS1307_FleetBoard_t *Board)
+{
+  DS1307_DateTime_t DateTime;
+  DS1307_Probe_t Probe;
+  int64_t Start = 0;
+
+  memset(&Board->Handler, 0, sizeof(Board->Handler));
+  if (Fleet->Open(Board) < 0)
+  {
+    Board->Result = DS1307_FAIL;
+    return 0;
+  }
+
+  if ((Board->Result = DS1307_InitProbe(&Board->Handler, &Probe)) != DS1307_OK)
+    return 0;
+
+  // SECOND is the 3rd byte of the write, about 3/4 into a 1-byte register read
+  Start = DS1307_Fleet_RealNs();
+  Board->Result = DS1307_GetFields(&Board->Handler, DS1307_Field_Second, &DateTime);
+  return (uint32_t)((DS1307_Fleet_RealNs() - Start) / NS_PER_US * 3 / 4);
+}
+
+static void
+DS1307_Fleet_Write(DS1307_Fleet_t *Fleet, DS1307_FleetBoard_t *Board,
+                   uint32_t LeadUs)
+{
+  DS1307_DateTime_t DateTime;
+  DS1307_Probe_t Probe;
+  uint8_t Ram[sizeof(Fleet->Image->Ram)];
+  uint32_t Unix = (uint32_t)(Fleet->TargetNs / NS_PER_S);
+  uint32_t ReadUnix = 0;
+  int64_t Written = 0;
+
+  if (DS1307_UnixToDateTime(Unix, &DateTime) != DS1307_OK)
+  {
+    Board->Result = DS1307_INVALID_PARAM;
+    return;
+  }
+
+  DS1307_Fleet_SleepUntil(Fleet->TargetNs - (int64_t)LeadUs * NS_PER_US);
+  Written = DS1307_Fleet_RealNs() + (int64_t)LeadUs * NS_PER_US;
+  Board->Result = DS1307_WriteImage(&Board->Handler, &DateTime,
+                                    Fleet->Image->OutWave, Fleet->Image->Ram);
+  if (Board->Result != DS1307_OK)
+    return;
+
+  Board->Unix = Unix;
+  Board->SkewUs = (int32_t)((Written - Fleet->TargetNs) / NS_PER_US);
+
+  if ((Board->Result = DS1307_ReadImage(&Board->Handler, &Probe, Ram)) != DS1307_OK)
+    return;
+
+  // the read-back comes right after the write, one tick at most
+  Board->Verified = !Probe.Halted && !Probe.Invalid &&
+                    Probe.OutWave == Fleet->Image->OutWave &&
+                    memcmp(Ram, Fleet->Image->Ram, sizeof(Ram)) == 0 &&
+                    DS1307_DateTimeToUnix(&Probe.DateTime, &ReadUnix) == DS1307_OK &&
+                    ReadUnix - Unix <= 1;
+  if (!Board->Verified)
+    Board->Result = DS1307_FAIL;
+}
+
+static void *
+DS1307_Fleet_Worker(void *Arg)
+{
+  DS1307_FleetWorker_t *Worker = (DS1307_FleetWorker_t *)Arg;
+  DS1307_Fleet_t *Fleet = Worker->Fleet;
+  DS1307_FleetBoard_t *Board = NULL;
+  uint32_t LeadUs = 0;
+  uint16_t Index = 0;
+  uint16_t Wave = 0;
+  int64_t Start = 0;
+
+  pthread_mutex_lock(&Fleet->Gate);
+  pthread_mutex_unlock(&Fleet->Gate);
+  if (Fleet->Abort)
+    return NULL;
+
+  for (Wave = 0; Wave < Fleet->Waves; Wave++)
+  {
+    Index = Wave * Fleet->Workers + Worker->Index;
+    Board = (Index < Fleet->Count) ? &Fleet->Boards[Index] : NULL;
+
+    if (Board)
+    {
+      Start = DS1307_Fleet_RealNs();
+      LeadUs = DS1307_Fleet_Prepare(Fleet, Board);
+    }
+
+    pthread_barrier_wait(&Fleet->Barrier); // boards are prepared
+    pthread_barrier_wait(&Fleet->Barrier); // TargetNs is set
+
+    if (Board)
+    {
+      if (Board->Result == DS1307_OK)
+        DS1307_Fleet_Write(Fleet, Board, LeadUs);
+      if (Board->Handler.PlatformSend)
+        Fleet->Close(Board);
+      Board->DurationUs = (uint32_t)((DS1307_Fleet_RealNs() - Start) / NS_PER_US);
+    }
+  }
+
+  return NULL;
+}
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####                           
+ ==================================================================================
+ */
+
+/**
+ * @brief  Provision boards in parallel
+ * @note   Up to Workers boards form a wave. Every worker opens and probes its
+ *         board, then all of them write the 64-byte image (date and time of
+ *         the same whole second, output wave, RAM) in one burst just before
+ *         that second starts, and verify it with one 64-byte read-back.
+ * @param  Boards: Array of boards (Path filled in)
+ * @param  Count: Number of boards
+ * @param  Image: Pointer to image
+ * @param  Workers: Number of worker threads (1 to DS1307_FLEET_MAX_WORKERS)
+ * @param  Open: Connect handler of a board (NULL: DS1307_Platform_OpenDevice)
+ * @param  Close: Release handler of a board (NULL: DS1307_Platform_CloseDevice)
+ * @param  Stats: Pointer to summary
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Every board is provisioned and verified.
+ *         - DS1307_FAIL: At least one board failed (see Boards[i].Result).
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_Fleet_Provision(DS1307_FleetBoard_t *Boards, uint16_t Count,
+                       const DS1307_FleetImage_t *Image, uint8_t Workers,
+                       DS1307_FleetOpen_t Open, DS1307_FleetClose_t Close,
+                       DS1307_FleetStats_t *Stats)
+{
+  DS1307_FleetWorker_t Pool[DS1307_FLEET_MAX_WORKERS];
+  DS1307_Fleet_t Fleet;
+  int64_t Start = 0;
+  int64_t Target = 0;
+  uint16_t Wave = 0;
+  uint16_t Created = 0;
+  uint8_t First = 1;
+  uint16_t i = 0;
+
+  if (!Boards || !Count || !Image || !Stats ||
+      !Workers || Workers > DS1307_FLEET_MAX_WORKERS)
+    return DS1307_INVALID_PARAM;
+
+  memset(Stats, 0, sizeof(*Stats));
+  for (i = 0; i < Count; i++)
+  {
+    Boards[i].Result = DS1307_FAIL;
+    Boards[i].Unix = 0;
+    Boards[i].SkewUs = 0;
+    Boards[i].DurationUs = 0;
+    Boards[i].Verified = 0;
+  }
+
+  Fleet.Boards = Boards;
+  Fleet.Count = Count;
+  Fleet.Image = Image;
+  Fleet.Workers = (Workers < Count) ? Workers : (uint8_t)Count;
+  Fleet.Waves = (Count + Fleet.Workers - 1) / Fleet.Workers;
+  Fleet.Open = Open ? Open : DS1307_Fleet_OpenDevice;
+  Fleet.Close = Close ? Close : DS1307_Fleet_CloseDevice;
+  Fleet.TargetNs = 0;
+  Fleet.Abort = 0;
+  if (pthread_barrier_init(&Fleet.Barrier, NULL, Fleet.Workers + 1) != 0)
+    return DS1307_FAIL;
+  pthread_mutex_init(&Fleet.Gate, NULL);
+
+  Start = DS1307_Fleet_RealNs();
+  pthread_mutex_lock(&Fleet.Gate);
+  for (Created = 0; Created < Fleet.Workers; Created++)
+  {
+    Pool[Created].Fleet = &Fleet;
+    Pool[Created].Index = (uint8_t)Created;
+    if (pthread_create(&Pool[Created].Thread, NULL,
+                       DS1307_Fleet_Worker, &Pool[Created]) != 0)
+      break;
+  }
+
+  // a partial pool would never pass the barrier, stop it before any board
+  Fleet.Abort = (Created < Fleet.Workers);
+  pthread_mutex_unlock(&Fleet.Gate);
+
+  for (Wave = 0; !Fleet.Abort && Wave < Fleet.Waves; Wave++)
+  {
+    pthread_barrier_wait(&Fleet.Barrier);
+
+    // every board of the wave writes at the same whole second
+    Target = DS1307_Fleet_RealNs() + DS1307_FLEET_MIN_WAIT_US * NS_PER_US;
+    Fleet.TargetNs = (Target / NS_PER_S + 1) * NS_PER_S;
+
+    pthread_barrier_wait(&Fleet.Barrier);
+  }
+
+  for (i = 0; i < Created; i++)
+    pthread_join(Pool[i].Thread, NULL);
+  pthread_barrier_destroy(&Fleet.Barrier);
+  pthread_mutex_destroy(&Fleet.Gate);
+  if (Fleet.Abort)
+    return DS1307_FAIL;
+
+  for (i = 0; i < Count; i++)
+  {
+    if (Boards[i].Result != DS1307_OK)
+      Stats->Failed++;
+    if (!Boards[i].Unix)
+      continue;
+
+    if (First)
+      Stats->SkewMinUs = Stats->SkewMaxUs = Boards[i].SkewUs;
+    First = 0;
+    if (Boards[i].SkewUs < Stats->SkewMinUs)
+      Stats->SkewMinUs = Boards[i].SkewUs;
+    if (Boards[i].SkewUs > Stats->SkewMaxUs)
+      Stats->SkewMaxUs = Boards[i].SkewUs;
+  }
+
+  Stats->Boards = Count;
+  Stats->Waves = Fleet.Waves;
+  Stats->ElapsedUs = (uint32_t)((DS1307_Fleet_RealNs() - Start) / NS_PER_US);
+  Stats->BoardsPerMin = (uint32_t)((uint64_t)(Count - Stats->Failed) * 60000000ULL /
+                                   (Stats->ElapsedUs ? Stats->ElapsedUs : 1));
+
+  return Stats->Failed ? DS1307_FAIL : DS1307_OK;
+}
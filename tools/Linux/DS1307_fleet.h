@@ -0,0 +1,153 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_fleet.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  DS1307 parallel fleet provisioning (Linux)
+ *         Functionalities of the this file:
+ *          + Write date and time, output wave and RAM to many boards at once
+ *          + Align the seconds write of all boards to the same whole second
+ *          + Verify every board with a single read-back
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _DS1307_FLEET_H_
+#define _DS1307_FLEET_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include "DS1307.h"
+#include "DS1307_platform.h"
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+
+/**
+ * @brief  Image written to every board
+ * @note   Date and time is taken from CLOCK_REALTIME at the write.
+ */
+typedef struct DS1307_FleetImage_s
+{
+  DS1307_OutWave_t  OutWave;
+  uint8_t           Ram[56];
+} DS1307_FleetImage_t;
+
+/**
+ * @brief  One board of the fleet
+ */
+typedef struct DS1307_FleetBoard_s
+{
+  const char       *Path;         // i2c-dev adapter of the board
+  DS1307_Result_t   Result;       // result of provisioning
+  uint32_t          Unix;         // second written to the board
+  int32_t           SkewUs;       // SECOND write minus the start of that second
+  uint32_t          DurationUs;   // open to verified
+  uint8_t           Verified;     // read-back matches the image
+
+  DS1307_Handler_t  Handler;
+  DS1307_PlatformDevice_t Device;
+} DS1307_FleetBoard_t;
+
+/**
+ * @brief  Function type for connecting the handler of a board
+ * @retval
+ *         -  0: The operation was successful.
+ *         - -1: Failed.
+ */
+typedef int8_t (*DS1307_FleetOpen_t)(DS1307_FleetBoard_t *Board);
+
+/**
+ * @brief  Function type for releasing the handler of a board
+ */
+typedef void (*DS1307_FleetClose_t)(DS1307_FleetBoard_t *Board);
+
+/**
+ * @brief  Summary of a provisioning run
+ */
+typedef struct DS1307_FleetStats_s
+{
+  uint16_t  Boards;
+  uint16_t  Failed;
+  uint16_t  Waves;          // seconds-aligned write rounds
+  uint32_t  ElapsedUs;
+  uint32_t  BoardsPerMin;   // provisioned (verified) boards per minute
+  int32_t   SkewMinUs;      // over the boards that were written
+  int32_t   SkewMaxUs;
+} DS1307_FleetStats_t;
+
+
+/* Functionality Options --------------------------------------------------------*/
+#define DS1307_FLEET_MAX_WORKERS    64
+
+/**
+ * @brief  Minimum time between the end of board preparation and the whole
+ *         second all boards of a wave write at
+ */
+#define DS1307_FLEET_MIN_WAIT_US    20000
+
+
+
+/**
+ ==================================================================================
+                             ##### Functions #####                                 
+ ==================================================================================
+ */
+
+/**
+ * @brief  Provision boards in parallel
+ * @note   Up to Workers boards form a wave. Every worker opens and probes its
+ *         board, then all of them write the 64-byte image (date and time of
+ *         the same whole second, output wave, RAM) in one burst just before
+ *         that second starts, and verify it with one 64-byte read-back.
+ * @param  Boards: Array of boards (Path filled in)
+ * @param  Count: Number of boards
+ * @param  Image: Pointer to image
+ * @param  Workers: Number of worker threads (1 to DS1307_FLEET_MAX_WORKERS)
+ * @param  Open: Connect handler of a board (NULL: DS1307_Platform_OpenDevice)
+ * @param  Close: Release handler of a board (NULL: DS1307_Platform_CloseDevice)
+ * @param  Stats: Pointer to summary
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Every board is provisioned and verified.
+ *         - DS1307_FAIL: At least one board failed (see Boards[i].Result).
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_Fleet_Provision(DS1307_FleetBoard_t *Boards, uint16_t Count,
+                       const DS1307_FleetImage_t *Image, uint8_t Workers,
+                       DS1307_FleetOpen_t Open, DS1307_FleetClose_t Close,
+                       DS1307_FleetStats_t *Stats);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif //! _DS1307_FLEET_H_
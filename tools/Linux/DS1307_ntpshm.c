@@ -0,0 +1,118 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_ntpshm.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  DS1307 NTP SHM reference clock exporter (Linux)
+ *         Functionalities of the this file:
+ *          + Fill NTP SHM refclock segment (ntpd/chrony driver 28) with DS1307 samples
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include "DS1307_ntpshm.h"
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
+
+/* Private Macro ----------------------------------------------------------------*/
+#define BARRIER()   __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####                           
+ ==================================================================================
+ */
+
+/**
+ * @brief  Attach NTP SHM refclock segment
+ * @note   Units 0 and 1 are only accessible by root (as ntpd/chrony expect).
+ * @param  Unit: Unit number of refclock (0 to 255)
+ * @retval Pointer to segment or NULL on failure
+ */
+DS1307_NtpShm_t *
+DS1307_NtpShm_Attach(uint8_t Unit)
+{
+  DS1307_NtpShm_t *Shm = NULL;
+  int Id = shmget(DS1307_NTPSHM_KEY + Unit, sizeof(DS1307_NtpShm_t),
+                  IPC_CREAT | ((Unit < 2) ? 0600 : 0666));
+
+  if (Id < 0)
+    return NULL;
+
+  Shm = shmat(Id, NULL, 0);
+  if (Shm == (void *)-1)
+    return NULL;
+
+  Shm->Mode = 1;
+  Shm->Valid = 0;
+  Shm->NSamples = 3;
+  return Shm;
+}
+
+
+/**
+ * @brief  Store one sample in NTP SHM refclock segment
+ * @param  Shm: Pointer to segment
+ * @param  ClockTime: Time reported by DS1307
+ * @param  ReceiveTime: CLOCK_REALTIME when ClockTime was valid
+ * @param  Precision: log2 of sample precision in seconds (e.g. -10 for ~1 ms)
+ * @retval None
+ */
+void
+DS1307_NtpShm_Store(DS1307_NtpShm_t *Shm, const struct timespec *ClockTime,
+                    const struct timespec *ReceiveTime, int Precision)
+{
+  Shm->Valid = 0;
+  Shm->Count++;
+  BARRIER();
+
+  Shm->ClockTimeStampSec = ClockTime->tv_sec;
+  Shm->ClockTimeStampUSec = ClockTime->tv_nsec / 1000;
+  Shm->ClockTimeStampNSec = ClockTime->tv_nsec;
+  Shm->ReceiveTimeStampSec = ReceiveTime->tv_sec;
+  Shm->ReceiveTimeStampUSec = ReceiveTime->tv_nsec / 1000;
+  Shm->ReceiveTimeStampNSec = ReceiveTime->tv_nsec;
+  Shm->Leap = 0; // no leap second warning, DS1307 knows nothing about them
+  Shm->Precision = Precision;
+
+  BARRIER();
+  Shm->Count++;
+  Shm->Valid = 1;
+}
+
+
+/**
+ * @brief  Detach NTP SHM refclock segment
+ * @param  Shm: Pointer to segment
+ * @retval None
+ */
+void
+DS1307_NtpShm_Detach(DS1307_NtpShm_t *Shm)
+{
+  Shm->Valid = 0;
+  shmdt(Shm);
+}
@@ -0,0 +1,118 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_ntpshm.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  DS1307 NTP SHM reference clock exporter (Linux)
+ *         Functionalities of the this file:
+ *          + Fill NTP SHM refclock segment (ntpd/chrony driver 28) with DS1307 samples
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _DS1307_NTPSHM_H_
+#define _DS1307_NTPSHM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include <time.h>
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+
+/**
+ * @brief  NTP SHM refclock segment (layout defined by ntpd refclock_shm)
+ */
+typedef struct DS1307_NtpShm_s
+{
+  int               Mode;
+  volatile int      Count;
+  time_t            ClockTimeStampSec;
+  int               ClockTimeStampUSec;
+  time_t            ReceiveTimeStampSec;
+  int               ReceiveTimeStampUSec;
+  int               Leap;
+  int               Precision;
+  int               NSamples;
+  volatile int      Valid;
+  unsigned          ClockTimeStampNSec;
+  unsigned          ReceiveTimeStampNSec;
+  int               Dummy[8];
+} DS1307_NtpShm_t;
+
+
+/* Functionality Options --------------------------------------------------------*/
+#define DS1307_NTPSHM_KEY   0x4e545030 // "NTP0", unit number is added
+
+
+
+/**
+ ==================================================================================
+                             ##### Functions #####                                 
+ ==================================================================================
+ */
+
+/**
+ * @brief  Attach NTP SHM refclock segment
+ * @note   Units 0 and 1 are only accessible by root (as ntpd/chrony expect).
+ * @param  Unit: Unit number of refclock (0 to 255)
+ * @retval Pointer to segment or NULL on failure
+ */
+DS1307_NtpShm_t *
+DS1307_NtpShm_Attach(uint8_t Unit);
+
+
+/**
+ * @brief  Store one sample in NTP SHM refclock segment
+ * @param  Shm: Pointer to segment
+ * @param  ClockTime: Time reported by DS1307
+ * @param  ReceiveTime: CLOCK_REALTIME when ClockTime was valid
+ * @param  Precision: log2 of sample precision in seconds (e.g. -10 for ~1 ms)
+ * @retval None
+ */
+void
+DS1307_NtpShm_Store(DS1307_NtpShm_t *Shm, const struct timespec *ClockTime,
+                    const struct timespec *ReceiveTime, int Precision);
+
+
+/**
+ * @brief  Detach NTP SHM refclock segment
+ * @param  Shm: Pointer to segment
+ * @retval None
+ */
+void
+DS1307_NtpShm_Detach(DS1307_NtpShm_t *Shm);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif //! _DS1307_NTPSHM_H_
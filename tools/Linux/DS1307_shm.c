@@ -0,0 +1,238 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_shm.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  DS1307 time publication through shared memory (Linux)
+ *         Functionalities of the this file:
+ *          + Publish drift-corrected DS1307 time in a seqlock protected segment
+ *          + Read published time without syscalls or I2C access
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include "DS1307_shm.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+
+/* Private Macro ----------------------------------------------------------------*/
+#define LOAD_ACQUIRE(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define FENCE_ACQUIRE()     __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define FENCE_RELEASE()     __atomic_thread_fence(__ATOMIC_RELEASE)
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####                           
+ ==================================================================================
+ */
+
+static void *
+DS1307_Shm_Map(const char *Name, int Flags, int Prot)
+{
+  void *Map = NULL;
+  int Fd = shm_open(Name, Flags, 0644);
+
+  if (Fd < 0)
+    return NULL;
+
+  if ((Flags & O_CREAT) && ftruncate(Fd, sizeof(DS1307_Shm_t)) < 0)
+  {
+    close(Fd);
+    return NULL;
+  }
+
+  Map = mmap(NULL, sizeof(DS1307_Shm_t), Prot, MAP_SHARED, Fd, 0);
+  close(Fd);
+
+  return (Map == MAP_FAILED) ? NULL : Map;
+}
+
+static void
+DS1307_Shm_WriteBegin(DS1307_Shm_t *Shm)
+{
+  STORE_RELEASE(&Shm->Sequence, Shm->Sequence + 1);
+  FENCE_RELEASE();
+}
+
+static void
+DS1307_Shm_WriteEnd(DS1307_Shm_t *Shm)
+{
+  STORE_RELEASE(&Shm->Sequence, Shm->Sequence + 1);
+}
+
+
+
+/**
+ ==================================================================================
+                       ##### Public Publisher Functions #####                      
+ ==================================================================================
+ */
+
+/**
+ * @brief  Create (or open) shared time segment for writing
+ * @param  Name: Name of POSIX shared memory object (e.g. DS1307_SHM_NAME)
+ * @retval Pointer to segment or NULL on failure
+ */
+DS1307_Shm_t *
+DS1307_Shm_Create(const char *Name)
+{
+  DS1307_Shm_t *Shm = DS1307_Shm_Map(Name, O_RDWR | O_CREAT,
+                                     PROT_READ | PROT_WRITE);
+  if (!Shm)
+    return NULL;
+
+  if (Shm->Sequence & 1)
+    Shm->Sequence++; // previous publisher died in the middle of an update
+
+  DS1307_Shm_WriteBegin(Shm);
+  Shm->Magic = DS1307_SHM_MAGIC;
+  Shm->Version = DS1307_SHM_VERSION;
+  Shm->Valid = 0;
+  DS1307_Shm_WriteEnd(Shm);
+
+  return Shm;
+}
+
+
+/**
+ * @brief  Publish new clock parameters
+ * @param  Shm: Pointer to segment
+ * @param  MonoRef: CLOCK_MONOTONIC of the reference point (ns)
+ * @param  UnixRef: DS1307 time of the reference point (ns)
+ * @param  RatePpb: Rate of DS1307 relative to CLOCK_MONOTONIC (ppb)
+ * @retval None
+ */
+void
+DS1307_Shm_Publish(DS1307_Shm_t *Shm, int64_t MonoRef, int64_t UnixRef,
+                   int64_t RatePpb)
+{
+  struct timespec Now;
+
+  clock_gettime(CLOCK_MONOTONIC, &Now);
+
+  DS1307_Shm_WriteBegin(Shm);
+  Shm->MonoRef = MonoRef;
+  Shm->UnixRef = UnixRef;
+  Shm->RatePpb = RatePpb;
+  Shm->Updated = (int64_t)Now.tv_sec * 1000000000LL + Now.tv_nsec;
+  Shm->Valid = 1;
+  DS1307_Shm_WriteEnd(Shm);
+}
+
+
+/**
+ * @brief  Mark published clock as unusable
+ * @param  Shm: Pointer to segment
+ * @retval None
+ */
+void
+DS1307_Shm_Invalidate(DS1307_Shm_t *Shm)
+{
+  DS1307_Shm_WriteBegin(Shm);
+  Shm->Valid = 0;
+  DS1307_Shm_WriteEnd(Shm);
+}
+
+
+
+/**
+ ==================================================================================
+                        ##### Public Reader Functions #####                        
+ ==================================================================================
+ */
+
+/**
+ * @brief  Open shared time segment for reading
+ * @param  Name: Name of POSIX shared memory object (e.g. DS1307_SHM_NAME)
+ * @retval Pointer to segment or NULL on failure
+ */
+const DS1307_Shm_t *
+DS1307_Shm_Open(const char *Name)
+{
+  const DS1307_Shm_t *Shm = DS1307_Shm_Map(Name, O_RDONLY, PROT_READ);
+
+  if (Shm && (Shm->Magic != DS1307_SHM_MAGIC ||
+              Shm->Version != DS1307_SHM_VERSION))
+  {
+    munmap((void *)Shm, sizeof(DS1307_Shm_t));
+    return NULL;
+  }
+
+  return Shm;
+}
+
+
+/**
+ * @brief  Get current DS1307 time
+ * @note   Neither a system call nor an I2C transaction is made.
+ * @param  Shm: Pointer to segment
+ * @param  Time: Pointer to DS1307 time
+ * @retval 
+ *         -  0: The operation was successful.
+ *         - -1: No valid clock is published.
+ *         - -2: Segment is stale (publisher stopped in the middle of an
+ *               update, until a new publisher starts).
+ */
+int
+DS1307_Shm_GetTime(const DS1307_Shm_t *Shm, struct timespec *Time)
+{
+  struct timespec Now;
+  uint32_t Sequence = 0;
+  uint32_t Valid = 0;
+  int64_t MonoRef = 0;
+  int64_t UnixRef = 0;
+  int64_t RatePpb = 0;
+  int64_t Elapsed = 0;
+  int64_t Unix = 0;
+  unsigned long Spins = 0;
+
+  do
+  {
+    while ((Sequence = LOAD_ACQUIRE(&Shm->Sequence)) & 1)
+      if (++Spins >= DS1307_SHM_SPIN_LIMIT)
+        return -2;
+    Valid = Shm->Valid;
+    MonoRef = Shm->MonoRef;
+    UnixRef = Shm->UnixRef;
+    RatePpb = Shm->RatePpb;
+    FENCE_ACQUIRE();
+  } while (Sequence != LOAD_ACQUIRE(&Shm->Sequence));
+
+  if (!Valid)
+    return -1;
+
+  // CLOCK_MONOTONIC is served by vDSO, no system call is made
+  clock_gettime(CLOCK_MONOTONIC, &Now);
+  Elapsed = (int64_t)Now.tv_sec * 1000000000LL + Now.tv_nsec - MonoRef;
+  Unix = UnixRef + Elapsed + (Elapsed / 1000) * RatePpb / 1000000LL;
+
+  Time->tv_sec = Unix / 1000000000LL;
+  Time->tv_nsec = Unix % 1000000000LL;
+  return 0;
+}
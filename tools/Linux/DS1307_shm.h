@@ -0,0 +1,162 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_shm.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  DS1307 time publication through shared memory (Linux)
+ *         Functionalities of the this file:
+ *          + Publish drift-corrected DS1307 time in a seqlock protected segment
+ *          + Read published time without syscalls or I2C access
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _DS1307_SHM_H_
+#define _DS1307_SHM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include <time.h>
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+
+/**
+ * @brief  Shared time segment
+ * @note   Written by one publisher only. Readers must use DS1307_Shm_GetTime.
+ */
+typedef struct DS1307_Shm_s
+{
+  uint32_t Magic;
+  uint32_t Version;
+  // Seqlock counter: odd while the publisher is updating the segment
+  uint32_t Sequence;
+  // Non-zero when the published clock is usable
+  uint32_t Valid;
+  // CLOCK_MONOTONIC of the reference point (ns)
+  int64_t  MonoRef;
+  // DS1307 time of the reference point (ns since 1970-01-01 00:00:00)
+  int64_t  UnixRef;
+  // Rate of DS1307 relative to CLOCK_MONOTONIC (parts per billion)
+  int64_t  RatePpb;
+  // CLOCK_MONOTONIC of the last update (ns)
+  int64_t  Updated;
+} DS1307_Shm_t;
+
+
+/* Functionality Options --------------------------------------------------------*/
+#define DS1307_SHM_NAME     "/ds1307"
+#define DS1307_SHM_MAGIC    0x31333037UL
+#define DS1307_SHM_VERSION  1
+
+/**
+ * @brief  Reads of an odd Sequence after which DS1307_Shm_GetTime gives up.
+ *         An update takes a few stores, so only a publisher that died in the
+ *         middle of one keeps it odd that long.
+ */
+#ifndef DS1307_SHM_SPIN_LIMIT
+#define DS1307_SHM_SPIN_LIMIT 1000000UL
+#endif
+
+
+
+/**
+ ==================================================================================
+                           ##### Publisher Functions #####                         
+ ==================================================================================
+ */
+
+/**
+ * @brief  Create (or open) shared time segment for writing
+ * @param  Name: Name of POSIX shared memory object (e.g. DS1307_SHM_NAME)
+ * @retval Pointer to segment or NULL on failure
+ */
+DS1307_Shm_t *
+DS1307_Shm_Create(const char *Name);
+
+
+/**
+ * @brief  Publish new clock parameters
+ * @param  Shm: Pointer to segment
+ * @param  MonoRef: CLOCK_MONOTONIC of the reference point (ns)
+ * @param  UnixRef: DS1307 time of the reference point (ns)
+ * @param  RatePpb: Rate of DS1307 relative to CLOCK_MONOTONIC (ppb)
+ * @retval None
+ */
+void
+DS1307_Shm_Publish(DS1307_Shm_t *Shm, int64_t MonoRef, int64_t UnixRef,
+                   int64_t RatePpb);
+
+
+/**
+ * @brief  Mark published clock as unusable
+ * @param  Shm: Pointer to segment
+ * @retval None
+ */
+void
+DS1307_Shm_Invalidate(DS1307_Shm_t *Shm);
+
+
+
+/**
+ ==================================================================================
+                            ##### Reader Functions #####                           
+ ==================================================================================
+ */
+
+/**
+ * @brief  Open shared time segment for reading
+ * @param  Name: Name of POSIX shared memory object (e.g. DS1307_SHM_NAME)
+ * @retval Pointer to segment or NULL on failure
+ */
+const DS1307_Shm_t *
+DS1307_Shm_Open(const char *Name);
+
+
+/**
+ * @brief  Get current DS1307 time
+ * @note   Neither a system call nor an I2C transaction is made.
+ * @param  Shm: Pointer to segment
+ * @param  Time: Pointer to DS1307 time
+ * @retval 
+ *         -  0: The operation was successful.
+ *         - -1: No valid clock is published.
+ *         - -2: Segment is stale (publisher stopped in the middle of an
+ *               update, until a new publisher starts).
+ */
+int
+DS1307_Shm_GetTime(const DS1307_Shm_t *Shm, struct timespec *Time);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif //! _DS1307_SHM_H_
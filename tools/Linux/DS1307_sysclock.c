@@ -0,0 +1,231 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_sysclock.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  DS1307 system clock synchronization (Linux)
+ *         Functionalities of the this file:
+ *          + Set CLOCK_REALTIME from a timestamped DS1307 seconds transition
+ *          + Write the DS1307 in phase with CLOCK_REALTIME
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include "DS1307_sysclock.h"
+#include <time.h>
+
+
+/* Private Constants ------------------------------------------------------------*/
+#define NS_PER_S    1000000000LL
+#define NS_PER_US   1000LL
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####                           
+ ==================================================================================
+ */
+
+static int64_t
+DS1307_SysClock_RealNs(void)
+{
+  struct timespec Time;
+
+  clock_gettime(CLOCK_REALTIME, &Time);
+  return (int64_t)Time.tv_sec * NS_PER_S + Time.tv_nsec;
+}
+
+// read PlatformGetTimeUs and CLOCK_REALTIME at the same instant
+static void
+DS1307_SysClock_Pair(DS1307_Handler_t *Handler, uint32_t *Us, int64_t *RealNs)
+{
+  uint32_t Before = Handler->PlatformGetTimeUs();
+
+  *RealNs = DS1307_SysClock_RealNs();
+  *Us = Before + (Handler->PlatformGetTimeUs() - Before) / 2;
+}
+
+static uint16_t
+DS1307_SysClock_MaxReads(const DS1307_SysClock_t *Sync)
+{
+  return Sync->MaxReads ? Sync->MaxReads : DS1307_SYSCLOCK_MAX_READS;
+}
+
+// timestamp the next edge and compute the offset of DS1307, PlatformGetTimeUs
+// is mapped to CLOCK_REALTIME through PairUs/PairNs (taken now if PairNs is 0)
+static DS1307_Result_t
+DS1307_SysClock_Measure(DS1307_Handler_t *Handler, DS1307_SysClock_t *Sync,
+                        uint32_t PollUs, uint32_t *PairUs, int64_t *PairNs)
+{
+  DS1307_SecondEdge_t Edge;
+  DS1307_Result_t Result;
+  int64_t EdgeNs = 0;
+
+  if (!*PairNs)
+    DS1307_SysClock_Pair(Handler, PairUs, PairNs);
+
+  Result = DS1307_FindSecondEdge(Handler, PollUs, DS1307_SysClock_MaxReads(Sync), &Edge);
+  Sync->Reads += Edge.Reads;
+  if (Result != DS1307_OK)
+    return Result;
+
+  if (DS1307_DateTimeToUnix(&Edge.DateTime, &Sync->Unix) != DS1307_OK)
+    return DS1307_FAIL; // DS1307 holds an invalid date
+
+  EdgeNs = *PairNs + (int64_t)(int32_t)(Edge.TimeUs - *PairUs) * NS_PER_US;
+  Sync->UncertaintyUs = (Edge.WindowUs + 1) / 2;
+  Sync->OffsetUs = ((int64_t)Sync->Unix * NS_PER_S - EdgeNs) / NS_PER_US;
+  return DS1307_OK;
+}
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####                           
+ ==================================================================================
+ */
+
+/**
+ * @brief  Set CLOCK_REALTIME from the DS1307 (hctosys)
+ * @note   The next seconds transition of the DS1307 is timestamped with
+ *         PlatformGetTimeUs (CLOCK_MONOTONIC on the Linux port), so the
+ *         system clock gets the sub-second phase of the DS1307 too.
+ *         CAP_SYS_TIME is required unless Sync->DryRun is set.
+ * @param  Handler: Pointer to handler (PlatformGetTimeUs and PlatformDelay
+ *                  are required)
+ * @param  Sync: Pointer to options and results
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data, no transition was
+ *                        seen or clock_settime failed.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_SysClock_HcToSys(DS1307_Handler_t *Handler, DS1307_SysClock_t *Sync)
+{
+  DS1307_Result_t Result;
+  struct timespec Time;
+  uint32_t PairUs = 0;
+  int64_t PairNs = 0;
+  int64_t SetNs = 0;
+
+  if (!Sync || !Handler->PlatformGetTimeUs || !Handler->PlatformDelay)
+    return DS1307_INVALID_PARAM;
+
+  Sync->Reads = 0;
+  if ((Result = DS1307_SysClock_Measure(Handler, Sync, Sync->PollUs,
+                                 &PairUs, &PairNs)) != DS1307_OK)
+    return Result;
+
+  if (Sync->DryRun)
+    return DS1307_OK;
+
+  // the offset holds while CLOCK_REALTIME runs, apply it to a fresh reading
+  SetNs = DS1307_SysClock_RealNs() + Sync->OffsetUs * NS_PER_US;
+  Time.tv_sec = (time_t)(SetNs / NS_PER_S);
+  Time.tv_nsec = (long)(SetNs % NS_PER_S);
+  if (clock_settime(CLOCK_REALTIME, &Time) < 0)
+    return DS1307_FAIL;
+
+  return DS1307_OK;
+}
+
+
+/**
+ * @brief  Set the DS1307 from CLOCK_REALTIME (systohc)
+ * @note   Date and time of the next whole second is written just before that
+ *         second starts, which restarts the countdown chain of the DS1307 in
+ *         phase with the system clock. The next transition is then measured
+ *         to report the achieved offset.
+ * @param  Handler: Pointer to handler (PlatformGetTimeUs and PlatformDelay
+ *                  are required)
+ * @param  Sync: Pointer to options and results
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data or no transition was
+ *                        seen.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid or system time
+ *                                 is out of the DS1307 range.
+ */
+DS1307_Result_t
+DS1307_SysClock_SysToHc(DS1307_Handler_t *Handler, DS1307_SysClock_t *Sync)
+{
+  DS1307_DateTime_t DateTime;
+  DS1307_Result_t Result;
+  uint32_t PairUs = 0;
+  int64_t PairNs = 0;
+  uint32_t LeadUs = 0;
+  int64_t WaitUs = 0;
+  uint32_t WrittenUs = 0;
+  int64_t Target = 0;
+
+  if (!Sync || !Handler->PlatformGetTimeUs || !Handler->PlatformDelay)
+    return DS1307_INVALID_PARAM;
+
+  Sync->Reads = 0;
+  if (Sync->DryRun)
+    return DS1307_SysClock_Measure(Handler, Sync, Sync->PollUs, &PairUs, &PairNs);
+
+  // SECOND is the 3rd byte of the write, about 3/4 into a 1-byte register read
+  Sync->Reads++;
+  LeadUs = Handler->PlatformGetTimeUs();
+  if ((Result = DS1307_GetFields(Handler, DS1307_Field_Second, &DateTime)) != DS1307_OK)
+    return Result;
+  LeadUs = (Handler->PlatformGetTimeUs() - LeadUs) * 3 / 4;
+
+  // a preemption after the pair can eat the wait, then take the next second
+  DS1307_SysClock_Pair(Handler, &PairUs, &PairNs);
+  Target = PairNs / NS_PER_S;
+  do
+  {
+    Target++;
+    WaitUs = (Target * NS_PER_S - PairNs) / NS_PER_US - LeadUs -
+             (uint32_t)(Handler->PlatformGetTimeUs() - PairUs);
+  } while (WaitUs < DS1307_SYSCLOCK_MIN_WAIT_US);
+
+  Sync->Unix = (uint32_t)Target;
+  if (Target > UINT32_MAX ||
+      DS1307_UnixToDateTime(Sync->Unix, &DateTime) != DS1307_OK)
+    return DS1307_INVALID_PARAM;
+
+  Handler->PlatformDelay((uint32_t)WaitUs);
+
+  WrittenUs = Handler->PlatformGetTimeUs() + LeadUs;
+  if ((Result = DS1307_SetDateTimeAligned(Handler, &DateTime)) != DS1307_OK)
+    return Result;
+
+  // the first transition comes 1 s after the write, search it back-to-back
+  WaitUs = 1000000 - DS1307_EDGE_GUARD_US -
+           (int64_t)(uint32_t)(Handler->PlatformGetTimeUs() - WrittenUs);
+  if (WaitUs > 0)
+    Handler->PlatformDelay((uint32_t)WaitUs);
+
+  return DS1307_SysClock_Measure(Handler, Sync, 0, &PairUs, &PairNs);
+}
@@ -0,0 +1,132 @@
+/**
+ **********************************************************************************
+ * @file   DS1307_sysclock.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  DS1307 system clock synchronization (Linux)
+ *         Functionalities of the this file:
+ *          + Set CLOCK_REALTIME from a timestamped DS1307 seconds transition
+ *          + Write the DS1307 in phase with CLOCK_REALTIME
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _DS1307_SYSCLOCK_H_
+#define _DS1307_SYSCLOCK_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include "DS1307.h"
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+
+/**
+ * @brief  Options and results of a system clock synchronization
+ */
+typedef struct DS1307_SysClock_s
+{
+  uint32_t  PollUs;         // delay between coarse reads of SECOND (0: back-to-back)
+  uint16_t  MaxReads;       // reads per edge search (0: DS1307_SYSCLOCK_MAX_READS)
+  uint8_t   DryRun;         // measure only, no clock is changed
+
+  uint16_t  Reads;          // bus reads consumed
+  uint32_t  UncertaintyUs;  // the DS1307 edge is known within +- UncertaintyUs
+  int64_t   OffsetUs;       // DS1307 minus CLOCK_REALTIME before the change
+                            // (after the change for DS1307_SysClock_SysToHc)
+  uint32_t  Unix;           // second read from or written to the DS1307
+} DS1307_SysClock_t;
+
+
+/* Functionality Options --------------------------------------------------------*/
+#define DS1307_SYSCLOCK_MAX_READS   6000
+
+/**
+ * @brief  Minimum time between the aligned write and the whole second it is
+ *         aimed at; otherwise the next whole second is used
+ */
+#define DS1307_SYSCLOCK_MIN_WAIT_US 20000
+
+
+
+/**
+ ==================================================================================
+                             ##### Functions #####                                 
+ ==================================================================================
+ */
+
+/**
+ * @brief  Set CLOCK_REALTIME from the DS1307 (hctosys)
+ * @note   The next seconds transition of the DS1307 is timestamped with
+ *         PlatformGetTimeUs (CLOCK_MONOTONIC on the Linux port), so the
+ *         system clock gets the sub-second phase of the DS1307 too.
+ *         CAP_SYS_TIME is required unless Sync->DryRun is set.
+ * @param  Handler: Pointer to handler (PlatformGetTimeUs and PlatformDelay
+ *                  are required)
+ * @param  Sync: Pointer to options and results
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data, no transition was
+ *                        seen or clock_settime failed.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid.
+ */
+DS1307_Result_t
+DS1307_SysClock_HcToSys(DS1307_Handler_t *Handler, DS1307_SysClock_t *Sync);
+
+
+/**
+ * @brief  Set the DS1307 from CLOCK_REALTIME (systohc)
+ * @note   Date and time of the next whole second is written just before that
+ *         second starts, which restarts the countdown chain of the DS1307 in
+ *         phase with the system clock. The next transition is then measured
+ *         to report the achieved offset.
+ * @param  Handler: Pointer to handler (PlatformGetTimeUs and PlatformDelay
+ *                  are required)
+ * @param  Sync: Pointer to options and results
+ * @retval DS1307_Result_t
+ *         - DS1307_OK: Operation was successful.
+ *         - DS1307_FAIL: Failed to send or receive data or no transition was
+ *                        seen.
+ *         - DS1307_BUS_BUSY: Bus is busy.
+ *         - DS1307_NACK: DS1307 doesn't ACK the transfer.
+ *         - DS1307_INVALID_PARAM: One of parameters is invalid or system time
+ *                                 is out of the DS1307 range.
+ */
+DS1307_Result_t
+DS1307_SysClock_SysToHc(DS1307_Handler_t *Handler, DS1307_SysClock_t *Sync);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif //! _DS1307_SYSCLOCK_H_
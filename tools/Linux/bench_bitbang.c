@@ -0,0 +1,159 @@
+/**
+ **********************************************************************************
+ * @file   bench_bitbang.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Bus speed and timing benchmark of the bit-banged I2C port
+ *         Functionalities of the this file:
+ *          + Run the driver over port/BitBang on the pin-level simulator
+ *          + Report SCL frequency, read latency and timing violations
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "DS1307.h"
+#include "DS1307_platform.h"
+#include "DS1307_bbsim.h"
+
+
+/* Private Constants ------------------------------------------------------------*/
+#define BENCH_CALLS 1000
+
+
+/* Private Data Types -----------------------------------------------------------*/
+typedef struct Scenario_s
+{
+  const char *Name;
+  DS1307_BBSimOptions_t Options;
+} Scenario_t;
+
+
+/* Private Variables ------------------------------------------------------------*/
+static const Scenario_t Scenarios[] =
+{
+  {"GPIO 20ns",           {20,   0}},
+  {"GPIO 100ns",          {100,  0}},
+  {"GPIO 500ns",          {500,  0}},
+  {"GPIO 100ns stretch",  {100,  20}},
+};
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####                           
+ ==================================================================================
+ */
+
+static int
+Run(const Scenario_t *Scenario)
+{
+  static const DS1307_DateTime_t Set = {56, 34, 12, 4, 18, 10, 26};
+  DS1307_Handler_t Handler = {0};
+  DS1307_PlatformPins_t Pins;
+  DS1307_BBSimStats_t Stats;
+  DS1307_DateTime_t DateTime = Set;
+  uint8_t Ram[56], Back[56];
+  uint32_t Violations = 0;
+  uint64_t Start;
+  int Errors = 0;
+  uint32_t i;
+
+  DS1307_BBSim_Init(&Scenario->Options, &Pins);
+  DS1307_Platform_SetPins(&Pins);
+  DS1307_Platform_Init(&Handler);
+  if (DS1307_Init(&Handler) != DS1307_OK)
+  {
+    printf("%-20s init failed\n", Scenario->Name);
+    return 1;
+  }
+
+  // data must survive the trip through the pins
+  for (i = 0; i < sizeof(Ram); i++)
+    Ram[i] = (uint8_t)(i * 37 + 5);
+  if (DS1307_SetDateTime(&Handler, &DateTime) != DS1307_OK ||
+      DS1307_GetDateTime(&Handler, &DateTime) != DS1307_OK ||
+      memcmp(&DateTime, &Set, sizeof(Set)) != 0)
+    Errors++;
+  if (DS1307_WriteRAM(&Handler, 0, Ram, sizeof(Ram)) != DS1307_OK ||
+      DS1307_ReadRAM(&Handler, 0, Back, sizeof(Back)) != DS1307_OK ||
+      memcmp(Ram, Back, sizeof(Ram)) != 0)
+    Errors++;
+
+  DS1307_BBSim_GetStats(NULL);
+  Start = DS1307_BBSim_GetTimeNs();
+  for (i = 0; i < BENCH_CALLS; i++)
+    if (DS1307_GetDateTime(&Handler, &DateTime) != DS1307_OK)
+      Errors++;
+  DS1307_BBSim_GetStats(&Stats);
+
+  for (i = 0; i < DS1307_BBSimCheck_Count; i++)
+    Violations += Stats.Violations[i];
+
+  printf("%-20s %8.1f %10.1f %6.1f %6lu %6d\n", Scenario->Name,
+         Stats.ClockNs ? 1e6 * Stats.Clocks / Stats.ClockNs : 0.0,
+         (DS1307_BBSim_GetTimeNs() - Start) / 1000.0 / BENCH_CALLS,
+         (double)Stats.Bytes / BENCH_CALLS,
+         (unsigned long)Violations, Errors);
+
+  for (i = 0; i < DS1307_BBSimCheck_Count; i++)
+  {
+    if (Stats.Violations[i])
+      printf("  %-8s %lu violations, shortest %lu ns (min %lu ns)\n",
+             DS1307_BBSim_CheckName((DS1307_BBSimCheck_t)i),
+             (unsigned long)Stats.Violations[i],
+             (unsigned long)Stats.WorstNs[i],
+             (unsigned long)DS1307_BBSim_CheckLimitNs((DS1307_BBSimCheck_t)i));
+  }
+
+  return (Errors || Violations) ? 1 : 0;
+}
+
+
+
+/**
+ ==================================================================================
+                                ##### Main #####                                   
+ ==================================================================================
+ */
+
+int
+main(void)
+{
+  int Failed = 0;
+  size_t s;
+
+  printf("DS1307_GetDateTime x %d over port/BitBang (tLOW %d us, tHIGH %d us)\n",
+         BENCH_CALLS, DS1307_BB_LOW_US, DS1307_BB_HIGH_US);
+  printf("%-20s %8s %10s %6s %6s %6s\n",
+         "pins", "SCL kHz", "read us", "bytes", "viol", "errors");
+
+  for (s = 0; s < sizeof(Scenarios) / sizeof(Scenarios[0]); s++)
+    Failed |= Run(&Scenarios[s]);
+
+  return Failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
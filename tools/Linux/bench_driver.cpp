@@ -0,0 +1,194 @@
+/**
+ **********************************************************************************
+ * @file   bench_driver.cpp
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Host benchmark of C function-pointer path vs C++ BusPolicy path
+ *         Functionalities of the this file:
+ *          + Run both drivers against the same in-memory DS1307 model
+ *          + Report time per call of common operations
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "DS1307.h"
+#include "DS1307.hpp"
+
+
+/* Private Constants ------------------------------------------------------------*/
+constexpr long Iterations = 2000000;
+
+
+/* Private Variables ------------------------------------------------------------*/
+/**
+ * @brief  In-memory register file of DS1307 with auto-incrementing pointer
+ */
+static uint8_t Regs[64];
+static uint8_t Pointer;
+static volatile uint8_t Sink;
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####                           
+ ==================================================================================
+ */
+
+static inline int8_t
+ModelSend(const uint8_t *Data, uint8_t Len)
+{
+  Pointer = Data[0] & 0x3F;
+  for (uint8_t i = 1; i < Len; i++)
+  {
+    Regs[Pointer] = Data[i];
+    Pointer = (Pointer + 1) & 0x3F;
+  }
+  return 0;
+}
+
+static inline int8_t
+ModelReceive(uint8_t *Data, uint8_t Len)
+{
+  for (uint8_t i = 0; i < Len; i++)
+  {
+    Data[i] = Regs[Pointer];
+    Pointer = (Pointer + 1) & 0x3F;
+  }
+  return 0;
+}
+
+// C path: called through DS1307_Handler_t function pointers
+static int8_t
+CSend(uint8_t, uint8_t *Data, uint8_t Len)
+{
+  return ModelSend(Data, Len);
+}
+
+static int8_t
+CReceive(uint8_t, uint8_t *Data, uint8_t Len)
+{
+  return ModelReceive(Data, Len);
+}
+
+// C++ path: resolved at compile time
+struct ModelBus
+{
+  static int8_t send(uint8_t, const uint8_t *Data, uint8_t Len) { return ModelSend(Data, Len); }
+  static int8_t receive(uint8_t, uint8_t *Data, uint8_t Len) { return ModelReceive(Data, Len); }
+};
+
+// Body returns the DS1307_Result_t of the call, anything but DS1307_OK aborts
+template <class Function>
+static void
+Measure(const char *Name, Function Body)
+{
+  auto Start = std::chrono::steady_clock::now();
+  for (long i = 0; i < Iterations; i++)
+  {
+    DS1307_Result_t Result = Body(i);
+    if (Result != DS1307_OK)
+    {
+      std::fprintf(stderr, "%s: call %ld returned %d\n", Name, i, (int)Result);
+      std::exit(EXIT_FAILURE);
+    }
+  }
+  auto Stop = std::chrono::steady_clock::now();
+
+  std::printf("%-24s %8.2f ns/call\n", Name,
+              std::chrono::duration<double, std::nano>(Stop - Start).count() / Iterations);
+}
+
+
+
+/**
+ ==================================================================================
+                                ##### Main #####                                   
+ ==================================================================================
+ */
+
+int
+main()
+{
+  DS1307_Handler_t Handler = {};
+  ds1307::Driver<ModelBus> Driver;
+  DS1307_DateTime_t DateTime = {};
+  DS1307_DateTime_t Set = {0, 18, 0, 6, 6, 2, 21};
+  uint8_t Ram[55] = {0};
+
+  Handler.PlatformSend = CSend;
+  Handler.PlatformReceive = CReceive;
+  if (DS1307_Init(&Handler) != DS1307_OK ||
+      DS1307_SetDateTime(&Handler, &Set) != DS1307_OK) // valid time to read
+  {
+    std::fprintf(stderr, "init failed\n");
+    return EXIT_FAILURE;
+  }
+
+  Measure("C   GetDateTime", [&](long) {
+    DS1307_Result_t Result = DS1307_GetDateTime(&Handler, &DateTime);
+    Sink = DateTime.Second;
+    return Result;
+  });
+  Measure("C++ GetDateTime", [&](long) {
+    DS1307_Result_t Result = Driver.GetDateTime(DateTime);
+    Sink = DateTime.Second;
+    return Result;
+  });
+
+  Measure("C   SetDateTime", [&](long i) {
+    Set.Second = i % 60;
+    return DS1307_SetDateTime(&Handler, &Set);
+  });
+  Measure("C++ SetDateTime", [&](long i) {
+    Set.Second = i % 60;
+    return Driver.SetDateTime(Set);
+  });
+
+  Measure("C   WriteRAM 55B", [&](long i) {
+    Ram[0] = (uint8_t)i;
+    return DS1307_WriteRAM(&Handler, 0, Ram, sizeof(Ram));
+  });
+  Measure("C++ WriteRAM 55B", [&](long i) {
+    Ram[0] = (uint8_t)i;
+    return Driver.WriteRAM(0, Ram);
+  });
+
+  Measure("C   ReadRAM 55B", [&](long) {
+    DS1307_Result_t Result = DS1307_ReadRAM(&Handler, 0, Ram, sizeof(Ram));
+    Sink = Ram[54];
+    return Result;
+  });
+  Measure("C++ ReadRAM 55B", [&](long) {
+    DS1307_Result_t Result = Driver.ReadRAM(0, Ram);
+    Sink = Ram[54];
+    return Result;
+  });
+
+  return 0;
+}
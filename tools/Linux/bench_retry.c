@@ -0,0 +1,155 @@
+/**
+ **********************************************************************************
+ * @file   bench_retry.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Retry policy benchmark on the fault-injecting simulator
+ *         Functionalities of the this file:
+ *          + Measure failure rate and recovery latency of retry policies under injected bus faults
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include "DS1307.h"
+#include "DS1307_sim.h"
+
+
+/* Private Constants ------------------------------------------------------------*/
+#define BENCH_CALLS 20000
+
+
+/* Private Data Types -----------------------------------------------------------*/
+typedef struct Scenario_s
+{
+  const char *Name;
+  DS1307_SimFaults_t Faults;
+} Scenario_t;
+
+typedef struct Policy_s
+{
+  const char *Name;
+  DS1307_Retry_t Retry;
+} Policy_t;
+
+
+/* Private Variables ------------------------------------------------------------*/
+static const Scenario_t Scenarios[] =
+{
+  {"clean",         {0,  0,  0, 0, 0,   1}},
+  {"1% NACK",       {0,  10, 0, 0, 0,   1}},
+  {"5% mixed",      {20, 20, 10, 0, 0,  1}},
+  {"2% burst x4",   {0,  20, 0, 4, 0,   1}},
+  {"1% busy 1ms",   {10, 0,  0, 0, 1000, 1}},
+};
+
+static const Policy_t Policies[] =
+{
+  {"no retry",            {0, 0,   0,    0}},
+  {"3 retries",           {3, 0,   0,    0}},
+  {"5 retries backoff",   {5, 100, 1600, 0}},
+  {"8 retries 3ms limit", {8, 100, 1600, 3000}},
+};
+
+static uint32_t Latency[BENCH_CALLS];
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####                           
+ ==================================================================================
+ */
+
+static int
+CompareU32(const void *A, const void *B)
+{
+  uint32_t a = *(const uint32_t *)A;
+  uint32_t b = *(const uint32_t *)B;
+
+  return (a > b) - (a < b);
+}
+
+static void
+Run(const Scenario_t *Scenario, const Policy_t *Policy)
+{
+  DS1307_Handler_t Handler = {0};
+  DS1307_DateTime_t DateTime;
+  DS1307_SimStats_t Stats;
+  uint32_t Failed = 0;
+  uint32_t Start = 0;
+  uint64_t Sum = 0;
+  uint32_t i;
+
+  DS1307_Sim_Init(&Handler);
+  DS1307_Init(&Handler);
+  Handler.Retry = Policy->Retry;
+  DS1307_Sim_SetFaults(&Scenario->Faults);
+
+  for (i = 0; i < BENCH_CALLS; i++)
+  {
+    Start = DS1307_Sim_GetTimeUs();
+    if (DS1307_GetDateTime(&Handler, &DateTime) != DS1307_OK)
+      Failed++;
+    Latency[i] = DS1307_Sim_GetTimeUs() - Start;
+    Sum += Latency[i];
+  }
+
+  DS1307_Sim_GetStats(&Stats);
+  qsort(Latency, BENCH_CALLS, sizeof(Latency[0]), CompareU32);
+
+  printf("%-12s %-20s %7.3f%% %8.1f %6lu %6lu %6lu %7.2f\n",
+         Scenario->Name, Policy->Name,
+         100.0 * Failed / BENCH_CALLS, (double)Sum / BENCH_CALLS,
+         (unsigned long)Latency[BENCH_CALLS / 2],
+         (unsigned long)Latency[BENCH_CALLS * 99 / 100],
+         (unsigned long)Latency[BENCH_CALLS - 1],
+         (double)Stats.Transfers / BENCH_CALLS);
+}
+
+
+
+/**
+ ==================================================================================
+                                ##### Main #####                                   
+ ==================================================================================
+ */
+
+int
+main(void)
+{
+  size_t s, p;
+
+  printf("DS1307_GetDateTime x %d on the simulated bus (%d Hz), latency in us\n",
+         BENCH_CALLS, DS1307_SIM_I2C_RATE);
+  printf("%-12s %-20s %8s %8s %6s %6s %6s %7s\n",
+         "faults", "policy", "failed", "mean", "p50", "p99", "max", "xfers");
+
+  for (s = 0; s < sizeof(Scenarios) / sizeof(Scenarios[0]); s++)
+    for (p = 0; p < sizeof(Policies) / sizeof(Policies[0]); p++)
+      Run(&Scenarios[s], &Policies[p]);
+
+  return EXIT_SUCCESS;
+}
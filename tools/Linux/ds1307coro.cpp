@@ -0,0 +1,175 @@
+/**
+ **********************************************************************************
+ * @file   ds1307coro.cpp
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Compare DS1307 with the system clock at a second edge (C++20 example)
+ *         Usage: ds1307coro [-d <i2c-dev adapter>]
+ *          -d   adapter (default DS1307_I2C_DEV)
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include "DS1307_platform.h"
+#include "DS1307_coro.hpp"
+#include "DS1307_coro_i2cdev.hpp"
+
+
+using namespace ds1307::coro;
+
+
+/* Private Variables ------------------------------------------------------------*/
+static bool Finished = false;
+static DS1307_Result_t Result = DS1307_FAIL;
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####                           
+ ==================================================================================
+ */
+
+static void
+Usage(const char *Name)
+{
+  fprintf(stderr,
+          "Usage: %s [-d <i2c-dev adapter>]\n"
+          "  -d  adapter (default " DS1307_I2C_DEV ")\n",
+          Name);
+}
+
+static task<void>
+Measure(device<i2cdev_transport> &Rtc)
+{
+  DS1307_DateTime_t DateTime;
+  struct timespec Host;
+
+  // system time is taken at the end of the polling read that saw the edge
+  Result = co_await Rtc.next_second_edge();
+  clock_gettime(CLOCK_REALTIME, &Host);
+  if (Result == DS1307_OK)
+    Result = co_await Rtc.read_time(DateTime);
+
+  if (Result == DS1307_OK)
+  {
+    struct tm Utc;
+    gmtime_r(&Host.tv_sec, &Utc);
+    printf("RTC   20%02u-%02u-%02u %02u:%02u:%02u.000\n",
+           DateTime.Year, DateTime.Month, DateTime.Day,
+           DateTime.Hour, DateTime.Minute, DateTime.Second);
+    printf("host  %04d-%02d-%02d %02d:%02d:%02d.%03ld UTC\n",
+           Utc.tm_year + 1900, Utc.tm_mon + 1, Utc.tm_mday,
+           Utc.tm_hour, Utc.tm_min, Utc.tm_sec, Host.tv_nsec / 1000000);
+  }
+  Finished = true;
+}
+
+
+
+/**
+ ==================================================================================
+                                ##### Main #####                                   
+ ==================================================================================
+ */
+
+int
+main(int argc, char **argv)
+{
+  const char *Path = DS1307_I2C_DEV;
+  struct epoll_event Event = {};
+  int Option = 0;
+
+  while ((Option = getopt(argc, argv, "d:h")) != -1)
+  {
+    switch (Option)
+    {
+    case 'd':
+      Path = optarg;
+      break;
+    default:
+      Usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  const int Wake = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  const int Epoll = epoll_create1(EPOLL_CLOEXEC);
+  Event.events = EPOLLIN;
+  Event.data.fd = Wake;
+  if (Wake < 0 || Epoll < 0 || epoll_ctl(Epoll, EPOLL_CTL_ADD, Wake, &Event) < 0)
+  {
+    perror("epoll");
+    return EXIT_FAILURE;
+  }
+
+  // transfers complete on the transport thread, post() wakes this loop
+  executor Exec([Wake] {
+    uint64_t One = 1;
+    if (write(Wake, &One, sizeof(One)) < 0)
+      perror("eventfd");
+  });
+  i2cdev_transport Bus;
+  device<i2cdev_transport> Rtc(Exec, Bus);
+
+  if (Bus.open(Path) < 0)
+  {
+    perror(Path);
+    return EXIT_FAILURE;
+  }
+
+  spawn(Exec, Measure(Rtc));
+  while (!Finished)
+  {
+    const auto Timeout = Exec.next_timeout();
+    const int TimeoutMs = Timeout.count() < 0 ? -1 :
+                          static_cast<int>((Timeout.count() + 999) / 1000);
+    uint64_t Count;
+
+    if (epoll_wait(Epoll, &Event, 1, TimeoutMs) > 0 &&
+        read(Wake, &Count, sizeof(Count)) < 0)
+      perror("eventfd");
+    Exec.run_once();
+  }
+
+  Bus.close();
+  close(Epoll);
+  close(Wake);
+
+  if (Result != DS1307_OK)
+  {
+    fprintf(stderr, "ds1307coro: %s\n",
+            Result == DS1307_NACK ? "no DS1307 on the bus" :
+            Result == DS1307_BUS_BUSY ? "bus busy" :
+            "no second edge (oscillator halted?)");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,702 @@
+/**
+ **********************************************************************************
+ * @file   ds1307ctl.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  DS1307 command-line tool (Linux)
+ *         Functionalities of the this file:
+ *          + Read and set date and time
+ *          + Sync with the system clock at a seconds transition
+ *          + Dump and load the 56-byte RAM, snapshot all registers
+ *          + Measure latency percentiles of the driver API
+ *          + Target i2c-dev adapters or the software simulator
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+#include "DS1307.h"
+#include "DS1307_platform.h"
+#include "DS1307_sim.h"
+#include "DS1307_sysclock.h"
+
+
+/* Private Constants ------------------------------------------------------------*/
+#define REGS_SIZE       64
+#define BENCH_DEFAULT   200
+
+
+/* Private Data Types -----------------------------------------------------------*/
+typedef int (*Command_t)(int argc, char **argv);
+
+typedef struct CommandEntry_s
+{
+  const char *Name;
+  Command_t Run;
+  const char *Args;
+  const char *Help;
+} CommandEntry_t;
+
+
+/* Private Variables ------------------------------------------------------------*/
+static DS1307_Handler_t Handler = {0};
+static int Json = 0;
+static int Simulator = 0;
+static int BenchCount = BENCH_DEFAULT;
+static uint32_t PollUs = 0;
+
+static const char *const OutWaveNames[] =
+{
+  "low", "high", "1Hz", "4kHz", "8kHz", "32kHz"
+};
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####                           
+ ==================================================================================
+ */
+
+static const char *
+ResultName(DS1307_Result_t Result)
+{
+  switch (Result)
+  {
+  case DS1307_OK:
+    return "ok";
+  case DS1307_BUS_BUSY:
+    return "bus busy";
+  case DS1307_NACK:
+    return "no ACK (is a DS1307 connected?)";
+  case DS1307_INVALID_PARAM:
+    return "invalid parameter";
+  default:
+    return "bus error";
+  }
+}
+
+static int
+FailMessage(const char *What, const char *Message)
+{
+  if (Json)
+    printf("{\"error\":\"%s\",\"result\":\"%s\"}\n", What, Message);
+  else
+    fprintf(stderr, "%s: %s\n", What, Message);
+  return 1;
+}
+
+static int
+Fail(const char *What, DS1307_Result_t Result)
+{
+  return FailMessage(What, ResultName(Result));
+}
+
+static int
+FailSync(const char *What, DS1307_Result_t Result)
+{
+  DS1307_RunHalt_t RunHalt;
+
+  // a second edge never comes while CH is set, which is not a bus problem
+  if (Result == DS1307_FAIL &&
+      DS1307_GetRunHalt(&Handler, &RunHalt) == DS1307_OK &&
+      RunHalt == DS1307_RunHalt_Halt)
+    return FailMessage(What, "oscillator is halted (CH set, use set or systohc)");
+
+  return Fail(What, Result);
+}
+
+static int64_t
+NowNs(void)
+{
+  struct timespec Time;
+
+  clock_gettime(CLOCK_MONOTONIC, &Time);
+  return (int64_t)Time.tv_sec * 1000000000LL + Time.tv_nsec;
+}
+
+static void
+FormatDateTime(const DS1307_DateTime_t *DateTime, char *Text, size_t Size)
+{
+  snprintf(Text, Size, "20%02u-%02u-%02uT%02u:%02u:%02u",
+           DateTime->Year, DateTime->Month, DateTime->Day,
+           DateTime->Hour, DateTime->Minute, DateTime->Second);
+}
+
+static int
+ParseDateTime(int argc, char **argv, DS1307_DateTime_t *DateTime)
+{
+  char Text[64];
+  unsigned Y, Mo, D, H, Mi, S;
+  uint32_t Unix = 0;
+
+  if (argc == 1)
+    snprintf(Text, sizeof(Text), "%s", argv[0]);
+  else if (argc == 2)
+    snprintf(Text, sizeof(Text), "%sT%s", argv[0], argv[1]);
+  else
+    return -1;
+
+  if (sscanf(Text, "%u-%u-%uT%u:%u:%u", &Y, &Mo, &D, &H, &Mi, &S) != 6 ||
+      Y < 2000 || Y > 2099 || Mo < 1 || Mo > 12 || D < 1 || D > 31 ||
+      H > 23 || Mi > 59 || S > 59)
+    return -1;
+
+  DateTime->Year = Y - 2000;
+  DateTime->Month = Mo;
+  DateTime->Day = D;
+  DateTime->Hour = H;
+  DateTime->Minute = Mi;
+  DateTime->Second = S;
+  DateTime->WeekDay = 1;
+
+  // round trip through Unix time to check the day and fill WeekDay
+  if (DS1307_DateTimeToUnix(DateTime, &Unix) != DS1307_OK ||
+      DS1307_UnixToDateTime(Unix, DateTime) != DS1307_OK ||
+      DateTime->Day != D)
+    return -1;
+
+  return 0;
+}
+
+static void
+PrintHex(const uint8_t *Data, uint8_t Size, uint8_t Base)
+{
+  uint8_t i;
+
+  if (Json)
+  {
+    printf("[");
+    for (i = 0; i < Size; i++)
+      printf("%s%u", i ? "," : "", Data[i]);
+    printf("]");
+    return;
+  }
+
+  for (i = 0; i < Size; i++)
+  {
+    if (i % 16 == 0)
+      printf("%s0x%02X:", i ? "\n" : "", Base + i);
+    printf(" %02X", Data[i]);
+  }
+  printf("\n");
+}
+
+static int
+ReadFile(const char *Path, uint8_t *Data, size_t Size)
+{
+  FILE *File = fopen(Path, "rb");
+  size_t Len = 0;
+
+  if (!File)
+  {
+    perror(Path);
+    return -1;
+  }
+
+  Len = fread(Data, 1, Size, File);
+  fclose(File);
+  if (Len != Size)
+  {
+    fprintf(stderr, "%s: expected %zu bytes\n", Path, Size);
+    return -1;
+  }
+
+  return 0;
+}
+
+static int
+WriteFile(const char *Path, const uint8_t *Data, size_t Size)
+{
+  FILE *File = fopen(Path, "wb");
+
+  if (!File || fwrite(Data, 1, Size, File) != Size)
+  {
+    perror(Path);
+    if (File)
+      fclose(File);
+    return -1;
+  }
+
+  return fclose(File);
+}
+
+
+/* Commands ---------------------------------------------------------------------*/
+
+static int
+CmdShow(int argc, char **argv)
+{
+  DS1307_Probe_t Probe;
+  DS1307_Result_t Result;
+  char Text[32];
+  uint32_t Unix = 0;
+
+  (void)argc;
+  (void)argv;
+
+  if ((Result = DS1307_Probe(&Handler, &Probe)) != DS1307_OK)
+    return Fail("probe", Result);
+
+  FormatDateTime(&Probe.DateTime, Text, sizeof(Text));
+  if (DS1307_DateTimeToUnix(&Probe.DateTime, &Unix) != DS1307_OK)
+    Unix = 0;
+
+  if (Json)
+  {
+    printf("{\"time\":\"%s\",\"unix\":%lu,\"weekday\":%u,\"halted\":%s,"
+           "\"invalid\":%u,\"control\":%u,\"outwave\":\"%s\"}\n",
+           Text, (unsigned long)Unix, Probe.DateTime.WeekDay,
+           Probe.Halted ? "true" : "false", Probe.Invalid, Probe.Control,
+           OutWaveNames[Probe.OutWave]);
+  }
+  else
+  {
+    printf("time:     %s UTC (weekday %u)\n", Text, Probe.DateTime.WeekDay);
+    printf("unix:     %lu\n", (unsigned long)Unix);
+    printf("halted:   %s\n", Probe.Halted ? "yes (oscillator stopped)" : "no");
+    printf("invalid:  0x%02X\n", Probe.Invalid);
+    printf("control:  0x%02X (%s)\n", Probe.Control, OutWaveNames[Probe.OutWave]);
+  }
+
+  return 0;
+}
+
+static int
+CmdSet(int argc, char **argv)
+{
+  DS1307_DateTime_t DateTime;
+  DS1307_Result_t Result;
+
+  if (ParseDateTime(argc, argv, &DateTime) < 0)
+  {
+    fprintf(stderr, "set: expected YYYY-MM-DD[T ]HH:MM:SS (UTC, 2000 to 2099)\n");
+    return 1;
+  }
+
+  if ((Result = DS1307_SetDateTime(&Handler, &DateTime)) != DS1307_OK)
+    return Fail("set", Result);
+
+  return CmdShow(0, NULL);
+}
+
+static int
+PrintSync(const char *Name, const DS1307_SysClock_t *Sync)
+{
+  if (Json)
+    printf("{\"command\":\"%s\",\"unix\":%lu,\"offset_us\":%lld,"
+           "\"uncertainty_us\":%lu,\"reads\":%u,\"applied\":%s}\n",
+           Name, (unsigned long)Sync->Unix, (long long)Sync->OffsetUs,
+           (unsigned long)Sync->UncertaintyUs, Sync->Reads,
+           Sync->DryRun ? "false" : "true");
+  else
+    printf("%s: unix %lu, DS1307 - system %+lld us (+-%lu us), %u reads%s\n",
+           Name, (unsigned long)Sync->Unix, (long long)Sync->OffsetUs,
+           (unsigned long)Sync->UncertaintyUs, Sync->Reads,
+           Sync->DryRun ? ", nothing changed" : "");
+  return 0;
+}
+
+static int
+CmdSysToHc(int argc, char **argv)
+{
+  DS1307_SysClock_t Sync = {0};
+  DS1307_Result_t Result;
+
+  (void)argv;
+
+  Sync.PollUs = PollUs;
+  Sync.DryRun = (argc > 0);
+  if ((Result = DS1307_SysClock_SysToHc(&Handler, &Sync)) != DS1307_OK)
+    return FailSync("systohc", Result);
+
+  return PrintSync("systohc", &Sync);
+}
+
+static int
+CmdHcToSys(int argc, char **argv)
+{
+  DS1307_SysClock_t Sync = {0};
+  DS1307_Result_t Result;
+
+  (void)argv;
+
+  // the simulated clock is not a sensible source for the host clock
+  Sync.PollUs = PollUs;
+  Sync.DryRun = (argc > 0) || Simulator;
+  if ((Result = DS1307_SysClock_HcToSys(&Handler, &Sync)) != DS1307_OK)
+    return FailSync("hctosys", Result);
+
+  return PrintSync("hctosys", &Sync);
+}
+
+static int
+CmdDumpRam(int argc, char **argv)
+{
+  uint8_t Ram[DS1307_RAM_SIZE];
+  DS1307_Result_t Result;
+
+  if ((Result = DS1307_ReadRAM(&Handler, 0, Ram, DS1307_RAM_SIZE)) != DS1307_OK)
+    return Fail("dump-ram", Result);
+
+  if (argc > 0)
+    return (WriteFile(argv[0], Ram, DS1307_RAM_SIZE) < 0) ? 1 : 0;
+
+  if (Json)
+    printf("{\"ram\":");
+  PrintHex(Ram, DS1307_RAM_SIZE, 0);
+  if (Json)
+    printf("}\n");
+  return 0;
+}
+
+static int
+CmdLoadRam(int argc, char **argv)
+{
+  uint8_t Ram[DS1307_RAM_SIZE];
+  uint8_t Verify[DS1307_RAM_SIZE];
+  DS1307_Result_t Result;
+
+  if (argc != 1)
+  {
+    fprintf(stderr, "load-ram: expected a %d-byte file\n", DS1307_RAM_SIZE);
+    return 1;
+  }
+
+  if (ReadFile(argv[0], Ram, DS1307_RAM_SIZE) < 0)
+    return 1;
+
+  if ((Result = DS1307_WriteRAM(&Handler, 0, Ram, DS1307_RAM_SIZE)) != DS1307_OK)
+    return Fail("load-ram", Result);
+
+  if ((Result = DS1307_ReadRAM(&Handler, 0, Verify, DS1307_RAM_SIZE)) != DS1307_OK)
+    return Fail("load-ram", Result);
+
+  if (memcmp(Ram, Verify, DS1307_RAM_SIZE) != 0)
+    return Fail("load-ram verify", DS1307_FAIL);
+
+  if (Json)
+    printf("{\"written\":%d}\n", DS1307_RAM_SIZE);
+  return 0;
+}
+
+static int
+CmdSnapshot(int argc, char **argv)
+{
+  uint8_t Regs[REGS_SIZE];
+  DS1307_Probe_t Probe;
+  DS1307_Result_t Result;
+
+  // one burst over the whole register file: time, CONTROL and RAM
+  if ((Result = DS1307_ReadImage(&Handler, &Probe, &Regs[8])) != DS1307_OK)
+    return Fail("snapshot", Result);
+  memcpy(Regs, Probe.TimeRegs, sizeof(Probe.TimeRegs));
+  Regs[7] = Probe.Control;
+
+  if (argc > 0)
+    return (WriteFile(argv[0], Regs, REGS_SIZE) < 0) ? 1 : 0;
+
+  if (Json)
+    printf("{\"registers\":");
+  PrintHex(Regs, REGS_SIZE, 0);
+  if (Json)
+    printf("}\n");
+  return 0;
+}
+
+
+/* Bench ------------------------------------------------------------------------*/
+
+static int
+CompareU32(const void *A, const void *B)
+{
+  uint32_t X = *(const uint32_t *)A;
+  uint32_t Y = *(const uint32_t *)B;
+
+  return (X > Y) - (X < Y);
+}
+
+static DS1307_Result_t
+BenchGetDateTime(void)
+{
+  DS1307_DateTime_t DateTime;
+  return DS1307_GetDateTime(&Handler, &DateTime);
+}
+
+static DS1307_Result_t
+BenchGetSecond(void)
+{
+  DS1307_DateTime_t DateTime;
+  return DS1307_GetFields(&Handler, DS1307_Field_Second, &DateTime);
+}
+
+static DS1307_Result_t
+BenchGetRunHalt(void)
+{
+  DS1307_RunHalt_t RunHalt;
+  return DS1307_GetRunHalt(&Handler, &RunHalt);
+}
+
+static DS1307_Result_t
+BenchProbe(void)
+{
+  DS1307_Probe_t Probe;
+  return DS1307_Probe(&Handler, &Probe);
+}
+
+static DS1307_Result_t
+BenchReadRam(void)
+{
+  uint8_t Ram[DS1307_RAM_SIZE];
+  return DS1307_ReadRAM(&Handler, 0, Ram, DS1307_RAM_SIZE);
+}
+
+static DS1307_Result_t
+BenchGetDateTimeAndRam(void)
+{
+  DS1307_DateTime_t DateTime;
+  uint8_t Ram[8];
+  return DS1307_GetDateTimeAndRAM(&Handler, &DateTime, Ram);
+}
+
+static DS1307_Result_t
+BenchSetOutWave(void)
+{
+  static uint8_t Toggle = 0;
+
+  // alternate the wave, an unchanged CONTROL register is not written at all
+  Toggle ^= 1;
+  return DS1307_SetOutWave(&Handler, Toggle ? DS1307_OutWave_1Hz :
+                                              DS1307_OutWave_Low);
+}
+
+static int
+CmdBench(int argc, char **argv)
+{
+  static const struct
+  {
+    const char *Name;
+    DS1307_Result_t (*Run)(void);
+  } Apis[] =
+  {
+    {"GetDateTime",       BenchGetDateTime},
+    {"GetFields(Second)", BenchGetSecond},
+    {"GetRunHalt",        BenchGetRunHalt},
+    {"Probe",             BenchProbe},
+    {"ReadRAM(56)",       BenchReadRam},
+    {"GetDateTimeAndRAM", BenchGetDateTimeAndRam},
+    {"SetOutWave",        BenchSetOutWave}
+  };
+  uint32_t *Samples = NULL;
+  uint32_t Errors = 0;
+  int64_t Start = 0;
+  uint32_t Sim = 0;
+  size_t i = 0;
+  int n = 0;
+
+  (void)argc;
+  (void)argv;
+
+  if ((Samples = malloc(sizeof(uint32_t) * BenchCount)) == NULL)
+    return 1;
+
+  if (DS1307_SetHotRAM(&Handler, 0, 8) != DS1307_OK)
+    return Fail("bench", DS1307_FAIL);
+
+  if (Json)
+    printf("{\"target\":\"%s\",\"count\":%d,\"apis\":[", 
+           Simulator ? "simulator" : "i2c-dev", BenchCount);
+  else
+    printf("%-20s %10s %10s %10s %10s %8s  (us, %d calls%s)\n",
+           "api", "p50", "p90", "p99", "max", "errors", BenchCount,
+           Simulator ? ", simulated bus time" : "");
+
+  for (i = 0; i < sizeof(Apis) / sizeof(Apis[0]); i++)
+  {
+    Errors = 0;
+    for (n = 0; n < BenchCount; n++)
+    {
+      // the simulator runs in virtual time, measure the bus time it models
+      if (Simulator)
+        Sim = DS1307_Sim_GetTimeUs();
+      else
+        Start = NowNs();
+
+      if (Apis[i].Run() != DS1307_OK)
+        Errors++;
+
+      if (Simulator)
+        Samples[n] = DS1307_Sim_GetTimeUs() - Sim;
+      else
+        Samples[n] = (uint32_t)((NowNs() - Start) / 1000);
+    }
+
+    qsort(Samples, BenchCount, sizeof(uint32_t), CompareU32);
+
+    if (Json)
+      printf("%s{\"api\":\"%s\",\"p50\":%u,\"p90\":%u,\"p99\":%u,\"max\":%u,"
+             "\"errors\":%u}", i ? "," : "", Apis[i].Name,
+             Samples[BenchCount * 50 / 100], Samples[BenchCount * 90 / 100],
+             Samples[BenchCount * 99 / 100], Samples[BenchCount - 1], Errors);
+    else
+      printf("%-20s %10u %10u %10u %10u %8u\n", Apis[i].Name,
+             Samples[BenchCount * 50 / 100], Samples[BenchCount * 90 / 100],
+             Samples[BenchCount * 99 / 100], Samples[BenchCount - 1], Errors);
+  }
+
+  if (Json)
+    printf("]}\n");
+
+  free(Samples);
+  return 0;
+}
+
+
+static const CommandEntry_t Commands[] =
+{
+  {"show",     CmdShow,     "",                     "print date, time and chip state"},
+  {"set",      CmdSet,      "YYYY-MM-DDTHH:MM:SS",  "set date and time (UTC)"},
+  {"systohc",  CmdSysToHc,  "[check]",              "set the DS1307 in phase with the system clock"},
+  {"hctosys",  CmdHcToSys,  "[check]",              "set the system clock at a DS1307 second edge"},
+  {"dump-ram", CmdDumpRam,  "[file]",               "print the 56-byte RAM or save it to file"},
+  {"load-ram", CmdLoadRam,  "file",                 "write a 56-byte file to RAM and verify it"},
+  {"snapshot", CmdSnapshot, "[file]",               "read all 64 registers in one burst"},
+  {"bench",    CmdBench,    "",                     "latency percentiles of the driver API"}
+};
+
+
+static void
+Usage(const char *Name)
+{
+  size_t i = 0;
+
+  fprintf(stderr,
+          "Usage: %s [-d device | -S] [-j] [-n count] [-p us] command [args]\n"
+          "  -d device  i2c-dev adapter (default " DS1307_I2C_DEV ")\n"
+          "  -S         use the software simulator (started at the host time)\n"
+          "  -j         JSON output\n"
+          "  -n count   calls per API for bench (default %d)\n"
+          "  -p us      poll cadence of the edge search (default 0, back-to-back)\n"
+          "Commands:\n", Name, BENCH_DEFAULT);
+
+  for (i = 0; i < sizeof(Commands) / sizeof(Commands[0]); i++)
+    fprintf(stderr, "  %-9s %-21s %s\n",
+            Commands[i].Name, Commands[i].Args, Commands[i].Help);
+  fprintf(stderr, "systohc/hctosys with \"check\" only measure the offset of the DS1307\n");
+}
+
+
+
+/**
+ ==================================================================================
+                                ##### Main #####                                   
+ ==================================================================================
+ */
+
+int
+main(int argc, char **argv)
+{
+  const CommandEntry_t *Command = NULL;
+  DS1307_Probe_t Probe;
+  DS1307_Result_t Result;
+  size_t i = 0;
+  int Ret = 0;
+  int Opt = 0;
+
+  while ((Opt = getopt(argc, argv, "d:Sjn:p:h")) != -1)
+  {
+    switch (Opt)
+    {
+    case 'd':
+      DS1307_Platform_SetDevice(optarg);
+      break;
+    case 'S':
+      Simulator = 1;
+      break;
+    case 'j':
+      Json = 1;
+      break;
+    case 'n':
+      BenchCount = atoi(optarg);
+      if (BenchCount < 1)
+        BenchCount = 1;
+      break;
+    case 'p':
+      PollUs = (uint32_t)strtoul(optarg, NULL, 0);
+      break;
+    default:
+      Usage(argv[0]);
+      return (Opt == 'h') ? 0 : 1;
+    }
+  }
+
+  if (optind >= argc)
+  {
+    Usage(argv[0]);
+    return 1;
+  }
+
+  for (i = 0; i < sizeof(Commands) / sizeof(Commands[0]); i++)
+  {
+    if (strcmp(argv[optind], Commands[i].Name) == 0)
+      Command = &Commands[i];
+  }
+
+  if (!Command)
+  {
+    fprintf(stderr, "unknown command: %s\n", argv[optind]);
+    Usage(argv[0]);
+    return 1;
+  }
+
+  if (Simulator)
+    DS1307_Sim_Init(&Handler);
+  else
+    DS1307_Platform_Init(&Handler);
+
+  if ((Result = DS1307_InitProbe(&Handler, &Probe)) != DS1307_OK)
+    return Fail("init", Result);
+
+  if (!Probe.Present)
+    return Fail("init", DS1307_NACK);
+
+  // the simulated DS1307 powers up halted like a new chip, start it
+  if (Simulator && Probe.Halted)
+  {
+    DS1307_DateTime_t DateTime;
+
+    if (DS1307_UnixToDateTime((uint32_t)time(NULL), &DateTime) != DS1307_OK ||
+        DS1307_SetDateTime(&Handler, &DateTime) != DS1307_OK)
+      return Fail("init", DS1307_FAIL);
+  }
+
+  Ret = Command->Run(argc - optind - 1, argv + optind + 1);
+
+  DS1307_DeInit(&Handler);
+  return Ret;
+}
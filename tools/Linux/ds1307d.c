@@ -0,0 +1,257 @@
+/**
+ **********************************************************************************
+ * @file   ds1307d.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  DS1307 time publisher daemon (Linux)
+ *         Functionalities of the this file:
+ *          + Own the DS1307 and track its drift against CLOCK_MONOTONIC
+ *          + Publish the corrected clock through DS1307_shm segment
+ *          + Export second transitions to ntpd/chrony through NTP SHM refclock
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <unistd.h>
+#include <time.h>
+#include "DS1307.h"
+#include "DS1307_platform.h"
+#include "DS1307_shm.h"
+#include "DS1307_ntpshm.h"
+
+
+/* Private Constants ------------------------------------------------------------*/
+#define NSEC_PER_SEC      1000000000LL
+#define WAKEUP_GUARD_NS   20000000LL    // wake up 20 ms before the expected edge
+#define STEP_LIMIT_NS     500000000LL   // larger errors mean the RTC was stepped
+#define EDGE_POLLS        5000
+#define NTPSHM_PRECISION  -10           // ~1 ms, duration of one edge poll
+
+
+/* Private Variables ------------------------------------------------------------*/
+static volatile sig_atomic_t Running = 1;
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####                           
+ ==================================================================================
+ */
+
+static void
+SignalHandler(int Signal)
+{
+  (void)Signal;
+  Running = 0;
+}
+
+static int64_t
+ToNs(const struct timespec *Time)
+{
+  return (int64_t)Time->tv_sec * NSEC_PER_SEC + Time->tv_nsec;
+}
+
+static void
+SleepUntil(int64_t Mono)
+{
+  struct timespec Until;
+
+  Until.tv_sec = Mono / NSEC_PER_SEC;
+  Until.tv_nsec = Mono % NSEC_PER_SEC;
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &Until, NULL) && Running);
+}
+
+/**
+ * @brief  Capture a second transition of DS1307
+ * @param  Handler: Pointer to handler
+ * @param  Mono: CLOCK_MONOTONIC of the transition
+ * @param  Real: CLOCK_REALTIME of the transition
+ * @param  Unix: DS1307 time right after the transition (s)
+ * @retval 0 on success, -1 on failure
+ */
+static int
+CaptureEdge(DS1307_Handler_t *Handler,
+            struct timespec *Mono, struct timespec *Real, uint32_t *Unix)
+{
+  DS1307_DateTime_t DateTime;
+
+  if (DS1307_WaitSecondEdge(Handler, EDGE_POLLS) != DS1307_OK)
+    return -1;
+  clock_gettime(CLOCK_MONOTONIC, Mono);
+  clock_gettime(CLOCK_REALTIME, Real);
+
+  if (DS1307_GetDateTime(Handler, &DateTime) != DS1307_OK)
+    return -1;
+
+  return (DS1307_DateTimeToUnix(&DateTime, Unix) == DS1307_OK) ? 0 : -1;
+}
+
+static void
+Usage(const char *Name)
+{
+  fprintf(stderr,
+          "Usage: %s [-d device] [-n shm-name] [-i interval] [-t unit] [-f]\n"
+          "  -d  i2c-dev adapter (default %s)\n"
+          "  -n  shared memory name (default %s)\n"
+          "  -i  resynchronization interval in seconds (default 16)\n"
+          "  -t  also export samples to NTP SHM refclock unit\n"
+          "  -f  stay in foreground\n",
+          Name, DS1307_I2C_DEV, DS1307_SHM_NAME);
+}
+
+
+
+/**
+ ==================================================================================
+                                ##### Main #####                                   
+ ==================================================================================
+ */
+
+int
+main(int argc, char **argv)
+{
+  DS1307_Handler_t Handler = {0};
+  DS1307_Shm_t *Shm = NULL;
+  DS1307_NtpShm_t *NtpShm = NULL;
+  struct timespec EdgeMono, EdgeReal, ClockTime;
+  const char *ShmName = DS1307_SHM_NAME;
+  int Interval = 16;
+  int Foreground = 0;
+  int Option = 0;
+  int64_t Mono0 = 0, Unix0 = 0;   // baseline edge
+  int64_t Mono = 0, Unix = 0;     // latest edge
+  int64_t RatePpb = 0;
+  int HaveBaseline = 0;
+  uint32_t Seconds = 0;
+
+  while ((Option = getopt(argc, argv, "d:n:i:t:fh")) != -1)
+  {
+    switch (Option)
+    {
+    case 'd':
+      DS1307_Platform_SetDevice(optarg);
+      break;
+    case 'n':
+      ShmName = optarg;
+      break;
+    case 'i':
+      Interval = atoi(optarg);
+      break;
+    case 't':
+      NtpShm = DS1307_NtpShm_Attach((uint8_t)atoi(optarg));
+      if (!NtpShm)
+      {
+        perror("DS1307_NtpShm_Attach");
+        return 1;
+      }
+      break;
+    case 'f':
+      Foreground = 1;
+      break;
+    default:
+      Usage(argv[0]);
+      return (Option == 'h') ? 0 : 1;
+    }
+  }
+  if (Interval < 1)
+    Interval = 1;
+
+  DS1307_Platform_Init(&Handler);
+  if (DS1307_Init(&Handler) != DS1307_OK)
+  {
+    perror("DS1307_Init");
+    return 1;
+  }
+
+  Shm = DS1307_Shm_Create(ShmName);
+  if (!Shm)
+  {
+    perror("DS1307_Shm_Create");
+    return 1;
+  }
+
+  if (!Foreground && daemon(0, 0) < 0)
+  {
+    perror("daemon");
+    return 1;
+  }
+
+  signal(SIGTERM, SignalHandler);
+  signal(SIGINT, SignalHandler);
+
+  while (Running)
+  {
+    if (CaptureEdge(&Handler, &EdgeMono, &EdgeReal, &Seconds) < 0)
+    {
+      DS1307_Shm_Invalidate(Shm);
+      HaveBaseline = 0;
+      sleep(1);
+      continue;
+    }
+    Mono = ToNs(&EdgeMono);
+    Unix = (int64_t)Seconds * NSEC_PER_SEC;
+
+    if (NtpShm)
+    {
+      ClockTime.tv_sec = Seconds;
+      ClockTime.tv_nsec = 0;
+      DS1307_NtpShm_Store(NtpShm, &ClockTime, &EdgeReal, NTPSHM_PRECISION);
+    }
+
+    if (HaveBaseline)
+    {
+      double MonoSpan = (double)(Mono - Mono0);
+      double Predicted = (double)Unix0 + MonoSpan * (1.0 + RatePpb * 1e-9);
+
+      if ((double)Unix - Predicted > STEP_LIMIT_NS ||
+          Predicted - (double)Unix > STEP_LIMIT_NS)
+        HaveBaseline = 0; // RTC was set, restart drift estimation
+      else
+        RatePpb = (int64_t)(((double)(Unix - Unix0) - MonoSpan) / MonoSpan * 1e9);
+    }
+
+    if (!HaveBaseline)
+    {
+      Mono0 = Mono;
+      Unix0 = Unix;
+      RatePpb = 0;
+      HaveBaseline = 1;
+    }
+
+    DS1307_Shm_Publish(Shm, Mono, Unix, RatePpb);
+
+    // sleep until just before the next expected transition
+    SleepUntil(Mono + (int64_t)Interval * NSEC_PER_SEC - WAKEUP_GUARD_NS);
+  }
+
+  if (NtpShm)
+    DS1307_NtpShm_Detach(NtpShm);
+  DS1307_Shm_Invalidate(Shm);
+  DS1307_DeInit(&Handler);
+  return 0;
+}
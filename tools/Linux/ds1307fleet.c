@@ -0,0 +1,224 @@
+/**
+ **********************************************************************************
+ * @file   ds1307fleet.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  DS1307 fleet provisioning tool (Linux)
+ *         Functionalities of the this file:
+ *          + Provision boards on many i2c-dev adapters in parallel
+ *          + Report throughput and per-board skew of the seconds write
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include "DS1307.h"
+#include "DS1307_fleet.h"
+
+
+/* Private Variables ------------------------------------------------------------*/
+static const char *const OutWaveNames[] =
+{
+  "low", "high", "1hz", "4khz", "8khz", "32khz"
+};
+
+static const char *const ResultNames[] =
+{
+  "ok", "fail", "invalid", "busy", "nack"
+};
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####                           
+ ==================================================================================
+ */
+
+static int
+ParseOutWave(const char *Name, DS1307_OutWave_t *OutWave)
+{
+  size_t i = 0;
+
+  for (i = 0; i < sizeof(OutWaveNames) / sizeof(OutWaveNames[0]); i++)
+  {
+    if (strcmp(Name, OutWaveNames[i]) == 0)
+    {
+      *OutWave = (DS1307_OutWave_t)i;
+      return 0;
+    }
+  }
+
+  return -1;
+}
+
+static int
+LoadRam(const char *Path, uint8_t *Ram, size_t Size)
+{
+  FILE *File = fopen(Path, "rb");
+  size_t Len = 0;
+
+  if (!File)
+  {
+    perror(Path);
+    return -1;
+  }
+
+  Len = fread(Ram, 1, Size, File);
+  fclose(File);
+  if (Len != Size)
+  {
+    fprintf(stderr, "%s: expected %zu bytes\n", Path, Size);
+    return -1;
+  }
+
+  return 0;
+}
+
+static void
+Usage(const char *Name)
+{
+  fprintf(stderr,
+          "Usage: %s [-w workers] [-o wave] [-r ramfile] [-j] device...\n"
+          "  -w workers  parallel boards per wave (default: all, max %d)\n"
+          "  -o wave     low, high, 1hz, 4khz, 8khz or 32khz (default low)\n"
+          "  -r ramfile  56-byte NVRAM image (default all zero)\n"
+          "  -j          JSON output\n"
+          "Every device (e.g. /dev/i2c-3) gets the current UTC time, the output\n"
+          "wave and the NVRAM image in one 64-byte burst, then a read-back.\n",
+          Name, DS1307_FLEET_MAX_WORKERS);
+}
+
+
+
+/**
+ ==================================================================================
+                                ##### Main #####                                   
+ ==================================================================================
+ */
+
+int
+main(int argc, char **argv)
+{
+  DS1307_FleetImage_t Image = {DS1307_OutWave_Low, {0}};
+  DS1307_FleetBoard_t *Boards = NULL;
+  DS1307_FleetStats_t Stats;
+  DS1307_Result_t Result;
+  int Workers = DS1307_FLEET_MAX_WORKERS;
+  int Json = 0;
+  int Count = 0;
+  int Opt = 0;
+  int i = 0;
+
+  while ((Opt = getopt(argc, argv, "w:o:r:jh")) != -1)
+  {
+    switch (Opt)
+    {
+    case 'w':
+      Workers = atoi(optarg);
+      if (Workers < 1 || Workers > DS1307_FLEET_MAX_WORKERS)
+      {
+        fprintf(stderr, "workers must be 1 to %d\n", DS1307_FLEET_MAX_WORKERS);
+        return 1;
+      }
+      break;
+    case 'o':
+      if (ParseOutWave(optarg, &Image.OutWave) < 0)
+      {
+        Usage(argv[0]);
+        return 1;
+      }
+      break;
+    case 'r':
+      if (LoadRam(optarg, Image.Ram, sizeof(Image.Ram)) < 0)
+        return 1;
+      break;
+    case 'j':
+      Json = 1;
+      break;
+    default:
+      Usage(argv[0]);
+      return (Opt == 'h') ? 0 : 1;
+    }
+  }
+
+  Count = argc - optind;
+  if (Count < 1 || Count > UINT16_MAX)
+  {
+    Usage(argv[0]);
+    return 1;
+  }
+
+  if ((Boards = calloc(Count, sizeof(DS1307_FleetBoard_t))) == NULL)
+    return 1;
+  for (i = 0; i < Count; i++)
+    Boards[i].Path = argv[optind + i];
+
+  Result = DS1307_Fleet_Provision(Boards, (uint16_t)Count, &Image,
+                                  (uint8_t)Workers, NULL, NULL, &Stats);
+  if (Result == DS1307_INVALID_PARAM || (Result != DS1307_OK && !Stats.Boards))
+  {
+    fprintf(stderr, "provisioning could not start\n");
+    free(Boards);
+    return 1;
+  }
+
+  if (Json)
+    printf("{\"boards\":[");
+  for (i = 0; i < Count; i++)
+  {
+    if (Json)
+      printf("%s{\"device\":\"%s\",\"result\":\"%s\",\"unix\":%lu,"
+             "\"skew_us\":%ld,\"duration_us\":%lu,\"verified\":%s}",
+             i ? "," : "", Boards[i].Path, ResultNames[Boards[i].Result],
+             (unsigned long)Boards[i].Unix, (long)Boards[i].SkewUs,
+             (unsigned long)Boards[i].DurationUs,
+             Boards[i].Verified ? "true" : "false");
+    else
+      printf("%-16s %-8s unix %-10lu skew %+6ld us  %7lu us%s\n",
+             Boards[i].Path, ResultNames[Boards[i].Result],
+             (unsigned long)Boards[i].Unix, (long)Boards[i].SkewUs,
+             (unsigned long)Boards[i].DurationUs,
+             Boards[i].Verified ? "  verified" : "");
+  }
+
+  if (Json)
+    printf("],\"failed\":%u,\"waves\":%u,\"elapsed_us\":%lu,"
+           "\"boards_per_min\":%lu,\"skew_min_us\":%ld,\"skew_max_us\":%ld}\n",
+           Stats.Failed, Stats.Waves, (unsigned long)Stats.ElapsedUs,
+           (unsigned long)Stats.BoardsPerMin, (long)Stats.SkewMinUs,
+           (long)Stats.SkewMaxUs);
+  else
+    printf("%u boards, %u failed, %u waves in %.3f s: %lu boards/min, "
+           "skew %+ld..%+ld us (spread %ld us)\n",
+           Stats.Boards, Stats.Failed, Stats.Waves, Stats.ElapsedUs / 1e6,
+           (unsigned long)Stats.BoardsPerMin, (long)Stats.SkewMinUs,
+           (long)Stats.SkewMaxUs, (long)(Stats.SkewMaxUs - Stats.SkewMinUs));
+
+  free(Boards);
+  return (Result == DS1307_OK) ? 0 : 1;
+}
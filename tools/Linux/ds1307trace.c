@@ -0,0 +1,196 @@
+/**
+ **********************************************************************************
+ * @file   ds1307trace.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Print and summarize DS1307 bus traces
+ *         Usage: ds1307trace [-q] <trace file>
+ *          -q   print summary only
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Hossein.M (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "DS1307.h"
+#include "DS1307_trace.h"
+
+
+/* Private Constants ------------------------------------------------------------*/
+// 9 clocks per byte plus START/STOP, at standard mode
+#define DS1307TRACE_SCL_HZ  100000UL
+
+
+/* Private Variables ------------------------------------------------------------*/
+static FILE *Trace = NULL;
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####                           
+ ==================================================================================
+ */
+
+static int8_t
+TraceRead(uint8_t *Data, uint16_t Len)
+{
+  return (fread(Data, 1, Len, Trace) == Len) ? 0 : -1;
+}
+
+static void
+Usage(const char *Name)
+{
+  fprintf(stderr,
+          "Usage: %s [-q] <trace file>\n"
+          "  -q  print summary only\n",
+          Name);
+}
+
+
+
+/**
+ ==================================================================================
+                                ##### Main #####                                   
+ ==================================================================================
+ */
+
+int
+main(int argc, char **argv)
+{
+  DS1307_TraceRecord_t Record;
+  uint8_t Payload[255];
+  uint8_t Magic[4];
+  static const char *const KindName[4] = {"W", "R", "WR", "S"};
+  uint32_t Count[4] = {0, 0, 0, 0};
+  uint32_t Bytes[2] = {0, 0};
+  uint32_t Failures = 0;
+  uint32_t First = 0, Last = 0;
+  uint64_t Clocks = 0;
+  int Quiet = 0;
+  int Option = 0;
+  uint8_t i;
+
+  while ((Option = getopt(argc, argv, "qh")) != -1)
+  {
+    switch (Option)
+    {
+    case 'q':
+      Quiet = 1;
+      break;
+    default:
+      Usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (optind >= argc)
+  {
+    Usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  Trace = fopen(argv[optind], "rb");
+  if (!Trace)
+  {
+    perror(argv[optind]);
+    return EXIT_FAILURE;
+  }
+
+  if (TraceRead(Magic, sizeof(Magic)) < 0 ||
+      memcmp(Magic, DS1307_TRACE_MAGIC, 3) != 0 ||
+      Magic[3] == 0 || Magic[3] > DS1307_TRACE_VERSION)
+  {
+    fprintf(stderr, "%s: not a DS1307 trace\n", argv[optind]);
+    fclose(Trace);
+    return EXIT_FAILURE;
+  }
+
+  while (DS1307_Trace_ReadRecord(TraceRead, &Record, Payload) == DS1307_OK)
+  {
+    uint8_t Kind = 0;
+    uint8_t TxLen = Record.Len;
+
+    if (Record.Flags & DS1307_TRACE_SELECT)
+      Kind = 3;
+    else if ((Record.Flags & DS1307_TRACE_WRITEREAD) && Record.Len)
+      Kind = 2;
+    else if (Record.Flags & DS1307_TRACE_RECEIVE)
+      Kind = 1;
+
+    if (Count[0] + Count[1] + Count[2] + Count[3] == 0)
+      First = Record.Timestamp;
+    Last = Record.Timestamp;
+
+    Count[Kind]++;
+    switch (Kind)
+    {
+    case 0:
+    case 1:
+      Bytes[Kind] += Record.Len;
+      Clocks += 9UL * (Record.Len + 1) + 2;
+      break;
+    case 2:
+      // [TxLen][TxData][RxData], repeated START between the two parts
+      TxLen = (Payload[0] < Record.Len) ? Payload[0] : (uint8_t)(Record.Len - 1);
+      Bytes[0] += TxLen;
+      Bytes[1] += Record.Len - 1 - TxLen;
+      Clocks += 9UL * (TxLen + 1) + 9UL * (Record.Len - TxLen) + 3;
+      break;
+    default:
+      // the mux writes themselves are not part of the trace
+      break;
+    }
+    if (Record.Result != 0)
+      Failures++;
+
+    if (Quiet)
+      continue;
+
+    printf("%10lu %-2s 0x%02X %4d %3u:", (unsigned long)Record.Timestamp,
+           KindName[Kind], Record.Address, Record.Result, Record.Len);
+    for (i = (Kind == 2) ? 1 : 0; i < Record.Len; i++)
+      printf((Kind == 2 && i == 1 + TxLen) ? " | %02X" : " %02X", Payload[i]);
+    printf("\n");
+  }
+
+  fclose(Trace);
+
+  printf("transactions: %lu (%lu write, %lu read, %lu write-read, %lu select), "
+         "failed: %lu\n",
+         (unsigned long)(Count[0] + Count[1] + Count[2] + Count[3]),
+         (unsigned long)Count[0], (unsigned long)Count[1],
+         (unsigned long)Count[2], (unsigned long)Count[3],
+         (unsigned long)Failures);
+  printf("payload bytes: %lu written, %lu read\n",
+         (unsigned long)Bytes[0], (unsigned long)Bytes[1]);
+  printf("bus time at %lu Hz: %lu us, span: %lu us\n",
+         DS1307TRACE_SCL_HZ,
+         (unsigned long)(Clocks * 1000000UL / DS1307TRACE_SCL_HZ),
+         (unsigned long)(Last - First));
+
+  return EXIT_SUCCESS;
+}